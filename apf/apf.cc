@@ -65,6 +65,11 @@ void destroyMeshElement(MeshElement* e)
   delete e;
 }
 
+void rebindMeshElement(MeshElement* me, MeshEntity* e)
+{
+  me->rebind(e);
+}
+
 Field* makeField(
     Mesh* m,
     const char* name,
@@ -259,6 +264,18 @@ void destroyElement(Element* e)
   delete e;
 }
 
+void rebindElement(Element* e, MeshElement* me)
+{
+  PCU_DEBUG_ASSERT(e->getParent());
+  e->rebind(me);
+}
+
+void rebindElement(Element* e, MeshEntity* entity)
+{
+  PCU_DEBUG_ASSERT(!e->getParent());
+  e->rebind(entity);
+}
+
 MeshElement* getMeshElement(Element* e)
 {
   return e->getParent();
@@ -550,11 +567,21 @@ void synchronize(Field* f, Sharing* shr)
   synchronizeFieldData<double>(f->getData(), shr);
 }
 
+void synchronize(Field* f, Sharing* shr, pcu_plan* plan)
+{
+  synchronizeFieldData<double>(f->getData(), shr, false, plan);
+}
+
 void accumulate(Field* f, Sharing* shr, bool delete_shr)
 {
   reduceFieldData(f->getData(), shr, delete_shr, ReductionSum<double>());
 }
 
+void accumulate(Field* f, Sharing* shr, bool delete_shr, pcu_plan* plan)
+{
+  reduceFieldData(f->getData(), shr, delete_shr, ReductionSum<double>(), plan);
+}
+
 void sharedReduction(Field* f, Sharing* shr, bool delete_shr,
            const ReductionOp<double>& sum)
 {
@@ -16,6 +16,8 @@
 #include <map>
 #include <limits>
 
+struct pcu_plan;
+
 /** \file apf.h
   * \brief The APF Field interface
   */
@@ -41,6 +43,7 @@ class VectorElement;
 typedef VectorElement MeshElement;
 class FieldShape;
 struct Sharing;
+class HaloPlan;
 template <class T> class ReductionOp;
 template <class T> class ReductionSum;
 
@@ -122,6 +125,17 @@ MeshEntity * getMeshEntity(MeshElement * me);
   */
 void destroyMeshElement(MeshElement* e);
 
+/** \brief Moves a Mesh Element to a different entity.
+  *
+  * \details This gives the same result as destroying \a me and
+  * creating a new Mesh Element over \a e with the same coordinate
+  * field, but reuses the storage of \a me, so loops over many
+  * entities of the same type do not allocate per entity.
+  * Field Elements created from \a me must be rebound with
+  * apf::rebindElement before they are used again.
+  */
+void rebindMeshElement(MeshElement* me, MeshEntity* e);
+
 /** \brief The type of value the field stores.
   *
   * \details The near future may bring more complex tensors.
@@ -289,6 +303,18 @@ Element* createElement(Field* f, MeshEntity* e);
  */
 void destroyElement(Element* e);
 
+/** \brief Moves a Field Element to the entity of a Mesh Element.
+  *
+  * \details The Field Element must have been created from a
+  * Mesh Element, \a me becomes its new parent.
+  * Like apf::rebindMeshElement, this reuses the element's storage.
+  */
+void rebindElement(Element* e, MeshElement* me);
+
+/** \brief Moves a Field Element without a parent to another entity.
+  */
+void rebindElement(Element* e, MeshEntity* entity);
+
 /** \brief Get the Mesh Element of a Field Element.
   *
   * \details Each apf::Element operates over
@@ -461,11 +487,38 @@ class Integrator
       * if that is the user's goal.
       */
     virtual void parallelReduce();
+    /** \brief User callback: copy for a worker thread.
+      *
+      * \details To let process(Mesh*) use threads, return a new
+      * Integrator that accumulates into its own storage and whose
+      * callbacks only read the mesh and fields.
+      * The default returns zero, which keeps processing serial.
+      * See apf::setIntegrationThreads.
+      */
+    virtual Integrator* clone();
+    /** \brief User callback: merge the result of a worker thread clone.
+      *
+      * \details Clones are merged in the order of the elements they
+      * processed, so the result does not depend on thread scheduling.
+      */
+    virtual void merge(Integrator* other);
   protected:
     int order;
     int ipnode;
+  private:
+    bool processThreaded(Mesh* m, int dim, int threads);
 };
 
+/** \brief Set the number of threads Integrator::process(Mesh*) may use.
+  \details The default is one, i.e. no threads. Zero picks the number
+  of hardware threads. Only Integrators that implement
+  Integrator::clone are processed in threads.
+  */
+void setIntegrationThreads(int threads);
+
+/** \brief Get the number of threads set by apf::setIntegrationThreads */
+int getIntegrationThreads();
+
 /** \brief Measures the volume, area, or length of a Mesh Element.
   *
   * \details By integrating the differential volume over the element,
@@ -682,6 +735,43 @@ void writeVtkFiles(const char* prefix, Mesh* m, int cellDim = -1);
 void writeVtkFiles(const char* prefix, Mesh* m,
     std::vector<std::string> writeFields, int cellDim = -1);
 
+/** \brief Options for apf::writeVtkFiles
+  * \details The defaults give the same files as the other
+  * writeVtkFiles calls.
+  */
+struct VtkOptions
+{
+  VtkOptions();
+  /** \brief binary arrays if true, ASCII if false */
+  bool binary;
+  /** \brief put binary arrays raw in one AppendedData section
+    * instead of base64 inside each DataArray */
+  bool appended;
+  /** \brief uncompressed bytes per zlib block, zero for
+    * one block per array */
+  size_t blockSize;
+  /** \brief threads compressing the blocks of an array,
+    * zero for the number of hardware threads */
+  int threads;
+  /** \brief write ASCII doubles at full precision rather than
+    * narrowing them to float, flushing only sub-normal values */
+  bool fullPrecision;
+  /** \brief consecutive parts whose pieces share one .vtu file,
+    * written with MPI-IO. Zero groups the parts of each
+    * shared-memory node. */
+  int partsPerFile;
+};
+
+/** \brief Write a set of parallel VTK Unstructured Mesh files from an apf::Mesh
+  * as chosen by apf::VtkOptions
+  * \details Only fields whose name appears in the vector writeFields will be
+  * output. Nodal fields whose shape differs from the mesh shape will not be
+  * output. Fields with incomplete data will not be output.
+  */
+void writeVtkFiles(const char* prefix, Mesh* m,
+    std::vector<std::string> writeFields, VtkOptions const& options,
+    int cellDim = -1);
+
 /** \brief Output just the .vtu file with ASCII encoding for this part.
   \details this function is useful for debugging large parallel meshes.
   */
@@ -739,6 +829,14 @@ int getDimension(MeshElement* me);
   */
 void synchronize(Field* f, Sharing* shr = 0);
 
+/** \brief Synchronize field values through a neighbor exchange plan.
+  \details Same as synchronize, but the communication goes only
+  through the peers of (plan), see apf::makeNeighborPlan.
+  This avoids the global synchronization of a PCU phase when
+  fields are synchronized repeatedly on an unchanging partition.
+  */
+void synchronize(Field* f, Sharing* shr, pcu_plan* plan);
+
 /** \brief Add field values along partition boundary.
   \details Using the copies described by
   an apf::Sharing object, add up the field values of
@@ -747,6 +845,11 @@ void synchronize(Field* f, Sharing* shr = 0);
   */
 void accumulate(Field* f, Sharing* shr = 0, bool delete_shr = false);
 
+/** \brief Add field values along partition boundary through a
+  neighbor exchange plan, see apf::makeNeighborPlan.
+  */
+void accumulate(Field* f, Sharing* shr, bool delete_shr, pcu_plan* plan);
+
 /** \brief Apply a reudction operator along partition boundaries
   \details Using the copies described by an apf::Sharing object, applied
   the specified operation pairwise to the values of the field on each
@@ -785,6 +888,43 @@ bool isFrozen(Field* f);
  */
 double* getArrayData(Field* f);
 
+/** \brief Precompute the partition boundary exchange of frozen fields.
+  \details The plan stores, for each neighbor part, the positions in
+  the frozen arrays of fields with shape (s) of the nodes shared with
+  that part according to (shr), as well as the ghosts of owned nodes.
+  Synchronizing or accumulating through the plan is then a plain
+  gather and scatter of doubles, which is much cheaper than
+  apf::synchronize for solvers that exchange fields many times
+  on an unchanging mesh.
+  The plan is invalid once the mesh or its node numbering changes.
+  This is a collective call.
+  */
+HaloPlan* makeHaloPlan(Mesh* m, FieldShape* s, Sharing* shr = 0);
+
+/** \brief Free a plan made by apf::makeHaloPlan */
+void destroyHaloPlan(HaloPlan* h);
+
+/** \brief Copy owned node values to their copies and ghosts.
+  \details All (count) fields must be frozen and have the shape of
+  the plan. Their values are exchanged in a single message per
+  neighbor part.
+  */
+void synchronizeHalo(HaloPlan* h, Field** fields, int count);
+
+/** \brief Single field version of apf::synchronizeHalo */
+void synchronizeHalo(HaloPlan* h, Field* f);
+
+/** \brief Reduce the values of shared nodes over all their copies.
+  \details See apf::synchronizeHalo for the requirements on (fields).
+  Unlike apf::accumulate, ghost values are not reduced,
+  use apf::synchronizeHalo afterwards to update them.
+  */
+void accumulateHalo(HaloPlan* h, Field** fields, int count,
+    const ReductionOp<double>& reduce_op = ReductionSum<double>());
+
+/** \brief Single field version of apf::accumulateHalo */
+void accumulateHalo(HaloPlan* h, Field* f);
+
 /** \brief Initialize all nodal values with all-zero components */
 void zeroField(Field* f);
 
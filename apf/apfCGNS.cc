@@ -422,11 +422,14 @@ auto WriteVertices(const CGNS &cgns, apf::Mesh *m, apf::GlobalNumbering *gvn)
     vertexMin[0] = std::numeric_limits<cgsize_t>::max();
     vertexMax[0] = 0;
 
-    apf::Vector3 point;
+    apf::MeshSpan<double> points;
+    m->getPoints(points);
+    std::size_t vertIndex = 0;
     apf::MeshIterator *vertIter = m->begin(0);
     apf::MeshEntity *vert = nullptr;
     while ((vert = m->iterate(vertIter)))
     {
+      const double *point = &points[3 * vertIndex++];
       if (m->isOwned(vert))
       {
         const cgsize_t n = static_cast<cgsize_t>(apf::getNumber(gvn, vert, 0) + 1); // one based
@@ -450,7 +453,6 @@ auto WriteVertices(const CGNS &cgns, apf::Mesh *m, apf::GlobalNumbering *gvn)
         vertexMin[0] = std::min(vertexMin[0], n);
         vertexMax[0] = std::max(vertexMax[0], n);
 
-        m->getPoint(vert, 0, point);
         coords[0].push_back(point[0]);
         coords[1].push_back(point[1]);
         coords[2].push_back(point[2]);
@@ -511,28 +513,42 @@ CellElementReturn WriteElements(const CGNS &cgns, apf::Mesh *m, apf::GlobalNumbe
   cgsize_t allTotal = std::accumulate(globalNumbersByElementType.begin(), globalNumbersByElementType.end(), 0);
   PCU_ALWAYS_ASSERT_VERBOSE(allTotal == cellCount.first, ("Must be equal " + std::to_string(allTotal) + " " + std::to_string(cellCount.first)).c_str());
 
+  // one-based global numbers in vertex iteration order, to be
+  // looked up through the bulk element connectivity below
+  std::vector<cgsize_t> vertexNumbers;
+  vertexNumbers.reserve(m->count(0));
+  {
+    apf::MeshIterator *vertIter = m->begin(0);
+    apf::MeshEntity *vert = nullptr;
+    while ((vert = m->iterate(vertIter)))
+      vertexNumbers.push_back(apf::getNumber(gvn, vert, 0) + 1);
+    m->end(vertIter);
+  }
+
   int globalStart = 1; // one-based
   std::vector<std::vector<apf::MeshEntity *>> orderedElements(apfElementOrder.size());
   std::vector<std::pair<cgsize_t, cgsize_t>> ranges(apfElementOrder.size());
   for (std::size_t o = 0; o < apfElementOrder.size(); o++)
   {
     std::vector<cgsize_t> elementVertices;
+    apf::MeshSpan<int> verts;
+    m->getElementVertices(apfElementOrder[o], verts);
+    const int numVerts = apf::Mesh::adjacentCount[apfElementOrder[o]][0];
+    const int *cellVerts = verts.getData();
     apf::MeshIterator *cellIter = m->begin(cell_dim);
     apf::MeshEntity *cell = nullptr;
-    apf::Downward verts;
 
     while ((cell = m->iterate(cellIter)))
     {
-      if (m->getType(cell) == apfElementOrder[o] && m->isOwned(cell)) // must be same test as above
+      if (m->getType(cell) != apfElementOrder[o])
+        continue;
+      if (m->isOwned(cell)) // must be same test as above
       {
-        const auto numVerts = m->getDownward(cell, 0, verts);
         for (int i = 0; i < numVerts; i++)
-        {
-          const auto n = apf::getNumber(gvn, verts[i], 0);
-          elementVertices.push_back(n + 1); // one-based
-        }
+          elementVertices.push_back(vertexNumbers[cellVerts[i]]);
         orderedElements[o].push_back(cell);
       }
+      cellVerts += numVerts;
     }
     m->end(cellIter);
 
@@ -9,6 +9,8 @@
 #include "apfCavityOp.h"
 #include "apf.h"
 #include "apfMesh2.h"
+#include <pcu_util.h>
+#include <set>
 
 namespace apf {
 
@@ -18,6 +20,7 @@ CavityOp::CavityOp(Mesh* m, bool cm):
   canModify(cm),
   movedByDeletion(false),
   iterator(0),
+  independentPulls(false),
   sharing(0)
 {
 }
@@ -67,6 +70,8 @@ void CavityOp::applyLocallyWithModification(int d)
 void CavityOp::preDeletion(MeshEntity* e)
 {
   Mesh2* mesh2 = static_cast<Mesh2*>(mesh);
+  if ( ! this->iterator)
+    return;
   if (( ! mesh2->isDone(this->iterator))&&
       (e == mesh2->deref(this->iterator)))
   {
@@ -120,6 +125,19 @@ void CavityOp::applyToDimension(int d)
   sharing = 0;
 }
 
+void CavityOp::applyToEntities(std::vector<MeshEntity*> const& entities)
+{
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 1);
+  delete sharing;
+  sharing = apf::getSharing(mesh);
+  isRequesting = false;
+  for (size_t i = 0; i < entities.size(); ++i)
+    if (setEntity(entities[i]) == OK)
+      apply();
+  delete sharing;
+  sharing = 0;
+}
+
 bool CavityOp::requestLocality(MeshEntity** entities, int count)
 {
   bool areLocal = true;
@@ -127,8 +145,10 @@ bool CavityOp::requestLocality(MeshEntity** entities, int count)
     if (sharing->isShared(entities[i]))
       areLocal = false;
   if (isRequesting && ( ! areLocal))
-    for (int i=0; i < count; ++i)
-      requests.insert(requests.end(),entities,entities+count);
+  {
+    requests.insert(requests.end(),entities,entities+count);
+    requestEnds.push_back(requests.size());
+  }
   return areLocal;
 }
 
@@ -139,27 +159,39 @@ bool CavityOp::sendPullRequests(std::vector<PullRequest>& received)
   /* throw in the local pull requests */
   int self = PCU_Comm_Self();
   received.reserve(requests.size());
-  APF_ITERATE(Requests,requests,it)
+  size_t first = 0;
+  for (size_t g=0; g < requestEnds.size(); ++g)
   {
-    PullRequest request;
-    request.to = self;
-    request.e = *it;
-    received.push_back(request);
+    for (size_t i=first; i < requestEnds[g]; ++i)
+    {
+      PullRequest request;
+      request.to = self;
+      request.e = requests[i];
+      request.group = g;
+      received.push_back(request);
+    }
+    first = requestEnds[g];
   }
   /* now communicate the rest */
   PCU_Comm_Begin();
-  APF_ITERATE(Requests,requests,it)
+  first = 0;
+  for (size_t g=0; g < requestEnds.size(); ++g)
   {
-    CopyArray remotes;
-    sharing->getCopies(*it,remotes);
-    APF_ITERATE(CopyArray,remotes,rit)
+    int group = g;
+    for (size_t i=first; i < requestEnds[g]; ++i)
     {
-      int remotePart = rit->peer;
-      MeshEntity* remoteEntity = rit->entity;
-      PCU_COMM_PACK(remotePart,remoteEntity);
+      CopyArray remotes;
+      sharing->getCopies(requests[i],remotes);
+      APF_ITERATE(CopyArray,remotes,rit)
+      {
+        int remotePart = rit->peer;
+        MeshEntity* remoteEntity = rit->entity;
+        PCU_COMM_PACK(remotePart,remoteEntity);
+        PCU_COMM_PACK(remotePart,group);
+      }
     }
+    first = requestEnds[g];
   }
-  requests.clear();
   PCU_Comm_Send();
   while (PCU_Comm_Listen())
   {
@@ -168,6 +200,7 @@ bool CavityOp::sendPullRequests(std::vector<PullRequest>& received)
     while ( ! PCU_Comm_Unpacked())
     {
       PCU_COMM_UNPACK(request.e);
+      PCU_COMM_UNPACK(request.group);
       received.push_back(request);
     }
   }
@@ -217,11 +250,91 @@ static void markElements(
     markElement(plan,a[i],requester);
 }
 
+static bool claimsAll(Migration* claims, MeshEntity* e, int requester)
+{
+  Mesh* m = claims->getMesh();
+  Adjacent a;
+  m->getAdjacent(e,m->getDimension(),a);
+  for (size_t i=0; i < a.getSize(); ++i)
+    if (claims->sending(a[i]) != requester)
+      return false;
+  return true;
+}
+
+void CavityOp::dropContestedPulls(std::vector<PullRequest>& pulls)
+{
+  /* claim each requested element for one part by the
+     ownership rule, and tell requesters which of
+     their cavities lost some element here */
+  Migration* claims = new Migration(mesh);
+  for (size_t i=0; i < pulls.size(); ++i)
+    markElements(claims,pulls[i].e,pulls[i].to);
+  int self = PCU_Comm_Self();
+  std::vector<bool> lost(requestEnds.size(), false);
+  PCU_Comm_Begin();
+  for (size_t i=0; i < pulls.size(); ++i)
+    if ( ! claimsAll(claims,pulls[i].e,pulls[i].to))
+    {
+      if (pulls[i].to == self)
+        lost[pulls[i].group] = true;
+      else
+        PCU_COMM_PACK(pulls[i].to,pulls[i].group);
+    }
+  delete claims;
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen())
+    while ( ! PCU_Comm_Unpacked())
+    {
+      int group;
+      PCU_COMM_UNPACK(group);
+      lost[group] = true;
+    }
+  /* tell the parts holding the requested entities
+     which cavities won everywhere */
+  PCU_Comm_Begin();
+  size_t first = 0;
+  for (size_t g=0; g < requestEnds.size(); ++g)
+  {
+    int group = g;
+    if ( ! lost[g])
+      for (size_t i=first; i < requestEnds[g]; ++i)
+      {
+        CopyArray remotes;
+        sharing->getCopies(requests[i],remotes);
+        APF_ITERATE(CopyArray,remotes,rit)
+          PCU_COMM_PACK(rit->peer,group);
+      }
+    first = requestEnds[g];
+  }
+  PCU_Comm_Send();
+  std::set<std::pair<int,int> > won;
+  while (PCU_Comm_Listen())
+    while ( ! PCU_Comm_Unpacked())
+    {
+      int group;
+      PCU_COMM_UNPACK(group);
+      won.insert(std::make_pair(PCU_Comm_Sender(),group));
+    }
+  size_t n = 0;
+  for (size_t i=0; i < pulls.size(); ++i)
+  {
+    PullRequest& pull = pulls[i];
+    if (pull.to == self ? ( ! lost[pull.group]) :
+        won.count(std::make_pair(pull.to,pull.group)))
+      pulls[n++] = pull;
+  }
+  pulls.resize(n);
+}
+
 bool CavityOp::tryToPull()
 {
   std::vector<PullRequest> pulls;
   if ( ! sendPullRequests(pulls))
     return false;
+  if (independentPulls)
+    dropContestedPulls(pulls);
+  requests.clear();
+  requestEnds.clear();
   Migration* plan = new Migration(mesh);
   for (std::size_t i=0; i < pulls.size(); ++i)
     markElements(plan,pulls[i].e,pulls[i].to);
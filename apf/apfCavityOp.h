@@ -87,24 +87,48 @@ class CavityOp
     virtual void apply() = 0;
     /** \brief parallel collective operation over entities of one dimension */
     void applyToDimension(int d);
+    /** \brief local operation over a list of entities of a serial mesh
+      \details instead of sweeping a whole dimension, setEntity is
+      called on each listed entity in order. Since nothing
+      can be requested, this asserts that there is one part.
+      Entities destroyed by earlier applications remain in the
+      list, and setEntity must skip them. */
+    void applyToEntities(std::vector<MeshEntity*> const& entities);
     /** \brief within setEntity, require that entities be made local */
     bool requestLocality(MeshEntity** entities, int count);
     /** \brief call before deleting a mesh entity during the operation */
     void preDeletion(MeshEntity* e);
+    /** \brief only pull cavities whose elements nobody else wants
+      \details by default every requested element is pulled, and
+      elements wanted by several parts go to the highest one, so
+      the cavities of the other parts are left split up after
+      moving some of their elements for nothing.
+      With this on, each round pulls an independent set of
+      cavities: one only moves if its part won all of its
+      elements, and the rest are requested again next round.
+      This takes two more neighbor exchanges per round.
+      Cavities are still made local by migration, operators
+      are never applied on ghost copies. */
+    void setIndependentPulls(bool on) {independentPulls = on;}
     /** \brief mesh pointer for convenience */
     Mesh* mesh;
   private:
     typedef std::vector<MeshEntity*> Requests;
     Requests requests;
+    /* requests are grouped by requestLocality call,
+       group i ends at requests[requestEnds[i]] */
+    std::vector<size_t> requestEnds;
     bool isRequesting;
-    struct PullRequest { MeshEntity* e; int to; };
+    struct PullRequest { MeshEntity* e; int to; int group; };
     bool sendPullRequests(std::vector<PullRequest>& received);
+    void dropContestedPulls(std::vector<PullRequest>& pulls);
     bool tryToPull();
     void applyLocallyWithModification(int d);
     void applyLocallyWithoutModification(int d);
     bool canModify;
     bool movedByDeletion;
     MeshIterator* iterator;
+    bool independentPulls;
   protected:
     Sharing* sharing;
 };
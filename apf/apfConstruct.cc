@@ -5,134 +5,140 @@
 #include "apf.h"
 #include "apfNumbering.h"
 #include <map>
-#include <lionPrint.h>
+#include <algorithm>
 
 namespace apf {
 
+/* the sorted, unique global ids referenced by one chunk of
+   connectivity, paired with their local vertices. Lookups during
+   element construction are binary searches over these contiguous
+   arrays rather than walks down the GlobalToVert tree. */
+struct ChunkVerts
+{
+  std::vector<Gid> gids;
+  std::vector<MeshEntity*> verts;
+  MeshEntity* find(Gid gid) const
+  {
+    std::vector<Gid>::const_iterator it =
+      std::lower_bound(gids.begin(), gids.end(), gid);
+    PCU_ALWAYS_ASSERT(it != gids.end() && *it == gid);
+    return verts[it - gids.begin()];
+  }
+};
+
 static void constructVerts(
     Mesh2* m, const Gid* conn, int nelem, int etype,
-    GlobalToVert& result)
+    GlobalToVert& result, ChunkVerts& chunk)
 {
   ModelEntity* interior = m->findModelEntity(m->getDimension(), 0);
-  int end = nelem * apf::Mesh::adjacentCount[etype][0];
-  int self2 = PCU_Comm_Self();
-  for (int i = 0; i < end; ++i)
-    if ( ! result.count(conn[i])) {
-      result[conn[i]] = m->createVert_(interior);
-//      if(conn[i] < 0 || conn[i] > 4305368187 ) { // for whatever reason max is not stored but is found and checked later
-      if(conn[i] < 0 ) { 
-        lion_eprint(1, "constructVerts building globalToVert: self=%d,gid=%ld,i=%d,nelem=%ld  \n",self2,conn[i],i,nelem);
-      }
-    }
+  size_t end = (size_t)nelem * apf::Mesh::adjacentCount[etype][0];
+  chunk.gids.assign(conn, conn + end);
+  std::sort(chunk.gids.begin(), chunk.gids.end());
+  chunk.gids.erase(std::unique(chunk.gids.begin(), chunk.gids.end()),
+      chunk.gids.end());
+  chunk.verts.resize(chunk.gids.size());
+  /* one search per unique id; a new vertex is inserted
+     at the position that search found */
+  for (size_t i = 0; i < chunk.gids.size(); ++i) {
+    Gid gid = chunk.gids[i];
+    PCU_ALWAYS_ASSERT(gid >= 0);
+    GlobalToVert::iterator hint = result.lower_bound(gid);
+    if (hint == result.end() || hint->first != gid)
+      hint = result.insert(hint,
+          GlobalToVert::value_type(gid, m->createVert_(interior)));
+    chunk.verts[i] = hint->second;
+  }
 }
 
 static NewElements constructElements(
     Mesh2* m, const Gid* conn, int nelem, int etype,
-    GlobalToVert& globalToVert)
+    ChunkVerts const& chunk)
 {
   ModelEntity* interior = m->findModelEntity(m->getDimension(), 0);
   int nev = apf::Mesh::adjacentCount[etype][0];
   NewElements newElements;
+  newElements.reserve(nelem);
   for (int i = 0; i < nelem; ++i) {
     Downward verts;
-    int offset = i * nev;
+    size_t offset = (size_t)i * nev;
     for (int j = 0; j < nev; ++j)
-      verts[j] = globalToVert[conn[j + offset]];
+      verts[j] = chunk.find(conn[j + offset]);
     newElements.push_back(buildElement(m, interior, etype, verts));
   }
   return newElements;
 }
 
+static MeshEntity* findVert(GlobalToVert& globalToVert, Gid gid)
+{
+  GlobalToVert::iterator it = globalToVert.find(gid);
+  PCU_ALWAYS_ASSERT(it != globalToVert.end());
+  return it->second;
+}
+
 static Gid getMax(const GlobalToVert& globalToVert)
 {
   Gid max = -1;
-  APF_CONST_ITERATE(GlobalToVert, globalToVert, it)
-    max = std::max(max, it->first);
+  if (!globalToVert.empty())
+    max = globalToVert.rbegin()->first;
   return PCU_Max_Long(max); // this is type-dependent
 }
 
-
 /* algorithm courtesy of Sebastian Rettenberger:
    use brokers/routers for the vertex global ids.
    Although we have used this trick before (see mpas/apfMPAS.cc),
-   I didn't think to use it here, so credit is given. */
+   I didn't think to use it here, so credit is given.
+
+   Global ids are hashed to brokers by their value modulo the
+   number of peers, so no global maximum is needed and brokers
+   are balanced even when ids are sparse. Each broker sorts the
+   (id, part) pairs it receives and resolves residence from runs
+   of equal ids, keeping its memory proportional to the ids it
+   actually receives. */
 static void constructResidence(Mesh2* m, GlobalToVert& globalToVert)
 {
-  Gid ifirst=0;
-  int self2 = PCU_Comm_Self();
-  APF_ITERATE(GlobalToVert, globalToVert, it) {
-    Gid gid = it->first;  
-    if(ifirst==0 || ifirst==13437400 ) {
-        lion_eprint(1, "constructResidence: self=%d,gid=%ld,ifirst=%ld  \n",self2,gid,ifirst);
-    }
-    ifirst++;
-  }
-  Gid max = getMax(globalToVert);  // seems like we read this and know it already on every rank so why compute with global comm?
-  ifirst=0;
-  APF_ITERATE(GlobalToVert, globalToVert, it) {
-    Gid gid = it->first;  
-    if(gid < 0 || gid > max ){ 
-        lion_eprint(1, "constructResidence cgTV2: self=%d,gid=%ld,ifirst=%ld  \n",self2,gid,ifirst);
-    }
-    if(ifirst==0 || ifirst==13437400 ) {
-        lion_eprint(1, "constructResidence: self=%d,gid=%ld,ifirst=%ld,max=%ld  \n",self2,gid,ifirst,max);
-    }
-    ifirst++;
-  }
-  Gid total = max + 1;
   int peers = PCU_Comm_Peers();
-  Gid quotientL = total / peers; 
-  int quotient = quotientL;
-  Gid remainderL = total % peers; 
-  int remainder = remainderL;
-  int mySize = quotient;
-  int self = PCU_Comm_Self();
-  if (self == (peers - 1))
-    mySize += remainder;
-  if (self == (peers - 1)) lion_eprint(1, "CR1 mysize=%d \n",mySize);
-  typedef std::vector< std::vector<int> > TmpParts;
-  TmpParts tmpParts(mySize);
   /* if we have a vertex, send its global id to the
      broker for that global id */
   PCU_Comm_Begin();
   APF_ITERATE(GlobalToVert, globalToVert, it) {
-    Gid gid = it->first;  
-    if(gid < 0 || gid > max ){ 
-        lion_eprint(1, "constructResidence cgTV3: self=%d,gid=%ld \n",self2,gid);
-    } 
-    Gid tmpL=gid / quotient;
-    int tmpI=tmpL;    int to = std::min(peers - 1,tmpI); 
+    Gid gid = it->first;
+    int to = gid % peers;
     PCU_COMM_PACK(to, gid);
   }
   PCU_Comm_Send();
-  Gid myOffset = (long)self * quotient;
-  if (self == (peers - 1)) lion_eprint(1, "CR5: self=%d,myOffset=%ld,quotient=%d \n",self,myOffset,quotient);
-  /* brokers store all the part ids that sent messages
-     for each global id */
-  while (PCU_Comm_Receive()) {
-    Gid gid;
-    PCU_COMM_UNPACK(gid);
+  /* brokers collect (global id, part) pairs for all the
+     part ids that sent messages for each global id */
+  typedef std::pair<Gid, int> GidPart;
+  std::vector<GidPart> pairs;
+  while (PCU_Comm_Listen()) {
     int from = PCU_Comm_Sender();
-    Gid tmpL=gid - myOffset; // forcing 64 bit difference until we know it is safe
-    int tmpI=tmpL;
-    tmpParts.at(tmpI).push_back(from);
+    while ( ! PCU_Comm_Unpacked()) {
+      Gid gid;
+      PCU_COMM_UNPACK(gid);
+      pairs.push_back(GidPart(gid, from));
+    }
   }
+  std::sort(pairs.begin(), pairs.end());
   /* for each global id, send all associated part ids
      to all associated parts */
   PCU_Comm_Begin();
-  for (int i = 0; i < mySize; ++i) {
-    std::vector<int>& parts = tmpParts[i];
-    for (size_t j = 0; j < parts.size(); ++j) {
-      int to = parts[j];
-      Gid gid = i + myOffset;
-      int nparts = parts.size();
+  for (size_t first = 0; first < pairs.size();) {
+    size_t last = first;
+    while (last < pairs.size() && pairs[last].first == pairs[first].first)
+      ++last;
+    Gid gid = pairs[first].first;
+    int nparts = last - first;
+    for (size_t j = first; j < last; ++j) {
+      int to = pairs[j].second;
       PCU_COMM_PACK(to, gid);
       PCU_COMM_PACK(to, nparts);
-      for (size_t k = 0; k < parts.size(); ++k)
-        PCU_COMM_PACK(to, parts[k]);
+      for (size_t k = first; k < last; ++k)
+        PCU_COMM_PACK(to, pairs[k].second);
     }
+    first = last;
   }
   PCU_Comm_Send();
+  std::vector<GidPart>().swap(pairs);
   /* receiving a global id and associated parts,
      lookup the vertex and classify it on the partition
      model entity for that set of parts */
@@ -147,8 +153,7 @@ static void constructResidence(Mesh2* m, GlobalToVert& globalToVert)
       PCU_COMM_UNPACK(part);
       residence.insert(part);
     }
-    MeshEntity* vert = globalToVert[gid];
-    m->setResidence(vert, residence);
+    m->setResidence(findVert(globalToVert, gid), residence);
   }
 }
 
@@ -161,8 +166,6 @@ static void constructRemotes(Mesh2* m, GlobalToVert& globalToVert)
   PCU_Comm_Begin();
   APF_ITERATE(GlobalToVert, globalToVert, it) {
     Gid gid = it->first;
-    if(gid < 0 )      
-        lion_eprint(1, "constructRemotes cgTV4: self=%d,gid=%ld \n",self,gid);
     MeshEntity* vert = it->second;
     Parts residence;
     m->getResidence(vert, residence);
@@ -179,24 +182,21 @@ static void constructRemotes(Mesh2* m, GlobalToVert& globalToVert)
     MeshEntity* remote;
     PCU_COMM_UNPACK(remote);
     int from = PCU_Comm_Sender();
-    MeshEntity* vert = globalToVert[gid];
-    m->addRemote(vert, from, remote);
+    m->addRemote(findVert(globalToVert, gid), from, remote);
   }
-  // who is not stuck?
-  lion_eprint(1, "%d done inside remotes \n",PCU_Comm_Self());
 }
 
 NewElements assemble(Mesh2* m, const Gid* conn, int nelem, int etype,
      GlobalToVert& globalToVert)
 {
-  constructVerts(m, conn, nelem, etype, globalToVert);
-  return constructElements(m, conn, nelem, etype, globalToVert);
+  ChunkVerts chunk;
+  constructVerts(m, conn, nelem, etype, globalToVert, chunk);
+  return constructElements(m, conn, nelem, etype, chunk);
 }
 
 void finalise(Mesh2* m, GlobalToVert& globalToVert)
 {
   constructResidence(m, globalToVert);
-  lion_eprint(1, "%d after residence \n",PCU_Comm_Self());
   constructRemotes(m, globalToVert);
   stitchMesh(m);
   m->acceptChanges();
@@ -295,7 +295,7 @@ void setCoords(Mesh2* m, const double* coords, int nverts,
     double v[3];
     PCU_Comm_Unpack(v, sizeof(v));
     Vector3 vv(v);
-    m->setPoint(globalToVert[gid], 0, vv);
+    m->setPoint(findVert(globalToVert, gid), 0, vv);
   }
 
   delete [] c;
@@ -385,8 +385,7 @@ void setMatches(Mesh2* m, const Gid* matches, int nverts,
     Gid match;
     PCU_COMM_UNPACK(match);
     PCU_ALWAYS_ASSERT(gid != match);
-    PCU_ALWAYS_ASSERT(globalToVert.count(gid));
-    m->setLongTag(globalToVert[gid], matchGidTag, &match);
+    m->setLongTag(findVert(globalToVert, gid), matchGidTag, &match);
   }
 
   /* Use the 1D partitioning of global ids to distribute the 
@@ -479,8 +478,7 @@ void setMatches(Mesh2* m, const Gid* matches, int nverts,
       PCU_COMM_UNPACK(owner);
       MeshEntity* match;
       PCU_COMM_UNPACK(match);
-      PCU_ALWAYS_ASSERT(globalToVert.count(gid));
-      MeshEntity* partner = globalToVert[gid];
+      MeshEntity* partner = findVert(globalToVert, gid);
       PCU_ALWAYS_ASSERT(! (match == partner && owner == self) );
       m->addMatch(partner, owner, match);
     }
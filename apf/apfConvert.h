@@ -40,7 +40,12 @@ typedef std::map<Gid, MeshEntity*> GlobalToVert;
   \details construct is now split into two functions, 
   assemble and finalise. The premise of assemble being 
   that it is called multiple times for a given cell type,
-  across several different cell types in the input mesh. */
+  across several different cell types in the input mesh.
+  It may also be called on successive chunks of one cell type's
+  connectivity, so the caller only needs one chunk of connectivity
+  in memory at a time. Besides the chunk, assemble only uses memory
+  for the mesh it builds and the globalToVert map, which grow with
+  the part rather than the chunk. */
 NewElements assemble(Mesh2* m, const apf::Gid* conn, int nelem, int etype,
     GlobalToVert& globalToVert);
 
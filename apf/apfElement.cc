@@ -40,6 +40,16 @@ Element::~Element()
 {
 }
 
+void Element::rebind(MeshEntity* e)
+{
+  init(field,e,0);
+}
+
+void Element::rebind(VectorElement* p)
+{
+  init(field,p->getEntity(),p);
+}
+
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim)
 {
   switch (dim) {
@@ -82,7 +92,6 @@ void Element::getGlobalGradients(Vector3 const& local,
   Matrix3x3 J;
   parent->getJacobian(local,J);
   Matrix3x3 jinv = getJacobianInverse(J, getDimension());
-  NewArray<Vector3> localGradients;
   shape->getLocalGradients(mesh, entity, local,localGradients);
   globalGradients.allocate(nen);
   for (int i=0; i < nen; ++i)
@@ -104,7 +113,6 @@ void Element::getComponents(Vector3 const& xi, double* c)
   }
   // handle cases with scalar shape functions
   else {
-    NewArray<double> shapeValues;
     shape->getValues(mesh, entity, xi, shapeValues);
     for (int ci = 0; ci < nc; ++ci)
       c[ci] = 0;
@@ -36,6 +36,8 @@ class Element
     FieldShape* getFieldShape() {return field->getShape();}
     void getComponents(Vector3 const& xi, double* c);
     void getElementNodeData(NewArray<double>& d);
+    void rebind(MeshEntity* e);
+    void rebind(VectorElement* p);
   protected:
     void init(Field* f, MeshEntity* e, VectorElement* p);
     void getNodeData();
@@ -47,6 +49,12 @@ class Element
     int nen;
     int nc;
     NewArray<double> nodeData;
+    /* scratch space for evaluations, kept so that an element
+       evaluated at many points (and rebound to many entities
+       of the same type) only allocates once */
+    NewArray<double> shapeValues;
+    NewArray<Vector3> localGradients;
+    NewArray<Vector3> globalGradients;
 };
 
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim);
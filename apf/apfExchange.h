@@ -0,0 +1,71 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFEXCHANGE_H
+#define APFEXCHANGE_H
+
+#include <PCU.h>
+
+namespace apf {
+
+/* a communication phase that goes through a PCU neighbor
+   exchange plan if one is given and through the global
+   PCU phase otherwise, so that loops which can opt into
+   plans are only written once */
+class Exchange
+{
+  public:
+    Exchange(pcu_plan* p):plan(p) {}
+    void begin()
+    {
+      if (plan)
+        PCU_Plan_Begin(plan);
+      else
+        PCU_Comm_Begin();
+    }
+    void pack(int to, const void* data, size_t size)
+    {
+      if (plan)
+        PCU_Plan_Pack(plan, to, data, size);
+      else
+        PCU_Comm_Pack(to, data, size);
+    }
+    template <class T>
+    void pack(int to, T const& o) {pack(to, &o, sizeof(o));}
+    void send()
+    {
+      if (plan)
+        PCU_Plan_Send(plan);
+      else
+        PCU_Comm_Send();
+    }
+    bool listen() {return plan ? PCU_Plan_Listen(plan) : PCU_Comm_Listen();}
+    bool receive()
+    {
+      return plan ? PCU_Plan_Receive(plan) : PCU_Comm_Receive();
+    }
+    bool unpacked()
+    {
+      return plan ? PCU_Plan_Unpacked(plan) : PCU_Comm_Unpacked();
+    }
+    int sender() {return plan ? PCU_Plan_Sender(plan) : PCU_Comm_Sender();}
+    void unpack(void* data, size_t size)
+    {
+      if (plan)
+        PCU_Plan_Unpack(plan, data, size);
+      else
+        PCU_Comm_Unpack(data, size);
+    }
+    template <class T>
+    void unpack(T& o) {unpack(&o, sizeof(o));}
+  private:
+    pcu_plan* plan;
+};
+
+}
+
+#endif
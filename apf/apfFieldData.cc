@@ -1,6 +1,7 @@
 #include <PCU.h>
 #include "apfFieldData.h"
 #include "apfShape.h"
+#include "apfExchange.h"
 #include <pcu_util.h>
 #include <cstdlib>
 #include <iostream>
@@ -17,8 +18,10 @@ void FieldData::rename(const char*)
 }
 
 template <class T>
-void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
+void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr,
+    pcu_plan* plan)
 {
+  Exchange ex(plan);
   FieldBase* f = data->getField();
   Mesh* m = f->getMesh();
   FieldShape* s = f->getShape();
@@ -33,7 +36,7 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       continue;
     MeshEntity* e;
     MeshIterator* it = m->begin(d);
-    PCU_Comm_Begin();
+    ex.begin();
     while ((e = m->iterate(it)))
     {
       if (( ! data->hasEntity(e))||
@@ -46,26 +49,26 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       shr->getCopies(e, copies);
       for (size_t i = 0; i < copies.getSize(); ++i)
       {
-        PCU_COMM_PACK(copies[i].peer, copies[i].entity);
-        PCU_Comm_Pack(copies[i].peer, &(values[0]), n*sizeof(T));
+        ex.pack(copies[i].peer, copies[i].entity);
+        ex.pack(copies[i].peer, &(values[0]), n*sizeof(T));
       }
       apf::Copies ghosts;  
       if (m->getGhosts(e, ghosts))
       APF_ITERATE(Copies, ghosts, it)
       {
-        PCU_COMM_PACK(it->first, it->second);
-        PCU_Comm_Pack(it->first, &(values[0]), n*sizeof(T));
+        ex.pack(it->first, it->second);
+        ex.pack(it->first, &(values[0]), n*sizeof(T));
       }
     }
     m->end(it);
-    PCU_Comm_Send();
-    while (PCU_Comm_Receive())
+    ex.send();
+    while (ex.receive())
     {
       MeshEntity* e;
-      PCU_COMM_UNPACK(e);
+      ex.unpack(e);
       int n = f->countValuesOn(e);
       NewArray<T> values(n);
-      PCU_Comm_Unpack(&(values[0]),n*sizeof(T));
+      ex.unpack(&(values[0]),n*sizeof(T));
       data->set(e,&(values[0]));
     }
   }
@@ -73,12 +76,16 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
 }
 
 /* instantiate here */
-template void synchronizeFieldData<int>(FieldDataOf<int>*, Sharing*, bool);
-template void synchronizeFieldData<double>(FieldDataOf<double>*, Sharing*, bool);
-template void synchronizeFieldData<long>(FieldDataOf<long>*, Sharing*, bool);
+template void synchronizeFieldData<int>(FieldDataOf<int>*, Sharing*, bool,
+    pcu_plan*);
+template void synchronizeFieldData<double>(FieldDataOf<double>*, Sharing*, bool,
+    pcu_plan*);
+template void synchronizeFieldData<long>(FieldDataOf<long>*, Sharing*, bool,
+    pcu_plan*);
 
-void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, const ReductionOp<double>& reduce_op /* =ReductionSum<double>() */)
+void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, const ReductionOp<double>& reduce_op /* =ReductionSum<double>() */, pcu_plan* plan)
 {
+  Exchange ex(plan);
   FieldBase* f = data->getField();
   Mesh* m = f->getMesh();
   FieldShape* s = f->getShape();
@@ -94,7 +101,7 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
 
     MeshEntity* e;
     MeshIterator* it = m->begin(d);
-    PCU_Comm_Begin();
+    ex.begin();
     while ((e = m->iterate(it)))
     {
       /* send to all parts that can see this entity */
@@ -122,8 +129,8 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
 
       for (size_t i = 0; i < copies.getSize(); ++i)
       {
-        PCU_COMM_PACK(copies[i].peer, copies[i].entity);
-        PCU_Comm_Pack(copies[i].peer, &(values[0]), n*sizeof(double));
+        ex.pack(copies[i].peer, copies[i].entity);
+        ex.pack(copies[i].peer, &(values[0]), n*sizeof(double));
       }
 
       // ghosts - only do them if this entity is on a partition boundary
@@ -133,24 +140,24 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
         if (m->getGhosts(e, ghosts))
         APF_ITERATE(Copies, ghosts, it2)
         {
-          PCU_COMM_PACK(it2->first, it2->second);
-          PCU_Comm_Pack(it2->first, &(values[0]), n*sizeof(double));
+          ex.pack(it2->first, it2->second);
+          ex.pack(it2->first, &(values[0]), n*sizeof(double));
         }
       }
     }
     m->end(it);
 
-    PCU_Comm_Send();
-    while (PCU_Comm_Listen())
-      while ( ! PCU_Comm_Unpacked())
+    ex.send();
+    while (ex.listen())
+      while ( ! ex.unpacked())
       { /* receive and add. we only care about correctness
            on the owners */
         MeshEntity* e;
-        PCU_COMM_UNPACK(e);
+        ex.unpack(e);
         int n = f->countValuesOn(e);
         NewArray<double> values(n);
         NewArray<double> inValues(n);
-        PCU_Comm_Unpack(&(inValues[0]),n*sizeof(double));
+        ex.unpack(&(inValues[0]),n*sizeof(double));
         data->get(e,&(values[0]));
         for (int i = 0; i < n; ++i)
           values[i] = reduce_op.apply(values[i], inValues[i]);
@@ -33,9 +33,10 @@ template <class T>
 class FieldDataOf;
 
 template <class T>
-void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr=false);
+void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr=false,
+    pcu_plan* plan=0);
 
-void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr=false, const ReductionOp<double>& reduce_op=ReductionSum<double>() );
+void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr=false, const ReductionOp<double>& reduce_op=ReductionSum<double>(), pcu_plan* plan=0);
 
 template <class T>
 void copyFieldData(FieldDataOf<T>* from, FieldDataOf<T>* to);
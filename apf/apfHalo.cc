@@ -0,0 +1,226 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include <PCU.h>
+#include "apf.h"
+#include "apfMesh.h"
+#include "apfShape.h"
+#include "apfNumbering.h"
+#include <pcu_util.h>
+
+namespace apf {
+
+/* for each peer, the plan stores the local node numbers
+   (in the overlap node numbering that frozen fields use)
+   exchanged with that peer, in the same order on both sides:
+     own: nodes owned here, sent to copies and ghosts on the peer
+     copy: nodes owned by the peer, received from it
+     shared: all shared nodes, sent to and received from the peer
+       in the order the sender packed them */
+struct HaloLink
+{
+  std::vector<int> ownSend;
+  std::vector<int> copyRecv;
+  std::vector<int> sharedSend;
+  std::vector<int> sharedRecv;
+};
+
+class HaloPlan
+{
+  public:
+    Mesh* mesh;
+    FieldShape* shape;
+    Numbering* numbering;
+    pcu_plan* plan;
+    std::vector<HaloLink> links;
+};
+
+enum { HALO_SHARED, HALO_OWNED, HALO_GHOST };
+
+static void getNodes(HaloPlan* h, MeshEntity* e, std::vector<int>& nodes)
+{
+  int n = h->shape->countNodesOn(h->mesh->getType(e));
+  for (int i = 0; i < n; ++i)
+    nodes.push_back(getNumber(h->numbering, e, i, 0));
+}
+
+static void packLink(HaloPlan* h, std::map<int, HaloLink>& links,
+    MeshEntity* e, int to, MeshEntity* remote, int how)
+{
+  PCU_COMM_PACK(to, remote);
+  PCU_COMM_PACK(to, how);
+  HaloLink& l = links[to];
+  if (how != HALO_GHOST)
+    getNodes(h, e, l.sharedSend);
+  if (how != HALO_SHARED)
+    getNodes(h, e, l.ownSend);
+}
+
+HaloPlan* makeHaloPlan(Mesh* m, FieldShape* s, Sharing* shr)
+{
+  bool delete_shr = false;
+  if (!shr) {
+    shr = getSharing(m);
+    delete_shr = true;
+  }
+  HaloPlan* h = new HaloPlan();
+  h->mesh = m;
+  h->shape = s;
+  /* freezeFieldData reuses the numbering named after the shape,
+     so this plan indexes the same arrays frozen fields use */
+  h->numbering = m->findNumbering(s->getName());
+  if (!h->numbering)
+    h->numbering = numberOverlapNodes(m, s->getName(), s);
+  std::map<int, HaloLink> links;
+  PCU_Comm_Begin();
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      bool owned = shr->isOwned(e);
+      if (shr->isShared(e)) {
+        CopyArray copies;
+        shr->getCopies(e, copies);
+        for (size_t i = 0; i < copies.getSize(); ++i)
+          packLink(h, links, e, copies[i].peer, copies[i].entity,
+              owned ? HALO_OWNED : HALO_SHARED);
+      }
+      Copies ghosts;
+      if (owned && m->getGhosts(e, ghosts))
+        APF_ITERATE(Copies, ghosts, git)
+          packLink(h, links, e, git->first, git->second, HALO_GHOST);
+    }
+    m->end(it);
+  }
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen()) {
+    HaloLink& l = links[PCU_Comm_Sender()];
+    while (!PCU_Comm_Unpacked()) {
+      MeshEntity* e;
+      int how;
+      PCU_COMM_UNPACK(e);
+      PCU_COMM_UNPACK(how);
+      if (how != HALO_GHOST)
+        getNodes(h, e, l.sharedRecv);
+      if (how != HALO_SHARED)
+        getNodes(h, e, l.copyRecv);
+    }
+  }
+  typedef std::map<int, HaloLink> Links;
+  std::vector<int> peers;
+  APF_ITERATE(Links, links, it)
+    peers.push_back(it->first);
+  h->plan = PCU_Plan_New(peers.size(), peers.empty() ? 0 : &peers[0]);
+  h->links.resize(PCU_Plan_Peers(h->plan));
+  for (size_t i = 0; i < h->links.size(); ++i)
+    h->links[i] = links[PCU_Plan_Peer(h->plan, i)];
+  if (delete_shr)
+    delete shr;
+  return h;
+}
+
+void destroyHaloPlan(HaloPlan* h)
+{
+  PCU_Plan_Free(h->plan);
+  delete h;
+}
+
+static size_t countComponents(HaloPlan* h, Field** fields, int count)
+{
+  size_t n = 0;
+  for (int i = 0; i < count; ++i) {
+    PCU_ALWAYS_ASSERT_VERBOSE(isFrozen(fields[i]),
+        "halo exchange requires frozen fields");
+    PCU_ALWAYS_ASSERT_VERBOSE(getShape(fields[i]) == h->shape,
+        "halo exchange field shape does not match its plan");
+    n += countComponents(fields[i]);
+  }
+  return n;
+}
+
+static void gather(std::vector<int> const& nodes,
+    Field** fields, int count, double* out)
+{
+  for (int i = 0; i < count; ++i) {
+    double* a = getArrayData(fields[i]);
+    int nc = countComponents(fields[i]);
+    for (size_t j = 0; j < nodes.size(); ++j)
+      for (int c = 0; c < nc; ++c)
+        *out++ = a[nodes[j] * nc + c];
+  }
+}
+
+static void pack(HaloPlan* h, bool owned, Field** fields, int count,
+    size_t nc)
+{
+  PCU_Plan_Begin(h->plan);
+  for (size_t i = 0; i < h->links.size(); ++i) {
+    std::vector<int> const& nodes =
+      owned ? h->links[i].ownSend : h->links[i].sharedSend;
+    if (nodes.empty())
+      continue;
+    size_t size = nodes.size() * nc * sizeof(double);
+    double* out = (double*) PCU_Plan_Buffer(h->plan, i, size);
+    gather(nodes, fields, count, out);
+  }
+  PCU_Plan_Send(h->plan);
+}
+
+void synchronizeHalo(HaloPlan* h, Field** fields, int count)
+{
+  size_t nc = countComponents(h, fields, count);
+  pack(h, true, fields, count, nc);
+  while (PCU_Plan_Listen(h->plan)) {
+    int from = PCU_Plan_Find(h->plan, PCU_Plan_Sender(h->plan));
+    std::vector<int> const& nodes = h->links[from].copyRecv;
+    double const* in = (double const*) PCU_Plan_Extract(h->plan,
+        nodes.size() * nc * sizeof(double));
+    for (int i = 0; i < count; ++i) {
+      double* a = getArrayData(fields[i]);
+      int fc = countComponents(fields[i]);
+      for (size_t j = 0; j < nodes.size(); ++j)
+        for (int c = 0; c < fc; ++c)
+          a[nodes[j] * fc + c] = *in++;
+    }
+  }
+}
+
+void synchronizeHalo(HaloPlan* h, Field* f)
+{
+  synchronizeHalo(h, &f, 1);
+}
+
+void accumulateHalo(HaloPlan* h, Field** fields, int count,
+    const ReductionOp<double>& reduce_op)
+{
+  size_t nc = countComponents(h, fields, count);
+  pack(h, false, fields, count, nc);
+  while (PCU_Plan_Listen(h->plan)) {
+    int from = PCU_Plan_Find(h->plan, PCU_Plan_Sender(h->plan));
+    std::vector<int> const& nodes = h->links[from].sharedRecv;
+    double const* in = (double const*) PCU_Plan_Extract(h->plan,
+        nodes.size() * nc * sizeof(double));
+    for (int i = 0; i < count; ++i) {
+      double* a = getArrayData(fields[i]);
+      int fc = countComponents(fields[i]);
+      for (size_t j = 0; j < nodes.size(); ++j)
+        for (int c = 0; c < fc; ++c) {
+          double& v = a[nodes[j] * fc + c];
+          v = reduce_op.apply(v, *in++);
+        }
+    }
+  }
+}
+
+void accumulateHalo(HaloPlan* h, Field* f)
+{
+  accumulateHalo(h, &f, 1);
+}
+
+}
@@ -9,6 +9,8 @@
 #include "apfMesh.h"
 #include "apf.h"
 #include "pcu_util.h"
+#include <algorithm>
+#include <thread>
 
 namespace apf {
 
@@ -641,11 +643,100 @@ void Integrator::parallelReduce()
 {
 }
 
+Integrator* Integrator::clone()
+{
+  return 0;
+}
+
+void Integrator::merge(Integrator*)
+{
+}
+
+static int integrationThreads = 1;
+
+void setIntegrationThreads(int threads)
+{
+  if (threads <= 0)
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  integrationThreads = threads;
+}
+
+int getIntegrationThreads()
+{
+  return integrationThreads;
+}
+
+static void processRange(Integrator* in, Mesh* m,
+    MeshEntity* const* entities, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    MeshElement* e = createMeshElement(m,entities[i]);
+    in->process(e);
+    destroyMeshElement(e);
+  }
+}
+
+/* owned elements are split into one contiguous chunk per thread,
+   each processed by a clone. the clones are merged in chunk
+   order so the result is the same from run to run. */
+bool Integrator::processThreaded(Mesh* m, int d, int threads)
+{
+  std::vector<MeshEntity*> entities;
+  entities.reserve(m->count(d));
+  MeshEntity* entity;
+  MeshIterator* elements = m->begin(d);
+  while ((entity = m->iterate(elements)))
+    if (m->isOwned(entity))
+      entities.push_back(entity);
+  m->end(elements);
+  size_t n = entities.size();
+  if (n < (size_t)threads)
+    threads = std::max<size_t>(n, 1);
+  std::vector<Integrator*> clones;
+  for (int i=0; i < threads; ++i)
+  {
+    Integrator* c = this->clone();
+    if (!c)
+      break;
+    clones.push_back(c);
+  }
+  if (clones.size() != (size_t)threads)
+  {
+    for (size_t i=0; i < clones.size(); ++i)
+      delete clones[i];
+    return false;
+  }
+  std::vector<std::thread> workers;
+  for (int i=1; i < threads; ++i)
+  {
+    size_t b = (n * i) / threads;
+    size_t e = (n * (i + 1)) / threads;
+    workers.push_back(std::thread(processRange, clones[i], m,
+          entities.data() + b, e - b));
+  }
+  processRange(clones[0], m, entities.data(), n / threads);
+  for (size_t i=0; i < workers.size(); ++i)
+    workers[i].join();
+  for (int i=0; i < threads; ++i)
+  {
+    this->merge(clones[i]);
+    delete clones[i];
+  }
+  return true;
+}
+
 void Integrator::process(Mesh* m, int d)
 {
   if(d<0)
     d = m->getDimension();
   PCU_DEBUG_ASSERT(d<=m->getDimension());
+  if (integrationThreads > 1 &&
+      this->processThreaded(m, d, integrationThreads))
+  {
+    this->parallelReduce();
+    return;
+  }
   MeshEntity* entity;
   MeshIterator* elements = m->begin(d);
   while ((entity = m->iterate(elements)))
@@ -542,9 +542,12 @@ void projectL2Field(Field* to, Field* from)
   }
   m->end(it);
 
-  // take care of entities on part boundary
-  accumulate(to);
-  accumulate(count);
+  // take care of entities on part boundary, all three
+  // exchanges go through the same neighbors
+  Sharing* shr = getSharing(m);
+  pcu_plan* plan = makeNeighborPlan(m, shr);
+  accumulate(to, shr, false, plan);
+  accumulate(count, shr, false, plan);
 
   it = m->begin(0);
   while( (e = m->iterate(it)) ) {
@@ -558,7 +561,9 @@ void projectL2Field(Field* to, Field* from)
   m->end(it);
 
   // take care of entities on part boundary
-  synchronize(to);
+  synchronize(to, shr, plan);
+  PCU_Plan_Free(plan);
+  delete shr;
 
   m->removeField(count);
   destroyField(count);
@@ -24,7 +24,6 @@ MatrixElement::~MatrixElement()
 void MatrixElement::grad(Vector3 const& xi, Vector<27>& g)
 {
   Matrix3x3* nodeValues = getNodeValues();
-  NewArray<Vector3> globalGradients;
   getGlobalGradients(xi, globalGradients);
   // for the first time through g, set the values of g
   for(int i=0; i<3; ++i) {
@@ -288,6 +288,54 @@ void Mesh::getPoint(MeshEntity* e, int node, Vector3& p)
   getVector(coordinateField,e,node,p);
 }
 
+void Mesh::getPoints(MeshSpan<double>& points)
+{
+  double* x = points.allocate(count(0) * 3);
+  MeshIterator* it = begin(0);
+  MeshEntity* v;
+  Vector3 p;
+  while ((v = iterate(it))) {
+    getPoint(v, 0, p);
+    p.toArray(x);
+    x += 3;
+  }
+  end(it);
+}
+
+void Mesh::getElementVertices(int type, MeshSpan<int>& vertices)
+{
+  MeshTag* tag = createIntTag("apf_span_vertex", 1);
+  MeshIterator* it = begin(0);
+  MeshEntity* e;
+  int i = 0;
+  while ((e = iterate(it))) {
+    setIntTag(e, tag, &i);
+    ++i;
+  }
+  end(it);
+  int dim = typeDimension[type];
+  int nv = adjacentCount[type][0];
+  int* out = vertices.allocate(countEntitiesOfType(this, type) * nv);
+  Downward dv;
+  it = begin(dim);
+  while ((e = iterate(it))) {
+    if (getType(e) != type)
+      continue;
+    getDownward(e, 0, dv);
+    for (int j = 0; j < nv; ++j)
+      getIntTag(dv[j], tag, out++);
+  }
+  end(it);
+  removeTagFromDimension(this, tag, 0);
+  destroyTag(tag);
+}
+
+bool Mesh::hasNativePoints()
+{
+  return !isFrozen(coordinateField) &&
+    dynamic_cast<CoordData*>(coordinateField->getData());
+}
+
 FieldShape* Mesh::getShape() const
 {
   return coordinateField->getShape();
@@ -1028,6 +1076,39 @@ Sharing* getSharing(Mesh* m)
   return new NormalSharing(m);
 }
 
+pcu_plan* makeNeighborPlan(Mesh* m, Sharing* shr)
+{
+  bool delete_shr = false;
+  if (!shr) {
+    shr = getSharing(m);
+    delete_shr = true;
+  }
+  std::vector<int> peers;
+  Parts seen;
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      if (shr->isShared(e)) {
+        CopyArray copies;
+        shr->getCopies(e, copies);
+        for (size_t i = 0; i < copies.getSize(); ++i)
+          if (seen.insert(copies[i].peer).second)
+            peers.push_back(copies[i].peer);
+      }
+      Copies ghosts;
+      if (m->getGhosts(e, ghosts))
+        APF_ITERATE(Copies, ghosts, git)
+          if (seen.insert(git->first).second)
+            peers.push_back(git->first);
+    }
+    m->end(it);
+  }
+  if (delete_shr)
+    delete shr;
+  return PCU_Plan_New(peers.size(), peers.empty() ? 0 : &peers[0]);
+}
+
 static void getUpBridgeAdjacent(Mesh* m, MeshEntity* origin,
     int bridgeDimension, int targetDimension,
     std::set<MeshEntity*>& result)
@@ -18,6 +18,7 @@
 #include "apfDynamicArray.h"
 
 struct gmi_model;
+struct pcu_plan;
 
 namespace apf {
 
@@ -93,6 +94,47 @@ typedef CopyArray Matches;
 /** \brief a set of DG copies */
 typedef CopyArray DgCopies;
 
+/** \brief a read-only span of bulk mesh data
+  \details filled by apf::Mesh::getPoints and
+  apf::Mesh::getElementVertices. Depending on the mesh
+  database it either views storage owned by the mesh
+  or owns a buffer filled with a copy.
+  In both cases the contents are only valid until the
+  mesh is modified. */
+template <class T>
+class MeshSpan
+{
+  public:
+    MeshSpan():data(0),size(0) {}
+    /** \brief get a pointer to the first value */
+    T const* getData() const {return data;}
+    /** \brief get the number of values */
+    std::size_t getSize() const {return size;}
+    /** \brief get the i'th value */
+    T const& operator[](std::size_t i) const {return data[i];}
+    /** \brief point at (n) values owned by someone else */
+    void view(T const* d, std::size_t n)
+    {
+      buffer.resize(0);
+      data = d;
+      size = n;
+    }
+    /** \brief allocate room for (n) values to be filled in */
+    T* allocate(std::size_t n)
+    {
+      buffer.resize(n);
+      data = n ? &buffer[0] : 0;
+      size = n;
+      return n ? &buffer[0] : 0;
+    }
+  private:
+    MeshSpan(MeshSpan const&);
+    MeshSpan& operator=(MeshSpan const&);
+    T const* data;
+    std::size_t size;
+    DynamicArray<T> buffer;
+};
+
 /** \brief Interface to a mesh part
   \details This base class is the interface for almost all mesh
   operations in APF. Code that interacts with a mesh should do
@@ -210,6 +252,23 @@ class Mesh
     void getPoint(MeshEntity* e, int node, Vector3& point);
     /** \brief Implementation-defined code for apf::Mesh::getPoint */
     virtual void getPoint_(MeshEntity* e, int node, Vector3& point) = 0;
+    /** \brief Get the coordinates of all vertices at once.
+       \details the span holds three values per vertex,
+       in the order of iteration over dimension 0.
+       The default implementation calls apf::Mesh::getPoint
+       for each vertex, databases that store coordinates
+       contiguously may return a view of them instead. */
+    virtual void getPoints(MeshSpan<double>& points);
+    /** \brief Get the vertices of all entities of one type at once.
+       \details the span holds apf::Mesh::adjacentCount[type][0]
+       values per entity of (type), in iteration order.
+       Each value is the position of the vertex in the order
+       of iteration over dimension 0, so it indexes the
+       span from apf::Mesh::getPoints directly.
+       The default implementation calls apf::Mesh::getDownward
+       for each entity.
+       \param type a value from apf::Mesh::Type */
+    virtual void getElementVertices(int type, MeshSpan<int>& vertices);
     /** \brief Get the geometric parametric coordinates of a vertex */
     virtual void getParam(MeshEntity* e, Vector3& p) = 0;
     /** \brief Get the topological type of a mesh entity.
@@ -398,6 +457,9 @@ class Mesh
     /** \brief true if any associated fields use array storage */
     bool hasFrozenFields;
   protected:
+    /** \brief true if the coordinate field reads vertex
+      coordinates straight from apf::Mesh::getPoint_ */
+    bool hasNativePoints();
     Field* coordinateField;
     std::vector<Field*> fields;
     std::vector<Numbering*> numberings;
@@ -531,6 +593,15 @@ private:
   and remote copies for other entities */
 Sharing* getSharing(Mesh* m);
 
+/** \brief create a PCU exchange plan over the neighbors of this part
+  \details the peers are all parts holding a copy of one of the
+  local entities, as described by (shr) (or the default sharing),
+  and all parts holding ghosts of local entities.
+  The plan can be passed to synchronize and accumulate
+  for as long as the partition does not change.
+  This is a collective call, free the plan with PCU_Plan_Free. */
+pcu_plan* makeNeighborPlan(Mesh* m, Sharing* shr = 0);
+
 /** \brief map from triangle edge order to triangle vertex order */
 extern int const tri_edge_verts[3][2];
 /** \brief map from quad edge order to quad vertex order */
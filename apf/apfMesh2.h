@@ -150,6 +150,7 @@ void displaceMesh(Mesh2* m, Field* d, double factor=1.0);
 class BuildCallback
 {
   public:
+    virtual ~BuildCallback() {}
     /** \brief will be called after an entity is created */
     virtual void call(MeshEntity* e) = 0;
 };
@@ -12,6 +12,7 @@
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <cstdlib>
+#include <map>
 
 namespace apf {
 
@@ -310,7 +311,8 @@ MeshEntity* unpackVertex(
   return m->createVertex(c,point,param);
 }
 
-static void packReference(
+/* the copy of e on part to, which must exist */
+static MeshEntity* getReference(
     Mesh2* m,
     int to,
     MeshEntity* e)
@@ -319,19 +321,21 @@ static void packReference(
   m->getRemotes(e,remotes);
   Copies::iterator found = remotes.find(to);
   if (found!=remotes.end())
-  {
-    MeshEntity* remote = found->second;
-    PCU_COMM_PACK(to,remote);
-  }
-  else
-  {
-    Copies ghosts;
-    m->getGhosts(e,ghosts);
-    found = ghosts.find(to);
-    PCU_ALWAYS_ASSERT(found!=ghosts.end());
-    MeshEntity* ghost = found->second;
-    PCU_COMM_PACK(to,ghost);
-  }
+    return found->second;
+  Copies ghosts;
+  m->getGhosts(e,ghosts);
+  found = ghosts.find(to);
+  PCU_ALWAYS_ASSERT(found!=ghosts.end());
+  return found->second;
+}
+
+static void packReference(
+    Mesh2* m,
+    int to,
+    MeshEntity* e)
+{
+  MeshEntity* reference = getReference(m,to,e);
+  PCU_COMM_PACK(to,reference);
 }
 
 static void packDownward(Mesh2* m, int to, MeshEntity* e)
@@ -489,93 +493,323 @@ void packEntity(
     packRemotes(m, to, e);
 }
 
-static MeshEntity* unpackEntity(
+/* bytes packed during the phases of moveEntities,
+   see reportMigrationBytes */
+struct MigrationBytes
+{
+  MigrationBytes()
+  {
+    for (int d=0; d < 4; ++d)
+      entities[d] = 0;
+    echo = 0;
+    remotes = 0;
+  }
+  long entities[4];
+  long echo;
+  long remotes;
+};
+
+template <class T>
+static void packColumn(int to, std::vector<T> const& column, long& bytes)
+{
+  size_t n = column.size();
+  PCU_COMM_PACK(to,n);
+  if (n)
+    PCU_Comm_Pack(to,&(column[0]),n*sizeof(T));
+  bytes += sizeof(n) + n*sizeof(T);
+}
+
+template <class T>
+static void unpackColumn(std::vector<T>& column)
+{
+  size_t n;
+  PCU_COMM_UNPACK(n);
+  column.resize(n);
+  if (n)
+    PCU_Comm_Unpack(&(column[0]),n*sizeof(T));
+}
+
+static void getTagData(Mesh2* m, MeshEntity* e, MeshTag* t, double* d)
+{
+  m->getDoubleTag(e,t,d);
+}
+
+static void getTagData(Mesh2* m, MeshEntity* e, MeshTag* t, int* d)
+{
+  m->getIntTag(e,t,d);
+}
+
+static void getTagData(Mesh2* m, MeshEntity* e, MeshTag* t, long* d)
+{
+  m->getLongTag(e,t,d);
+}
+
+static void setTagData(Mesh2* m, MeshEntity* e, MeshTag* t, double* d)
+{
+  m->setDoubleTag(e,t,d);
+}
+
+static void setTagData(Mesh2* m, MeshEntity* e, MeshTag* t, int* d)
+{
+  m->setIntTag(e,t,d);
+}
+
+static void setTagData(Mesh2* m, MeshEntity* e, MeshTag* t, long* d)
+{
+  m->setLongTag(e,t,d);
+}
+
+template <class T>
+static void packTagColumn(
     Mesh2* m,
-    DynamicArray<MeshTag*>& tags)
+    int to,
+    MeshTag* tag,
+    EntityVector const& entities,
+    std::vector<int> const& which,
+    long& bytes)
 {
-  int from = PCU_Comm_Sender();
-  int type;
-  PCU_COMM_UNPACK(type);
-  MeshEntity* sender;
-  ModelEntity* c;
-  Parts residence;
-  unpackCommon(m,sender,c,residence);
-  MeshEntity* entity;
-  if (type == Mesh::VERTEX)
-    entity = unpackVertex(m,c);
-  else
-    entity = unpackNonVertex(m,type,c);
-  m->setResidence(entity,residence);
-  unpackTags(m,entity,tags);
-  Copies remotes;
-  /* temporarily store the sender as
-     the only remote copy */
-  m->addRemote(entity, from, sender);
-  return entity;
+  int size = m->getTagSize(tag);
+  std::vector<T> data(which.size()*size);
+  for (size_t i=0; i < which.size(); ++i)
+    getTagData(m,entities[which[i]],tag,&(data[i*size]));
+  packColumn(to,data,bytes);
 }
 
-static void sendEntities(
+template <class T>
+static void unpackTagColumn(
     Mesh2* m,
-    EntityVector& senders,
-    DynamicArray<MeshTag*>& tags)
+    MeshTag* tag,
+    MeshEntity** entities,
+    std::vector<int> const& which)
 {
-  APF_ITERATE(EntityVector,senders,it)
+  int size = m->getTagSize(tag);
+  std::vector<T> data;
+  unpackColumn(data);
+  PCU_ALWAYS_ASSERT(data.size() == which.size()*size);
+  for (size_t i=0; i < which.size(); ++i)
+    setTagData(m,entities[which[i]],tag,&(data[i*size]));
+}
+
+/* packs the entities of one dimension going to one part as
+   columns: types, classification, residences, coordinates
+   or downward references to the receiver's own copies,
+   and one column per tag that any of them carries.
+   The receiver answers with its new copies in the same
+   order, so no sender handles are sent along.
+   The downward references stay handles because a closure
+   entity may have reached the receiver earlier in this
+   migration from another part, or already been there, and
+   the sender only knows it by the remote copy handle. Naming
+   it by index instead would take a migration-wide numbering
+   of the closure, which costs another exchange. */
+static void packColumns(
+    Mesh2* m,
+    int to,
+    EntityVector const& entities,
+    DynamicArray<MeshTag*>& tags,
+    long& bytes)
+{
+  size_t n = entities.size();
+  std::vector<int> types(n);
+  std::vector<int> modelTypes(n);
+  std::vector<int> modelTags(n);
+  std::vector<int> residenceSizes(n);
+  std::vector<int> residences;
+  std::vector<double> coordinates;
+  std::vector<MeshEntity*> down;
+  for (size_t i=0; i < n; ++i)
   {
-    MeshEntity* entity = *it;
-    Copies remotes;
-    m->getRemotes(entity,remotes);
+    MeshEntity* e = entities[i];
+    types[i] = m->getType(e);
+    ModelEntity* me = m->toModel(e);
+    modelTypes[i] = m->getModelType(me);
+    modelTags[i] = m->getModelTag(me);
     Parts residence;
-    m->getResidence(entity,residence);
-    Parts sendTo;
-    split(remotes,residence,sendTo);
-    APF_ITERATE(Parts,sendTo,sit)
-      packEntity(m,*sit,entity,tags);
+    m->getResidence(e,residence);
+    residenceSizes[i] = residence.size();
+    residences.insert(residences.end(),residence.begin(),residence.end());
+    if (types[i] == Mesh::VERTEX)
+    {
+      Vector3 x[2];
+      m->getPoint(e,0,x[0]);
+      m->getParam(e,x[1]);
+      for (int j=0; j < 2; ++j)
+        for (int k=0; k < 3; ++k)
+          coordinates.push_back(x[j][k]);
+    }
+    else
+    {
+      Downward de;
+      int nd = m->getDownward(e,getDimension(m,e)-1,de);
+      for (int j=0; j < nd; ++j)
+        down.push_back(getReference(m,to,de[j]));
+    }
+  }
+  packColumn(to,types,bytes);
+  packColumn(to,modelTypes,bytes);
+  packColumn(to,modelTags,bytes);
+  packColumn(to,residenceSizes,bytes);
+  packColumn(to,residences,bytes);
+  packColumn(to,coordinates,bytes);
+  packColumn(to,down,bytes);
+  std::vector<std::vector<int> > which(tags.getSize());
+  size_t ntags = 0;
+  for (size_t t=0; t < tags.getSize(); ++t)
+  {
+    for (size_t i=0; i < n; ++i)
+      if (m->hasTag(entities[i],tags[t]))
+        which[t].push_back(i);
+    if ( ! which[t].empty())
+      ++ntags;
+  }
+  PCU_COMM_PACK(to,ntags);
+  bytes += sizeof(ntags);
+  for (size_t t=0; t < tags.getSize(); ++t)
+  {
+    if (which[t].empty())
+      continue;
+    PCU_COMM_PACK(to,t);
+    bytes += sizeof(t);
+    packColumn(to,which[t],bytes);
+    switch (m->getTagType(tags[t]))
+    {
+      case Mesh2::DOUBLE:
+        packTagColumn<double>(m,to,tags[t],entities,which[t],bytes);
+        break;
+      case Mesh2::INT:
+        packTagColumn<int>(m,to,tags[t],entities,which[t],bytes);
+        break;
+      case Mesh2::LONG:
+        packTagColumn<long>(m,to,tags[t],entities,which[t],bytes);
+        break;
+    }
   }
 }
 
-static void receiveEntities(
+static void unpackColumns(
     Mesh2* m,
     DynamicArray<MeshTag*>& tags,
     EntityVector& received)
 {
-  received.reserve(1024);
-  while (PCU_Comm_Receive())
-    received.push_back(unpackEntity(m,tags));
+  std::vector<int> types;
+  std::vector<int> modelTypes;
+  std::vector<int> modelTags;
+  std::vector<int> residenceSizes;
+  std::vector<int> residences;
+  std::vector<double> coordinates;
+  std::vector<MeshEntity*> down;
+  unpackColumn(types);
+  unpackColumn(modelTypes);
+  unpackColumn(modelTags);
+  unpackColumn(residenceSizes);
+  unpackColumn(residences);
+  unpackColumn(coordinates);
+  unpackColumn(down);
+  size_t first = received.size();
+  size_t ri = 0;
+  size_t ci = 0;
+  size_t di = 0;
+  for (size_t i=0; i < types.size(); ++i)
+  {
+    int type = types[i];
+    ModelEntity* c = m->findModelEntity(modelTypes[i],modelTags[i]);
+    MeshEntity* e;
+    if (type == Mesh::VERTEX)
+    {
+      double const* x = &(coordinates[ci]);
+      e = m->createVertex(c,Vector3(x),Vector3(x + 3));
+      ci += 6;
+    }
+    else
+    {
+      int nd = Mesh::adjacentCount[type][Mesh::typeDimension[type]-1];
+      e = m->createEntity(type,c,&(down[di]));
+      di += nd;
+    }
+    Parts residence;
+    for (int j=0; j < residenceSizes[i]; ++j)
+      residence.insert(residences[ri++]);
+    m->setResidence(e,residence);
+    received.push_back(e);
+  }
+  size_t ntags;
+  PCU_COMM_UNPACK(ntags);
+  PCU_ALWAYS_ASSERT_VERBOSE(ntags<=tags.getSize(),
+      "A tag was created that does not exist on all processes.");
+  for (size_t k=0; k < ntags; ++k)
+  {
+    size_t t;
+    PCU_COMM_UNPACK(t);
+    std::vector<int> which;
+    unpackColumn(which);
+    MeshEntity** entities = &(received[first]);
+    switch (m->getTagType(tags[t]))
+    {
+      case Mesh2::DOUBLE:
+        unpackTagColumn<double>(m,tags[t],entities,which);
+        break;
+      case Mesh2::INT:
+        unpackTagColumn<int>(m,tags[t],entities,which);
+        break;
+      case Mesh2::LONG:
+        unpackTagColumn<long>(m,tags[t],entities,which);
+        break;
+    }
+  }
 }
 
-static void echoRemotes(
+typedef std::map<int,EntityVector> PeerEntities;
+
+/* sends the senders of one dimension to the new parts of
+   their residence, and gives the senders their new
+   remote copies from the echoed handles.
+   Remote copies are stored as the peer's handles, so the
+   new copies have to be echoed to the sender before
+   bcastRemotes can tell every copy about the others */
+static void sendColumns(
     Mesh2* m,
-    EntityVector& received)
+    EntityVector& senders,
+    DynamicArray<MeshTag*>& tags,
+    long& bytes,
+    long& echoBytes)
 {
-  APF_ITERATE(EntityVector,received,it)
+  PeerEntities outgoing;
+  APF_ITERATE(EntityVector,senders,it)
   {
     MeshEntity* entity = *it;
-    /* unpackEntity() stored the identity of the
-       sender as the only remote copy so we could use
-       it here to echo copies back to their sender */
-    Copies temp;
-    m->getRemotes(entity,temp);
-    int from = temp.begin()->first;
-    MeshEntity* sender = temp.begin()->second;
-    PCU_COMM_PACK(from,sender);
-    PCU_COMM_PACK(from,entity);
+    Copies remotes;
+    m->getRemotes(entity,remotes);
+    Parts residence;
+    m->getResidence(entity,residence);
+    Parts sendTo;
+    split(remotes,residence,sendTo);
+    APF_ITERATE(Parts,sendTo,sit)
+      outgoing[*sit].push_back(entity);
   }
-}
-
-static void receiveRemotes(Mesh2* m)
-{
+  PCU_Comm_Begin();
+  APF_ITERATE(PeerEntities,outgoing,it)
+    packColumns(m,it->first,it->second,tags,bytes);
+  PCU_Comm_Send();
+  PeerEntities incoming;
   while (PCU_Comm_Listen())
   {
-    int from = PCU_Comm_Sender();
+    EntityVector& received = incoming[PCU_Comm_Sender()];
     while ( ! PCU_Comm_Unpacked())
-    {
-      MeshEntity* sender;
-      PCU_COMM_UNPACK(sender);
-      MeshEntity* entity;
-      PCU_COMM_UNPACK(entity);
-      PCU_ALWAYS_ASSERT(entity);
-      m->addRemote(sender, from, entity);
-    }
+      unpackColumns(m,tags,received);
+  }
+  PCU_Comm_Begin();
+  APF_ITERATE(PeerEntities,incoming,it)
+    packColumn(it->first,it->second,echoBytes);
+  PCU_Comm_Send();
+  while (PCU_Comm_Listen())
+  {
+    int from = PCU_Comm_Sender();
+    EntityVector copies;
+    unpackColumn(copies);
+    EntityVector& sent = outgoing[from];
+    PCU_ALWAYS_ASSERT(copies.size() == sent.size());
+    for (size_t i=0; i < sent.size(); ++i)
+      m->addRemote(sent[i],from,copies[i]);
   }
 }
 
@@ -632,7 +866,8 @@ static void unpackCopies(
 
 static void bcastRemotes(
     Mesh2* m,
-    EntityVector& senders)
+    EntityVector& senders,
+    long& bytes)
 {
   PCU_Comm_Begin();
   int rank = PCU_Comm_Self();
@@ -648,6 +883,8 @@ static void bcastRemotes(
       PCU_COMM_PACK(rit->first,rit->second);
       packCopies(rit->first,newCopies);
     }
+    bytes += allRemotes.size() * (sizeof(MeshEntity*) + sizeof(int) +
+        newCopies.size() * (sizeof(int) + sizeof(MeshEntity*)));
     newCopies.erase(rank);
     m->setRemotes(e,newCopies);
   }
@@ -663,16 +900,18 @@ static void bcastRemotes(
   }
 }
 
-static void setupRemotes(
-    Mesh2* m,
-    EntityVector& received,
-    EntityVector& senders)
+static void reportMigrationBytes(MigrationBytes& b)
 {
-  PCU_Comm_Begin();
-  echoRemotes(m,received);
-  PCU_Comm_Send();
-  receiveRemotes(m);
-  bcastRemotes(m,senders);
+  long bytes[6];
+  for (int d=0; d < 4; ++d)
+    bytes[d] = b.entities[d];
+  bytes[4] = b.echo;
+  bytes[5] = b.remotes;
+  PCU_Add_Longs(bytes,6);
+  if ( ! PCU_Comm_Self())
+    lion_oprint(2,"migration bytes: entities %ld %ld %ld %ld, "
+        "echoed copies %ld, remote copies %ld\n",
+        bytes[0],bytes[1],bytes[2],bytes[3],bytes[4],bytes[5]);
 }
 
 void moveEntities(
@@ -681,16 +920,16 @@ void moveEntities(
 {
   DynamicArray<MeshTag*> tags;
   m->getTags(tags);
+  MigrationBytes bytes;
   int maxDimension = m->getDimension();
   for (int dimension = 0; dimension <= maxDimension; ++dimension)
   {
-    PCU_Comm_Begin();
-    sendEntities(m,senders[dimension],tags);
-    PCU_Comm_Send();
-    EntityVector received;
-    receiveEntities(m,tags,received);
-    setupRemotes(m,received,senders[dimension]);
+    sendColumns(m,senders[dimension],tags,
+        bytes.entities[dimension],bytes.echo);
+    bcastRemotes(m,senders[dimension],bytes.remotes);
   }
+  if (lion_get_verbosity() >= 2)
+    reportMigrationBytes(bytes);
 }
 
 /* before this call senders are matched to one another
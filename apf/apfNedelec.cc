@@ -1218,9 +1218,12 @@ void projectNedelecField(Field* to, Field* from)
     }
     m->end(it);
 
-    // take care of entities on part boundary
-    accumulate(to);
-    accumulate(count);
+    // take care of entities on part boundary, all three
+    // exchanges go through the same neighbors
+    Sharing* shr = getSharing(m);
+    pcu_plan* plan = makeNeighborPlan(m, shr);
+    accumulate(to, shr, false, plan);
+    accumulate(count, shr, false, plan);
 
     for (int d = 0; d <= m->getDimension(); d++) {
       if (!fs->hasNodesIn(d)) continue;
@@ -1237,7 +1240,9 @@ void projectNedelecField(Field* to, Field* from)
       m->end(it);
     }
     // take care of entities on part boundary
-    synchronize(to);
+    synchronize(to, shr, plan);
+    PCU_Plan_Free(plan);
+    delete shr;
 
     m->removeField(count);
     destroyField(count);
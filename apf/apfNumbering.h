@@ -222,6 +222,32 @@ void getNodes(GlobalNumbering* n, DynamicArray<Node>& nodes);
   number the vertices and elements of a mesh */
 MeshTag* reorder(Mesh* mesh, const char* name);
 
+/** \brief entity orderings for locality, see apf::orderVertices */
+enum Ordering
+{
+  /** \brief breadth-first traversal of the vertex graph */
+  BREADTH_FIRST,
+  /** \brief reverse Cuthill-McKee, lowers the graph bandwidth */
+  REVERSE_CUTHILL_MCKEE,
+  /** \brief Hilbert space-filling curve through the coordinates */
+  HILBERT_CURVE,
+  /** \brief Morton (Z-order) space-filling curve */
+  MORTON_CURVE
+};
+
+/** \brief label the part's vertices 0..n-1 in the given order
+  \details the result is a single-integer vertex tag,
+  which can be given to apf::reorderMdsMesh.
+  Space-filling curves use the vertex coordinates
+  while the others traverse the edges of the part */
+MeshTag* orderVertices(Mesh* mesh, Ordering o, const char* name);
+
+/** \brief label the part's elements 0..n-1 in the given order
+  \details space-filling curves use element centroids,
+  the graph orderings label elements as they are first
+  reached from the vertices in that order */
+MeshTag* orderElements(Mesh* mesh, Ordering o, const char* name);
+
 void globalize(Numbering* n);
 
 /** \brief number all components by simple iteration */
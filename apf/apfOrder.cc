@@ -0,0 +1,319 @@
+/*
+ * Copyright 2011 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfMesh.h"
+#include "apfNumbering.h"
+
+#include <algorithm>
+#include <vector>
+#include <pcu_util.h>
+
+namespace apf {
+
+/* the vertex graph of the part in compressed rows,
+   vertices are indexed in iteration order */
+struct VertexGraph
+{
+  std::vector<MeshEntity*> verts;
+  std::vector<int> offset;
+  std::vector<int> adj;
+  int degree(int v) const {return offset[v + 1] - offset[v];}
+};
+
+static void buildVertexGraph(Mesh* m, VertexGraph& g)
+{
+  MeshTag* index = m->createIntTag("apf_order_index", 1);
+  MeshIterator* it = m->begin(0);
+  MeshEntity* v;
+  int n = 0;
+  while ((v = m->iterate(it))) {
+    m->setIntTag(v, index, &n);
+    g.verts.push_back(v);
+    ++n;
+  }
+  m->end(it);
+  g.offset.assign(n + 1, 0);
+  for (int i = 0; i < n; ++i) {
+    Adjacent edges;
+    m->getAdjacent(g.verts[i], 1, edges);
+    for (size_t j = 0; j < edges.getSize(); ++j) {
+      int o;
+      m->getIntTag(getEdgeVertOppositeVert(m, edges[j], g.verts[i]),
+          index, &o);
+      g.adj.push_back(o);
+    }
+    g.offset[i + 1] = g.adj.size();
+  }
+  for (int i = 0; i < n; ++i)
+    m->removeTag(g.verts[i], index);
+  m->destroyTag(index);
+}
+
+/* like the MDS breadth-first numbering: start from a vertex
+   on the lowest dimensional model entity, then continue with
+   any vertices in other connected components */
+static void breadthFirst(Mesh* m, VertexGraph& g, std::vector<int>& order)
+{
+  int n = g.verts.size();
+  std::vector<bool> seen(n, false);
+  int seed = 0;
+  int best = 4;
+  for (int i = 0; i < n; ++i) {
+    int d = m->getModelType(m->toModel(g.verts[i]));
+    if (d < best) {
+      best = d;
+      seed = i;
+    }
+  }
+  for (int s = -1; s < n; ++s) {
+    int start = (s < 0) ? seed : s;
+    if (!n || seen[start])
+      continue;
+    size_t first = order.size();
+    seen[start] = true;
+    order.push_back(start);
+    for (; first < order.size(); ++first) {
+      int v = order[first];
+      for (int j = g.offset[v]; j < g.offset[v + 1]; ++j)
+        if (!seen[g.adj[j]]) {
+          seen[g.adj[j]] = true;
+          order.push_back(g.adj[j]);
+        }
+    }
+  }
+}
+
+struct ByDegree
+{
+  ByDegree(VertexGraph const& graph):g(graph) {}
+  bool operator()(int a, int b) const
+  {
+    if (g.degree(a) != g.degree(b))
+      return g.degree(a) < g.degree(b);
+    return a < b;
+  }
+  VertexGraph const& g;
+};
+
+/* fills (level) with the breadth-first levels from (root) over
+   the vertices not yet numbered, returns the deepest level and
+   the lowest degree vertex in it */
+static int getLevels(VertexGraph const& g, std::vector<bool> const& done,
+    int root, std::vector<int>& level, int& last)
+{
+  std::vector<int> queue(1, root);
+  std::fill(level.begin(), level.end(), -1);
+  level[root] = 0;
+  for (size_t i = 0; i < queue.size(); ++i) {
+    int v = queue[i];
+    for (int j = g.offset[v]; j < g.offset[v + 1]; ++j) {
+      int u = g.adj[j];
+      if (done[u] || level[u] >= 0)
+        continue;
+      level[u] = level[v] + 1;
+      queue.push_back(u);
+    }
+  }
+  int depth = level[queue.back()];
+  last = queue.back();
+  for (size_t i = 0; i < queue.size(); ++i)
+    if (level[queue[i]] == depth && ByDegree(g)(queue[i], last))
+      last = queue[i];
+  return depth;
+}
+
+/* George and Liu's search for a pseudo-peripheral vertex */
+static int findPeripheral(VertexGraph const& g, std::vector<bool> const& done,
+    int root, std::vector<int>& level)
+{
+  int last;
+  int depth = getLevels(g, done, root, level, last);
+  while (last != root) {
+    int next;
+    int nextDepth = getLevels(g, done, last, level, next);
+    if (nextDepth <= depth)
+      break;
+    root = last;
+    depth = nextDepth;
+    last = next;
+  }
+  return root;
+}
+
+static void reverseCuthillMcKee(VertexGraph& g, std::vector<int>& order)
+{
+  int n = g.verts.size();
+  std::vector<bool> done(n, false);
+  std::vector<int> level(n);
+  std::vector<int> byDegree(n);
+  for (int i = 0; i < n; ++i)
+    byDegree[i] = i;
+  std::sort(byDegree.begin(), byDegree.end(), ByDegree(g));
+  std::vector<int> next;
+  for (int s = 0; s < n; ++s) {
+    if (done[byDegree[s]])
+      continue;
+    int start = findPeripheral(g, done, byDegree[s], level);
+    size_t first = order.size();
+    done[start] = true;
+    order.push_back(start);
+    for (; first < order.size(); ++first) {
+      int v = order[first];
+      next.clear();
+      for (int j = g.offset[v]; j < g.offset[v + 1]; ++j)
+        if (!done[g.adj[j]]) {
+          done[g.adj[j]] = true;
+          next.push_back(g.adj[j]);
+        }
+      std::sort(next.begin(), next.end(), ByDegree(g));
+      order.insert(order.end(), next.begin(), next.end());
+    }
+  }
+  std::reverse(order.begin(), order.end());
+}
+
+enum { CURVE_BITS = 21 };
+
+/* Skilling's transform of coordinates into the transposed
+   Hilbert index, "Programming the Hilbert curve", 2004 */
+static void axesToTranspose(unsigned x[3])
+{
+  unsigned M = 1u << (CURVE_BITS - 1);
+  for (unsigned q = M; q > 1; q >>= 1) {
+    unsigned p = q - 1;
+    for (int i = 0; i < 3; ++i)
+      if (x[i] & q)
+        x[0] ^= p;
+      else {
+        unsigned t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+  }
+  for (int i = 1; i < 3; ++i)
+    x[i] ^= x[i - 1];
+  unsigned t = 0;
+  for (unsigned q = M; q > 1; q >>= 1)
+    if (x[2] & q)
+      t ^= q - 1;
+  for (int i = 0; i < 3; ++i)
+    x[i] ^= t;
+}
+
+static unsigned long long interleave(unsigned const x[3])
+{
+  unsigned long long key = 0;
+  for (int b = CURVE_BITS - 1; b >= 0; --b)
+    for (int i = 0; i < 3; ++i)
+      key = (key << 1) | ((x[i] >> b) & 1);
+  return key;
+}
+
+typedef std::pair<unsigned long long, int> CurveKey;
+
+/* sorts points along a space-filling curve through their bounding box */
+static void orderPoints(std::vector<Vector3> const& points, Ordering o,
+    std::vector<int>& order)
+{
+  if (points.empty())
+    return;
+  Vector3 lo = points[0];
+  Vector3 hi = points[0];
+  for (size_t i = 1; i < points.size(); ++i)
+    for (int j = 0; j < 3; ++j) {
+      lo[j] = std::min(lo[j], points[i][j]);
+      hi[j] = std::max(hi[j], points[i][j]);
+    }
+  double cells = (1u << CURVE_BITS) - 1;
+  std::vector<CurveKey> keys(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    unsigned x[3];
+    for (int j = 0; j < 3; ++j) {
+      double w = hi[j] - lo[j];
+      x[j] = w > 0 ? unsigned((points[i][j] - lo[j]) / w * cells) : 0;
+    }
+    if (o == HILBERT_CURVE)
+      axesToTranspose(x);
+    keys[i] = CurveKey(interleave(x), i);
+  }
+  std::sort(keys.begin(), keys.end());
+  for (size_t i = 0; i < keys.size(); ++i)
+    order.push_back(keys[i].second);
+}
+
+static bool isCurve(Ordering o)
+{
+  return o == HILBERT_CURVE || o == MORTON_CURVE;
+}
+
+MeshTag* orderVertices(Mesh* m, Ordering o, const char* name)
+{
+  VertexGraph g;
+  buildVertexGraph(m, g);
+  std::vector<int> order;
+  if (isCurve(o)) {
+    std::vector<Vector3> points(g.verts.size());
+    for (size_t i = 0; i < g.verts.size(); ++i)
+      m->getPoint(g.verts[i], 0, points[i]);
+    orderPoints(points, o, order);
+  } else if (o == REVERSE_CUTHILL_MCKEE)
+    reverseCuthillMcKee(g, order);
+  else
+    breadthFirst(m, g, order);
+  PCU_ALWAYS_ASSERT(order.size() == g.verts.size());
+  MeshTag* t = m->createIntTag(name, 1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    int label = i;
+    m->setIntTag(g.verts[order[i]], t, &label);
+  }
+  return t;
+}
+
+MeshTag* orderElements(Mesh* m, Ordering o, const char* name)
+{
+  int dim = m->getDimension();
+  MeshTag* t = m->createIntTag(name, 1);
+  int label = 0;
+  if (isCurve(o)) {
+    std::vector<MeshEntity*> elements;
+    std::vector<Vector3> points;
+    MeshIterator* it = m->begin(dim);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      elements.push_back(e);
+      points.push_back(getLinearCentroid(m, e));
+    }
+    m->end(it);
+    std::vector<int> order;
+    orderPoints(points, o, order);
+    for (size_t i = 0; i < order.size(); ++i, ++label)
+      m->setIntTag(elements[order[i]], t, &label);
+    return t;
+  }
+  /* graph orderings number the vertices first and then
+     the elements in the order they are first reached */
+  VertexGraph g;
+  buildVertexGraph(m, g);
+  std::vector<int> order;
+  if (o == REVERSE_CUTHILL_MCKEE)
+    reverseCuthillMcKee(g, order);
+  else
+    breadthFirst(m, g, order);
+  for (size_t i = 0; i < order.size(); ++i) {
+    Adjacent elements;
+    m->getAdjacent(g.verts[order[i]], dim, elements);
+    for (size_t j = 0; j < elements.getSize(); ++j)
+      if (!m->hasTag(elements[j], t)) {
+        m->setIntTag(elements[j], t, &label);
+        ++label;
+      }
+  }
+  PCU_ALWAYS_ASSERT(size_t(label) == m->count(dim));
+  return t;
+}
+
+}
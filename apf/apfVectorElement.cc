@@ -22,7 +22,6 @@ VectorElement::VectorElement(VectorField* f, VectorElement* p):
 
 double VectorElement::div(Vector3 const& xi)
 {
-  NewArray<Vector3> globalGradients;
   getGlobalGradients(xi,globalGradients);
   Vector3* nodeValues = getNodeValues();
   double d = globalGradients[0] * nodeValues[0];
@@ -33,7 +32,6 @@ double VectorElement::div(Vector3 const& xi)
 
 void VectorElement::curl(Vector3 const& xi, Vector3& c)
 {
-  NewArray<Vector3> globalGradients;
   getGlobalGradients(xi,globalGradients);
   Vector3* nodeValues = getNodeValues();
   c = cross(globalGradients[0],nodeValues[0]);
@@ -53,14 +51,12 @@ void VectorElement::gradHelper(
 
 void VectorElement::grad(Vector3 const& xi, Matrix3x3& g)
 {
-  NewArray<Vector3> globalGradients;
   getGlobalGradients(xi,globalGradients);
   gradHelper(globalGradients,g);
 }
 
 void VectorElement::getJacobian(Vector3 const& xi, Matrix3x3& J)
 {
-  NewArray<Vector3> localGradients;
   this->shape->getLocalGradients(mesh, entity, xi, localGradients);
   gradHelper(localGradients,J);
 }
@@ -18,6 +18,11 @@
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <thread>
 #include <stdint.h>
 #include <vector>
 #include <apfVtk.h>
@@ -63,8 +68,55 @@ static bool isIP(FieldBase* f, int cellDim)
   return s->hasNodesIn(cellDim);
 }
 
+/* the .vtu piece being written by writeVtuFile.
+   in appended mode the binary arrays go into its raw buffer
+   and the DataArray headers only carry their offsets. */
+struct VtuPiece
+{
+  VtkOptions const* options;
+  std::string appended;
+  std::vector<char> scratch;
+  /* positions of zero-padded offsets in the piece text,
+     shifted once the pieces sharing a file are known */
+  bool padOffsets;
+  std::vector<std::pair<size_t,size_t> > offsets;
+};
+
+static void describeFormat(std::ostream& file,
+    VtuPiece* piece,
+    bool isWritingBinary)
+{
+  if (!isWritingBinary)
+  {
+    file << " format=\"ascii\"";
+  }
+  else if (piece && piece->options->appended)
+  {
+    file << " format=\"appended\" offset=\"";
+    size_t offset = piece->appended.size();
+    if (piece->padOffsets)
+    {
+      piece->offsets.push_back(std::make_pair(
+            (size_t)file.tellp(), offset));
+      char padded[21];
+      snprintf(padded, sizeof(padded), "%020lu", (unsigned long)offset);
+      file << padded;
+    }
+    else
+    {
+      file << offset;
+    }
+    file << '"';
+  }
+  else
+  {
+    file << " format=\"binary\"";
+  }
+}
+
 static void describeArray(
     std::ostream& file,
+    VtuPiece* piece,
     const char* name,
     int type,
     int size,
@@ -74,15 +126,8 @@ static void describeArray(
   const char* typeNames[3] = {"Float64","Int32","Int64"};
   file << typeNames[type];
   file << "\" Name=\"" << name;
-  file << "\" NumberOfComponents=\"" << size;
-  if (isWritingBinary)
-  {
-    file << "\" format=\"binary\"";
-  }
-  else
-  {
-    file << "\" format=\"ascii\"";
-  }
+  file << "\" NumberOfComponents=\"" << size << '"';
+  describeFormat(file, piece, isWritingBinary);
 }
 
 static void writePDataArray(
@@ -93,7 +138,7 @@ static void writePDataArray(
     bool isWritingBinary = false)
 {
   file << "<PDataArray ";
-  describeArray(file,name,type,size,isWritingBinary);
+  describeArray(file,0,name,type,size,isWritingBinary);
   file << "/>\n";
 }
 
@@ -103,7 +148,7 @@ static void writePDataArray(
     bool isWritingBinary = false)
 {
   file << "<PDataArray ";
-  describeArray(file,
+  describeArray(file,0,
       f->getName(),
       f->getScalarType(),
       f->countComponents(),
@@ -254,9 +299,9 @@ static std::string getRelativePathPSource(int id)
   return ss.str();
 }
 
-static void writePSources(std::ostream& file)
+static void writePSources(std::ostream& file, int files)
 {
-  for (int i=0; i < PCU_Comm_Peers(); ++i)
+  for (int i=0; i < files; ++i)
   {
     std::string fileName = stripPath(getPieceFileName(i));
     std::string fileNameAndPath = getRelativePathPSource(i) + fileName;
@@ -268,7 +313,8 @@ static void writePvtuFile(const char* prefix,
     Mesh* m,
     std::vector<std::string> writeFields,
     bool isWritingBinary,
-    int cellDim)
+    int cellDim,
+    int files)
 {
   std::string fileName = stripPath(prefix);
   fileName += ".pvtu";
@@ -282,51 +328,116 @@ static void writePvtuFile(const char* prefix,
   writePPoints(file,m->getCoordinateField(),isWritingBinary);
   writePPointData(file,m,writeFields,isWritingBinary);
   writePCellData(file, m, writeFields, isWritingBinary, cellDim);
-  writePSources(file);
+  writePSources(file, files);
   file << "</PUnstructuredGrid>\n";
   file << "</VTKFile>\n";
 }
 
 static void writeDataHeader(std::ostream& file,
+    VtuPiece& piece,
     const char* name,
     int type,
     int size,
     bool isWritingBinary = false)
 {
   file << "<DataArray ";
-  describeArray(file,name,type,size,isWritingBinary);
+  describeArray(file,&piece,name,type,size,isWritingBinary);
   file << ">\n";
 }
 
+static void compressRange(char const* data, size_t dataLen,
+    size_t blockLen, char* out, size_t outBlockLen,
+    uint64_t* sizes, size_t first, size_t last)
+{
+  for (size_t i = first; i < last; ++i)
+  {
+    size_t begin = i * blockLen;
+    unsigned long outLen = outBlockLen;
+    lion::compress(out + i * outBlockLen, outLen,
+        data + begin, std::min(blockLen, dataLen - begin));
+    sizes[i] = outLen;
+  }
+}
+
+/* compresses the data in blocks of VtkOptions::blockSize bytes,
+   filling the vtkZLibDataCompressor header
+   [#blocks, block size, last block size, compressed sizes...]
+   and leaving the blocks packed at the start of scratch */
+static void compressBlocks(char const* data, size_t dataLen,
+    VtkOptions const& options, std::vector<char>& scratch,
+    std::vector<uint64_t>& header)
+{
+  size_t blockLen = dataLen;
+  if (options.blockSize && options.blockSize < dataLen)
+    blockLen = options.blockSize;
+  size_t blocks = blockLen ? (dataLen + blockLen - 1) / blockLen : 1;
+  header.resize(3 + blocks);
+  header[0] = blocks;
+  header[1] = blockLen;
+  header[2] = dataLen - (blocks - 1) * blockLen;
+  uint64_t* sizes = &header[3];
+  size_t outBlockLen = lion::compressBound(blockLen);
+  scratch.resize(blocks * outBlockLen);
+  char* out = &scratch[0];
+  size_t threads = options.threads;
+  if (!threads)
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  threads = std::min(threads, blocks);
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < threads; ++i)
+    workers.push_back(std::thread(compressRange, data, dataLen,
+          blockLen, out, outBlockLen, sizes,
+          (blocks * i) / threads, (blocks * (i + 1)) / threads));
+  compressRange(data, dataLen, blockLen, out, outBlockLen, sizes,
+      0, blocks / threads);
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  size_t packed = sizes[0];
+  for (size_t i = 1; i < blocks; ++i)
+  {
+    std::copy(out + i * outBlockLen, out + i * outBlockLen + sizes[i],
+        out + packed);
+    packed += sizes[i];
+  }
+  scratch.resize(packed);
+}
+
 static void writeEncodedArray(std::ostream& file,
-    unsigned int dataLenBytes,
+    VtuPiece& piece,
+    size_t dataLenBytes,
     char* dataToEncode)
 {
+  bool isAppending = piece.options->appended;
   if ( lion::can_compress )
   {
-    //build the data header and compress dataToEncode
-    long lensToEncode[4];
-    lensToEncode[0] = 1; //data is compressed in one block
-    lensToEncode[1] = dataLenBytes; //size of each block before compression
-    lensToEncode[2] = dataLenBytes; //size of the final block before compression
-    unsigned long dataCompressedLen = lion::compressBound(dataLenBytes);
-        //gets the size to allocate for the compressed data array
-    char* dataCompressed = new char[dataCompressedLen]();
-    lion::compress( (void*)dataCompressed,
-        dataCompressedLen,
-        (void*)dataToEncode,
-        dataLenBytes);
-        //compresses and sets dataCompressedLen to the size of the correct length
-    lensToEncode[3] = dataCompressedLen; //size of the compressed block
-    //encode and output the compressed data
-    file << lion::base64Encode( (char*)lensToEncode, sizeof(lensToEncode) );
-    file << lion::base64Encode( dataCompressed, dataCompressedLen ) << '\n';
-    delete[] dataCompressed;
+    std::vector<char>& scratch = piece.scratch;
+    std::vector<uint64_t> header;
+    compressBlocks(dataToEncode, dataLenBytes, *(piece.options), scratch,
+        header);
+    char* headerData = (char*)&header[0];
+    size_t headerLen = header.size() * sizeof(uint64_t);
+    if (isAppending)
+    {
+      piece.appended.append(headerData, headerLen);
+      piece.appended.append(scratch.begin(), scratch.end());
+    }
+    else
+    {
+      file << lion::base64Encode( headerData, headerLen );
+      file << lion::base64Encode( &scratch[0], scratch.size() ) << '\n';
+    }
+  }
+  else if (isAppending)
+  {
+    uint64_t len = dataLenBytes;
+    piece.appended.append((char*)&len, sizeof(len));
+    piece.appended.append(dataToEncode, dataLenBytes);
   }
   else
   {
     //not compressing, encode and output
-    file << lion::base64Encode( (char*)&dataLenBytes, sizeof(dataLenBytes) );
+    unsigned int len = dataLenBytes;
+    file << lion::base64Encode( (char*)&len, sizeof(len) );
     file << lion::base64Encode( dataToEncode, dataLenBytes ) << '\n';
   }
 }
@@ -337,30 +448,36 @@ static void writeEncodedArray(std::ostream& file,
  * http://www.paraview.org/Bug/view.php?id=15925
  *
  * This function exists to cast "double" to "float"
- * before writing it to file, the others are to maintain the
- * templated design of writeNodalField and others */
+ * before writing it to file, or with VtkOptions::fullPrecision
+ * to flush just the sub-normal values to zero.
+ * The others are to maintain the templated design of
+ * writeNodalField and others */
 
-static float workaround(double v)
+static double workaround(VtuPiece const& piece, double v)
 {
+  if (piece.options->fullPrecision)
+    return std::fpclassify(v) == FP_SUBNORMAL ? 0 : v;
   return static_cast<float>(v);
 }
-static int workaround(int v)
+static int workaround(VtuPiece const&, int v)
 {
   return v;
 }
-static long workaround(long v)
+static long workaround(VtuPiece const&, long v)
 {
   return v;
 }
 
 template <class T>
 static void writeNodalField(std::ostream& file,
+    VtuPiece& piece,
     FieldBase* f,
     DynamicArray<Node>& nodes,
     bool isWritingBinary = false)
 {
   int nc = f->countComponents();
-  writeDataHeader(file,f->getName(),f->getScalarType(),nc,isWritingBinary);
+  writeDataHeader(file,piece,f->getName(),f->getScalarType(),nc,
+      isWritingBinary);
   NewArray<T> nodalData(nc);
   FieldDataOf<T>* data = static_cast<FieldDataOf<T>*>(f->getData());
   if (isWritingBinary)
@@ -378,7 +495,7 @@ static void writeNodalField(std::ostream& file,
         dataIndex++;
       }
     }
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    writeEncodedArray(file, piece, dataLenBytes, (char*)dataToEncode);
     delete [] dataToEncode;
   }
   else
@@ -388,7 +505,47 @@ static void writeNodalField(std::ostream& file,
       data->getNodeComponents(nodes[i].entity,nodes[i].node,&(nodalData[0]));
       for (int j = 0; j < nc; ++j)
       {
-        file << workaround(nodalData[j]) << ' ';
+        file << workaround(piece, nodalData[j]) << ' ';
+      }
+      file << '\n';
+    }
+  }
+  file << "</DataArray>\n";
+}
+
+/* with one node per vertex the overlap node numbers follow
+   vertex iteration order, so points and connectivity can be
+   written from the bulk spans of apf::Mesh */
+static bool hasOnlyVertexNodes(Mesh* m)
+{
+  FieldShape* s = m->getShape();
+  for (int d = 1; d <= m->getDimension(); ++d)
+    if (s->hasNodesIn(d))
+      return false;
+  return s->countNodesOn(Mesh::VERTEX) == 1;
+}
+
+static void writeLinearPoints(std::ostream& file,
+    VtuPiece& piece,
+    Mesh* m,
+    bool isWritingBinary)
+{
+  writeDataHeader(file,piece,m->getCoordinateField()->getName(),
+      Mesh::DOUBLE,3,isWritingBinary);
+  MeshSpan<double> points;
+  m->getPoints(points);
+  if (isWritingBinary)
+  {
+    writeEncodedArray(file, piece, points.getSize()*sizeof(double),
+        (char*)points.getData());
+  }
+  else
+  {
+    for (size_t i = 0; i < points.getSize(); i += 3)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        file << workaround(piece, points[i + j]) << ' ';
       }
       file << '\n';
     }
@@ -397,12 +554,17 @@ static void writeNodalField(std::ostream& file,
 }
 
 static void writePoints(std::ostream& file,
+    VtuPiece& piece,
     Mesh* m,
     DynamicArray<Node>& nodes,
     bool isWritingBinary = false)
 {
   file << "<Points>\n";
-  writeNodalField<double>(file,m->getCoordinateField(),nodes,isWritingBinary);
+  if (hasOnlyVertexNodes(m))
+    writeLinearPoints(file,piece,m,isWritingBinary);
+  else
+    writeNodalField<double>(file,piece,m->getCoordinateField(),nodes,
+        isWritingBinary);
   file << "</Points>\n";
 }
 
@@ -411,24 +573,81 @@ static int countElementNodes(Numbering* n, MeshEntity* e)
   return n->getShape()->getEntityShape(n->getMesh()->getType(e))->countNodes();
 }
 
-static void writeConnectivity(std::ostream& file,
-    Numbering* n,
+static void writeLinearConnectivity(std::ostream& file,
+    VtuPiece& piece,
+    Mesh* m,
     bool isWritingBinary,
     int cellDim)
 {
-  file << "<DataArray type=\"Int32\" Name=\"connectivity\"";
+  MeshSpan<int> spans[Mesh::TYPES];
+  size_t next[Mesh::TYPES] = {};
+  size_t dataLen = 0;
+  int kinds = 0;
+  int type = 0;
+  for (int t = 0; t < Mesh::TYPES; ++t)
+  {
+    if (Mesh::typeDimension[t] != cellDim)
+      continue;
+    m->getElementVertices(t, spans[t]);
+    if (!spans[t].getSize())
+      continue;
+    dataLen += spans[t].getSize();
+    ++kinds;
+    type = t;
+  }
+  if (isWritingBinary && kinds == 1)
+  {
+    writeEncodedArray(file, piece, dataLen*sizeof(int),
+        (char*)spans[type].getData());
+    return;
+  }
+  /* mixed meshes interleave the types in element iteration order */
+  int* dataToEncode = 0;
   if (isWritingBinary)
+    dataToEncode = new int[dataLen]();
+  size_t dataIndex = 0;
+  MeshIterator* elements = m->begin(cellDim);
+  MeshEntity* e;
+  while ((e = m->iterate(elements)))
   {
-    file << " format=\"binary\"";
+    int t = m->getType(e);
+    int nv = Mesh::adjacentCount[t][0];
+    int const* v = spans[t].getData() + next[t];
+    next[t] += nv;
+    for (int i = 0; i < nv; ++i)
+    {
+      if (isWritingBinary)
+        dataToEncode[dataIndex++] = v[i];
+      else
+        file << v[i] << ' ';
+    }
+    if (!isWritingBinary)
+      file << '\n';
   }
-  else
+  m->end(elements);
+  if (isWritingBinary)
   {
-    file << " format=\"ascii\"";
+    writeEncodedArray(file, piece, dataLen*sizeof(int), (char*)dataToEncode);
+    delete [] dataToEncode;
   }
+}
+
+static void writeConnectivity(std::ostream& file,
+    VtuPiece& piece,
+    Numbering* n,
+    bool isWritingBinary,
+    int cellDim)
+{
+  file << "<DataArray type=\"Int32\" Name=\"connectivity\"";
+  describeFormat(file, &piece, isWritingBinary);
   file << ">\n";
   Mesh* m = n->getMesh();
   MeshEntity* e;
-  if (isWritingBinary)
+  if (hasOnlyVertexNodes(m))
+  {
+    writeLinearConnectivity(file, piece, m, isWritingBinary, cellDim);
+  }
+  else if (isWritingBinary)
   {
     MeshIterator* elements = m->begin(cellDim);
     unsigned int dataLen = 0;
@@ -453,7 +672,7 @@ static void writeConnectivity(std::ostream& file,
       }
     }
     m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    writeEncodedArray(file, piece, dataLenBytes, (char*)dataToEncode);
     delete [] dataToEncode;
   }
   else
@@ -476,19 +695,13 @@ static void writeConnectivity(std::ostream& file,
 }
 
 static void writeOffsets(std::ostream& file,
+    VtuPiece& piece,
     Numbering* n,
     bool isWritingBinary,
     int cellDim)
 {
   file << "<DataArray type=\"Int32\" Name=\"offsets\"";
-  if (isWritingBinary)
-  {
-    file << " format=\"binary\"";
-  }
-  else
-  {
-    file << " format=\"ascii\"";
-  }
+  describeFormat(file, &piece, isWritingBinary);
   file << ">\n";
   Mesh* m = n->getMesh();
   MeshEntity* e;
@@ -513,7 +726,7 @@ static void writeOffsets(std::ostream& file,
       dataIndex++;
     }
     m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    writeEncodedArray(file, piece, dataLenBytes, (char*)dataToEncode);
     delete [] dataToEncode;
   }
   else
@@ -531,19 +744,13 @@ static void writeOffsets(std::ostream& file,
 }
 
 static void writeTypes(std::ostream& file,
+    VtuPiece& piece,
     Mesh* m,
     bool isWritingBinary,
     int cellDim)
 {
   file << "<DataArray type=\"UInt8\" Name=\"types\"";
-  if (isWritingBinary)
-  {
-    file << " format=\"binary\"";
-  }
-  else
-  {
-    file << " format=\"ascii\"";
-  }
+  describeFormat(file, &piece, isWritingBinary);
   file << ">\n";
   MeshEntity* e;
   int order = m->getShape()->getOrder();
@@ -579,7 +786,7 @@ static void writeTypes(std::ostream& file,
       dataIndex++;
     }
     m->end(elements);
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    writeEncodedArray(file, piece, dataLenBytes, (char*)dataToEncode);
     delete [] dataToEncode;
   }
   else
@@ -595,18 +802,20 @@ static void writeTypes(std::ostream& file,
 }
 
 static void writeCells(std::ostream& file,
+    VtuPiece& piece,
     Numbering* n,
     bool isWritingBinary,
     int cellDim)
 {
   file << "<Cells>\n";
-  writeConnectivity(file, n, isWritingBinary, cellDim);
-  writeOffsets(file, n, isWritingBinary, cellDim);
-  writeTypes(file, n->getMesh(), isWritingBinary, cellDim);
+  writeConnectivity(file, piece, n, isWritingBinary, cellDim);
+  writeOffsets(file, piece, n, isWritingBinary, cellDim);
+  writeTypes(file, piece, n->getMesh(), isWritingBinary, cellDim);
   file << "</Cells>\n";
 }
 
 static void writePointData(std::ostream& file,
+    VtuPiece& piece,
     Mesh* m,
     DynamicArray<Node>& nodes,
     std::vector<std::string> writeFields,
@@ -618,7 +827,7 @@ static void writePointData(std::ostream& file,
     Field* f = m->getField(i);
     if (isNodal(f) && shouldPrint(f,writeFields))
     {
-      writeNodalField<double>(file,f,nodes,isWritingBinary);
+      writeNodalField<double>(file,piece,f,nodes,isWritingBinary);
     }
   }
   for (int i=0; i < m->countNumberings(); ++i)
@@ -626,7 +835,7 @@ static void writePointData(std::ostream& file,
     Numbering* n = m->getNumbering(i);
     if (isNodal(n) && shouldPrint(n,writeFields))
     {
-      writeNodalField<int>(file,n,nodes,isWritingBinary);
+      writeNodalField<int>(file,piece,n,nodes,isWritingBinary);
     }
   }
   for (int i=0; i < m->countGlobalNumberings(); ++i)
@@ -634,7 +843,7 @@ static void writePointData(std::ostream& file,
     GlobalNumbering* n = m->getGlobalNumbering(i);
     if (isNodal(n) && shouldPrint(n,writeFields))
     {
-      writeNodalField<long>(file,n,nodes,isWritingBinary);
+      writeNodalField<long>(file,piece,n,nodes,isWritingBinary);
     }
   }
   file << "</PointData>\n";
@@ -650,6 +859,7 @@ class WriteIPField : public FieldOp
     FieldDataOf<T>* data;
     MeshEntity* entity;
     std::ostream* fp;
+    VtuPiece* piece;
     bool isWritingBinary;
     int cellDim;
 
@@ -677,7 +887,7 @@ class WriteIPField : public FieldOp
         else
         {
           //otherwise simply write to the file
-          (*fp) << workaround(ipData[i]) << ' ';
+          (*fp) << workaround(*piece, ipData[i]) << ' ';
         }
       }
       if (!isWritingBinary)
@@ -690,6 +900,7 @@ class WriteIPField : public FieldOp
       std::string s = getIPName(f,point);
       components = f->countComponents();
       writeDataHeader(*fp,
+        *piece,
         s.c_str(),
         f->getScalarType(),
         f->countComponents(),
@@ -708,7 +919,8 @@ class WriteIPField : public FieldOp
 
         //encode and write to file
         int dataLenBytes = arraySize * sizeof(T);
-        writeEncodedArray( (*fp), dataLenBytes, (char*)dataToEncode);
+        writeEncodedArray( (*fp), *piece, dataLenBytes,
+            (char*)dataToEncode);
 
         //free array
         delete [] dataToEncode;
@@ -721,6 +933,7 @@ class WriteIPField : public FieldOp
       (*fp) << "</DataArray>\n";
     }
     void run(std::ostream& file,
+      VtuPiece& pieceArg,
       FieldBase* f,
       bool isWritingBinaryArg,
       int cellDimArg)
@@ -728,6 +941,7 @@ class WriteIPField : public FieldOp
       isWritingBinary = isWritingBinaryArg;
       cellDim = cellDimArg;
       fp = &file;
+      piece = &pieceArg;
       dataIndex = 0;
       int n = countIPs(f, cellDim);
       for (point=0; point < n; ++point)
@@ -738,11 +952,13 @@ class WriteIPField : public FieldOp
 };
 
 static void writeCellParts(std::ostream& file,
+    VtuPiece& piece,
     Mesh* m,
     bool isWritingBinary,
     int cellDim)
 {
-  writeDataHeader(file, "apf_part", apf::Mesh::INT, 1, isWritingBinary);
+  writeDataHeader(file, piece, "apf_part", apf::Mesh::INT, 1,
+      isWritingBinary);
   size_t n = m->count(cellDim);
   int id = m->getId();
   if (isWritingBinary)
@@ -754,7 +970,7 @@ static void writeCellParts(std::ostream& file,
     {
       dataToEncode[i] = id;
     }
-    writeEncodedArray(file, dataLenBytes, (char*)dataToEncode);
+    writeEncodedArray(file, piece, dataLenBytes, (char*)dataToEncode);
     file << "</DataArray>\n";
     delete [] dataToEncode;
   }
@@ -769,6 +985,7 @@ static void writeCellParts(std::ostream& file,
 }
 
 static void writeCellData(std::ostream& file,
+    VtuPiece& piece,
     Mesh* m,
     std::vector<std::string> writeFields,
     bool isWritingBinary,
@@ -781,7 +998,7 @@ static void writeCellData(std::ostream& file,
     Field* f = m->getField(i);
     if (isIP(f, cellDim) && shouldPrint(f,writeFields))
     {
-      wd.run(file, f, isWritingBinary, cellDim);
+      wd.run(file, piece, f, isWritingBinary, cellDim);
     }
   }
   WriteIPField<int> wi;
@@ -790,7 +1007,7 @@ static void writeCellData(std::ostream& file,
     Numbering* n = m->getNumbering(i);
     if (isIP(n, cellDim) && shouldPrint(n,writeFields))
     {
-      wi.run(file, n, isWritingBinary, cellDim);
+      wi.run(file, piece, n, isWritingBinary, cellDim);
     }
   }
   WriteIPField<long> wl;
@@ -799,10 +1016,10 @@ static void writeCellData(std::ostream& file,
     GlobalNumbering* n = m->getGlobalNumbering(i);
     if (isIP(n, cellDim) && shouldPrint(n,writeFields))
     {
-      wl.run(file, n, isWritingBinary, cellDim);
+      wl.run(file, piece, n, isWritingBinary, cellDim);
     }
   }
-  writeCellParts(file, m, isWritingBinary, cellDim);
+  writeCellParts(file, piece, m, isWritingBinary, cellDim);
   file << "</CellData>\n";
 }
 
@@ -826,63 +1043,195 @@ static std::string getFileNameAndPathVtu(const char* prefix,
   return ss.str();
 }
 
+/* the parts writing pieces into one .vtu file,
+   and the number of that file among all of them */
+struct VtuGroup
+{
+  MPI_Comm comm;
+  int file;
+  int files;
+};
+
+static VtuGroup makeVtuGroup(int partsPerFile)
+{
+  VtuGroup group;
+  int self = PCU_Comm_Self();
+  if (partsPerFile == 1)
+  {
+    group.comm = MPI_COMM_SELF;
+    group.file = self;
+    group.files = PCU_Comm_Peers();
+    return group;
+  }
+  if (partsPerFile > 1)
+    MPI_Comm_split(PCU_Get_Comm(), self / partsPerFile, self, &group.comm);
+  else
+    MPI_Comm_split_type(PCU_Get_Comm(), MPI_COMM_TYPE_SHARED, self,
+        MPI_INFO_NULL, &group.comm);
+  int rank;
+  MPI_Comm_rank(group.comm, &rank);
+  int leader = (rank == 0);
+  group.file = PCU_Exscan_Int(leader);
+  group.files = PCU_Add_Int(leader);
+  MPI_Bcast(&group.file, 1, MPI_INT, 0, group.comm);
+  return group;
+}
+
+static void freeVtuGroup(VtuGroup& group)
+{
+  if (group.comm != MPI_COMM_SELF)
+    MPI_Comm_free(&group.comm);
+}
+
+static void writeAt(MPI_File file, MPI_Offset at, std::string const& s)
+{
+  size_t done = 0;
+  while (done < s.size())
+  {
+    int n = std::min(s.size() - done, (size_t)std::numeric_limits<int>::max());
+    if (MPI_File_write_at(file, at + done, (void*)(s.data() + done), n,
+          MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      reel_fail("apf: MPI_File_write_at failed for a .vtu file");
+    done += n;
+  }
+}
+
+/* every part of the group writes its piece text and its appended
+   data at offsets found by prefix sums, after shifting the
+   padded appended offsets in its piece text past those of the
+   parts before it. the first part writes the shared text. */
+static void writeGroupVtuFile(std::string const& fileNameAndPath,
+    VtuGroup const& group,
+    std::string const& head,
+    std::string& body,
+    std::string const& middle,
+    VtuPiece const& p,
+    std::string const& tail)
+{
+  int rank;
+  MPI_Comm_rank(group.comm, &rank);
+  long lens[2] = {(long)body.size(), (long)p.appended.size()};
+  long bases[2] = {0, 0};
+  long totals[2];
+  MPI_Exscan(lens, bases, 2, MPI_LONG, MPI_SUM, group.comm);
+  if (rank == 0)
+    bases[0] = bases[1] = 0;
+  MPI_Allreduce(lens, totals, 2, MPI_LONG, MPI_SUM, group.comm);
+  for (size_t i = 0; i < p.offsets.size(); ++i)
+  {
+    char padded[21];
+    snprintf(padded, sizeof(padded), "%020lu",
+        (unsigned long)(bases[1] + p.offsets[i].second));
+    body.replace(p.offsets[i].first, 20, padded);
+  }
+  MPI_File file;
+  if (MPI_File_open(group.comm, fileNameAndPath.c_str(),
+        MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file)
+      != MPI_SUCCESS)
+    reel_fail("apf: could not open \"%s\"\n", fileNameAndPath.c_str());
+  MPI_Offset at = head.size();
+  MPI_File_set_size(file,
+      at + totals[0] + middle.size() + totals[1] + tail.size());
+  if (rank == 0)
+    writeAt(file, 0, head);
+  writeAt(file, at + bases[0], body);
+  at += totals[0];
+  if (rank == 0)
+    writeAt(file, at, middle);
+  at += middle.size();
+  writeAt(file, at + bases[1], p.appended);
+  at += totals[1];
+  if (rank == 0)
+    writeAt(file, at, tail);
+  MPI_File_close(&file);
+}
+
 static void writeVtuFile(const char* prefix,
     Numbering* n,
     std::vector<std::string> writeFields,
-    bool isWritingBinary,
-    int cellDim)
+    VtkOptions const& options,
+    int cellDim,
+    VtuGroup const& group)
 {
   double t0 = PCU_Time();
-  std::string fileName = getPieceFileName(PCU_Comm_Self());
-  std::string fileNameAndPath = getFileNameAndPathVtu(prefix, fileName, PCU_Comm_Self());
-  std::stringstream buf;
+  bool isWritingBinary = options.binary;
+  std::string fileName = getPieceFileName(group.file);
+  std::string fileNameAndPath = getFileNameAndPathVtu(prefix, fileName,
+      group.file);
+  int groupSize;
+  MPI_Comm_size(group.comm, &groupSize);
+  VtuPiece p;
+  p.options = &options;
+  p.padOffsets = (groupSize > 1);
+  bool isAppending = isWritingBinary && options.appended;
+  std::stringstream head;
   Mesh* m = n->getMesh();
   DynamicArray<Node> nodes;
   getNodes(n,nodes);
-  buf << "<VTKFile type=\"UnstructuredGrid\"";
+  head << "<VTKFile type=\"UnstructuredGrid\"";
   if (isWritingBinary)
   {
-    buf << " byte_order=";
+    head << " byte_order=";
     if (isBigEndian())
     {
-      buf << "\"BigEndian\"";
+      head << "\"BigEndian\"";
     }
     else
     {
-      buf << "\"LittleEndian\"";
+      head << "\"LittleEndian\"";
     }
-    if (lion::can_compress )
+    if (lion::can_compress || isAppending)
     {
       //TODO determine what the header_type should be definitively
-      buf << " header_type=\"UInt64\"";
-      buf << " compressor=\"vtkZLibDataCompressor\"";
+      head << " header_type=\"UInt64\"";
     }
     else
     {
-      buf << " header_type=\"UInt32\"";
+      head << " header_type=\"UInt32\"";
+    }
+    if (lion::can_compress)
+    {
+      head << " compressor=\"vtkZLibDataCompressor\"";
     }
   }
-  buf<< ">\n";
-  buf << "<UnstructuredGrid>\n";
+  head << ">\n";
+  head << "<UnstructuredGrid>\n";
+  std::stringstream buf;
+  if (options.fullPrecision)
+    buf.precision(std::numeric_limits<double>::max_digits10);
   buf << "<Piece NumberOfPoints=\"" << nodes.getSize();
   buf << "\" NumberOfCells=\"" << m->count(cellDim);
   buf << "\">\n";
-  writePoints(buf,m,nodes,isWritingBinary);
-  writeCells(buf, n, isWritingBinary, cellDim);
-  writePointData(buf,m,nodes,writeFields,isWritingBinary);
-  writeCellData(buf, m, writeFields, isWritingBinary, cellDim);
+  writePoints(buf,p,m,nodes,isWritingBinary);
+  writeCells(buf, p, n, isWritingBinary, cellDim);
+  writePointData(buf,p,m,nodes,writeFields,isWritingBinary);
+  writeCellData(buf, p, m, writeFields, isWritingBinary, cellDim);
   buf << "</Piece>\n";
-  buf << "</UnstructuredGrid>\n";
-  buf << "</VTKFile>\n";
+  std::string middle = "</UnstructuredGrid>\n";
+  std::string tail = "</VTKFile>\n";
+  if (isAppending)
+  {
+    middle += "<AppendedData encoding=\"raw\">\n_";
+    tail = "\n</AppendedData>\n" + tail;
+  }
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
   {
     lion_oprint(1,"writeVtuFile into buffers: %f seconds\n", t1 - t0);
   }
+  if (groupSize == 1)
   { //block forces std::ofstream destructor call
-    std::ofstream file(fileNameAndPath.c_str());
+    std::ofstream file(fileNameAndPath.c_str(), std::ios::binary);
     PCU_ALWAYS_ASSERT(file.is_open());
-    file << buf.rdbuf();
+    file << head.rdbuf() << buf.rdbuf() << middle;
+    file.write(p.appended.data(), p.appended.size());
+    file << tail;
+  }
+  else
+  {
+    std::string body = buf.str();
+    writeGroupVtuFile(fileNameAndPath, group, head.str(), body,
+        middle, p, tail);
   }
   double t2 = PCU_Time();
   if (!PCU_Comm_Self())
@@ -921,24 +1270,37 @@ static void makeVtuSubdirectories(const char* prefix, int numParts)
   }
 }
 
+VtkOptions::VtkOptions():
+  binary(true),
+  appended(false),
+  blockSize(0),
+  threads(1),
+  fullPrecision(false),
+  partsPerFile(1)
+{
+}
+
 void writeVtkFilesRunner(const char* prefix,
     Mesh* m,
     std::vector<std::string> writeFields,
-    bool isWritingBinary,
+    VtkOptions const& options,
     int cellDim)
 {
   if (cellDim == -1) cellDim = m->getDimension();
   double t0 = PCU_Time();
+  VtuGroup group = makeVtuGroup(options.partsPerFile);
   if (!PCU_Comm_Self())
   {
     safe_mkdir(prefix);
-    makeVtuSubdirectories(prefix, PCU_Comm_Peers());
-    writePvtuFile(prefix, m, writeFields, isWritingBinary, cellDim);
+    makeVtuSubdirectories(prefix, group.files);
+    writePvtuFile(prefix, m, writeFields, options.binary, cellDim,
+        group.files);
   }
   PCU_Barrier();
   Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
   m->removeNumbering(n);
-  writeVtuFile(prefix, n, writeFields, isWritingBinary, cellDim);
+  writeVtuFile(prefix, n, writeFields, options, cellDim, group);
+  freeVtuGroup(group);
   double t1 = PCU_Time();
   if (!PCU_Comm_Self())
   {
@@ -981,7 +1343,10 @@ void writeOneVtkFile(const char* prefix, Mesh* m)
   Numbering* n = numberOverlapNodes(m,"apf_vtk_number");
   m->removeNumbering(n);
   std::vector<std::string> writeFields = populateWriteFields(m);
-  writeVtuFile(prefix, n, writeFields, false, m->getDimension());
+  VtkOptions options;
+  options.binary = false;
+  VtuGroup group = makeVtuGroup(1);
+  writeVtuFile(prefix, n, writeFields, options, m->getDimension(), group);
   delete n;
 }
 
@@ -991,7 +1356,17 @@ void writeVtkFiles(
     std::vector<std::string> writeFields,
     int cellDim)
 {
-  writeVtkFilesRunner(prefix, m, writeFields, true, cellDim);
+  writeVtkFilesRunner(prefix, m, writeFields, VtkOptions(), cellDim);
+}
+
+void writeVtkFiles(
+    const char* prefix,
+    Mesh* m,
+    std::vector<std::string> writeFields,
+    VtkOptions const& options,
+    int cellDim)
+{
+  writeVtkFilesRunner(prefix, m, writeFields, options, cellDim);
 }
 
 void writeVtkFiles(const char* prefix, Mesh* m, int cellDim)
@@ -1005,7 +1380,9 @@ void writeASCIIVtkFiles(
     Mesh* m,
     std::vector<std::string> writeFields)
 {
-  writeVtkFilesRunner(prefix, m, writeFields, false, -1);
+  VtkOptions options;
+  options.binary = false;
+  writeVtkFilesRunner(prefix, m, writeFields, options, -1);
 }
 
 void writeASCIIVtkFiles(const char* prefix, Mesh* m)
@@ -43,6 +43,7 @@ set(APF_SOURCES
   apfAdjReorder.cc
   apfVtk.cc
   apfFieldData.cc
+  apfHalo.cc
   apfTagData.cc
   apfCoordData.cc
   apfArrayData.cc
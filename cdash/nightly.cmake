@@ -304,6 +304,7 @@ SET(CONFIGURE_OPTIONS
   "-DCMAKE_CXX_COMPILER:FILEPATH=mpicxx"
   "-DENABLE_ZOLTAN:BOOL=ON"
   "-DPCU_COMPRESS:BOOL=ON"
+  "-DPCU_ZSTD:BOOL=ON"
   "-DIS_TESTING:BOOL=True"
   "-DSCOREC_CXX_WARNINGS:BOOL=ON"
   "-DMESHES:STRING=${MESHES}/meshes"
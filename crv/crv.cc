@@ -163,11 +163,14 @@ int countNumberInvalidElements(apf::Mesh2* m)
       n += (apf::measure(m,e) < 1e-10);
     }
   } else {
-    Quality* qual = makeQuality(m,2);
-    while ((e = m->iterate(it))) {
-      n += (qual->checkValidity(e) > 1);
-    }
-    delete qual;
+    ma::EntityArray elements(m->count(m->getDimension()));
+    size_t i = 0;
+    while ((e = m->iterate(it)))
+      elements[i++] = e;
+    apf::NewArray<int> tags;
+    checkValidity(m,elements,tags);
+    for (i = 0; i < elements.getSize(); ++i)
+      n += (tags[i] > 1);
   }
   m->end(it);
   return n;
@@ -162,6 +162,19 @@ double getQuality(apf::Mesh* m,apf::MeshEntity* e);
   6*dim + 2 + index */
 int checkValidity(apf::Mesh* m, apf::MeshEntity* e,
     int algorithm = 2);
+/** \brief checks the validity of many elements at once
+  \details results[i] is the validity tag of elements[i], as
+  returned by checkValidity above. For non-blended Bezier tets the
+  elements are processed in blocks with precomputed coefficient
+  tables, and in threads if setValidityThreads was called. */
+void checkValidity(apf::Mesh* m, ma::EntityArray& elements,
+    apf::NewArray<int>& results, int algorithm = 2);
+/** \brief Set the number of threads batched validity checks may use.
+  \details The default is one, i.e. no threads. Zero picks the number
+  of hardware threads. */
+void setValidityThreads(int threads);
+/** \brief Get the number of threads set by crv::setValidityThreads */
+int getValidityThreads();
 /** \brief class to store matrices used in
  * quality assessment and validity checking */
 class Quality
@@ -177,6 +190,10 @@ public:
   virtual double getQuality(apf::MeshEntity* e) = 0;
   /** \brief check the validity (det(Jacobian) > eps) of an element */
   virtual int checkValidity(apf::MeshEntity* e) = 0;
+  /** \brief check the validity of many elements, results[i] is
+      checkValidity(elements[i]) */
+  virtual void checkValidity(ma::EntityArray& elements,
+      apf::NewArray<int>& results);
 protected:
   apf::Mesh* mesh;
   int algorithm;
@@ -115,23 +115,28 @@ int markInvalidEntities(Adapt* a)
   ma::Mesh* m = a->mesh;
   int dimension = m->getDimension();
   ma::Iterator* it = m->begin(dimension);
-  Quality* qual = makeQuality(m,2);
+  ma::EntityArray elements(m->count(dimension));
+  size_t n = 0;
   while ((e = m->iterate(it)))
   {
     /* this skip conditional is powerful: it affords us a
        3X speedup of the entire adaptation in some cases */
-    int qualityTag = crv::getTag(a,e);
-    if (qualityTag) continue;
-    qualityTag = qual->checkValidity(e);
-    if (qualityTag >= 2)
+    if (crv::getTag(a,e)) continue;
+    elements[n++] = e;
+  }
+  m->end(it);
+  elements.setSize(n);
+  apf::NewArray<int> qualityTags;
+  checkValidity(m,elements,qualityTags);
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (qualityTags[i] >= 2)
     {
-      crv::setTag(a,e,qualityTag);
-      if (m->isOwned(e))
+      crv::setTag(a,elements[i],qualityTags[i]);
+      if (m->isOwned(elements[i]))
         ++count;
     }
   }
-  m->end(it);
-  delete qual;
   return PCU_Add_Int(count);
 }
 
@@ -234,6 +239,7 @@ void adapt(ma::Input* in)
   crv::clearTags(a);
   delete a;
   // cleanup input object and associated sizefield and solutiontransfer objects
+  in->sizeField->dropCache();
   if (in->ownsSizeField)
     delete in->sizeField;
   if (in->ownsSolutionTransfer)
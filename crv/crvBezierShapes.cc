@@ -14,7 +14,7 @@
 
 namespace crv {
 
-static void bezierCurve(int P, apf::Vector3 const& xi,
+static void bezierCurveGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<double>& values)
 {
   double t = 0.5*(xi[0]+1.);
@@ -24,7 +24,7 @@ static void bezierCurve(int P, apf::Vector3 const& xi,
   values[1] = intpow(t, P);
 }
 
-static void bezierCurveGrads(int P, apf::Vector3 const& xi,
+static void bezierCurveGradsGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<apf::Vector3>& grads)
 {
   double t = 0.5*(xi[0]+1.);
@@ -35,7 +35,7 @@ static void bezierCurveGrads(int P, apf::Vector3 const& xi,
   grads[1] = apf::Vector3(P*intpow(t, P-1)/2.,0,0);
 }
 
-static void bezierTriangle(int P, apf::Vector3 const& xi,
+static void bezierTriangleGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<double>& values)
 {
   double xii[3] = {1.-xi[0]-xi[1],xi[0],xi[1]};
@@ -45,7 +45,7 @@ static void bezierTriangle(int P, apf::Vector3 const& xi,
           trinomial(P,i,j)*Bijk(i,j,P-i-j,xii[0],xii[1],xii[2]);
 }
 
-static void bezierTriangleGrads(int P, apf::Vector3 const& xi,
+static void bezierTriangleGradsGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<apf::Vector3>& grads)
 {
 
@@ -86,7 +86,7 @@ static void bezierTriangleGrads(int P, apf::Vector3 const& xi,
         *trinomial(P,i,j)*Bij(i-1,j-1,xii[0],xii[1]);
 }
 
-static void bezierTet(int P, apf::Vector3 const& xi,
+static void bezierTetGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<double>& values)
 {
   double xii[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
@@ -132,7 +132,7 @@ static void bezierTet(int P, apf::Vector3 const& xi,
 
 }
 
-static void bezierTetGrads(int P, apf::Vector3 const& xi,
+static void bezierTetGradsGeneric(int P, apf::Vector3 const& xi,
     apf::NewArray<apf::Vector3>& grads)
 {
   double xii[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
@@ -231,6 +231,262 @@ static void bezierTetGrads(int P, apf::Vector3 const& xi,
       }
 }
 
+/* Order-specialized kernels. Every Bezier shape function is
+   a multinomial coefficient times a product of powers of the
+   barycentric coordinates. For each order the coefficients and
+   exponents of the nodes are tabulated once, in the node order
+   of the generic evaluators above, and each evaluation computes
+   the powers of the barycentric coordinates once for all nodes.
+   The order is a template parameter so the loops have fixed
+   bounds and the scratch arrays live on the stack. */
+
+static int const maxKernelOrder = 6;
+
+constexpr double factorial(int n)
+{
+  return n <= 1 ? 1. : n * factorial(n - 1);
+}
+
+/* number of Bezier nodes of order P on a simplex
+   with V barycentric coordinates */
+constexpr int countBernstein(int P, int V)
+{
+  return V == 2 ? P + 1 :
+         V == 3 ? (P + 1) * (P + 2) / 2 :
+                  (P + 1) * (P + 2) * (P + 3) / 6;
+}
+
+template <int P, int V>
+class BernsteinKernel
+{
+public:
+  enum { N = countBernstein(P, V) };
+  BernsteinKernel()
+  {
+    if (V == 2) {
+      setNode(0, P, 0, 0);
+      setNode(1, 0, P, 0);
+      for (int i = 1; i < P; ++i)
+        setNode(i + 1, P - i, i, 0);
+    } else if (V == 3) {
+      for (int i = 0; i <= P; ++i)
+        for (int j = 0; j <= P - i; ++j)
+          setNode(getTriNodeIndex(P, i, j), i, j, P - i - j);
+    } else {
+      for (int i = 0; i <= P; ++i)
+        for (int j = 0; j <= P - i; ++j)
+          for (int k = 0; k <= P - i - j; ++k)
+            setNode(getTetNodeIndex(P, i, j, k), i, j, k);
+    }
+  }
+  void getValues(double const b[V], double* values) const
+  {
+    double pw[V][P + 1];
+    getPowers(b, pw);
+    for (int n = 0; n < N; ++n) {
+      double v = coef[n];
+      for (int m = 0; m < V; ++m)
+        v *= pw[m][exps[n][m]];
+      values[n] = v;
+    }
+  }
+  /* derivatives with respect to each barycentric coordinate */
+  void getDerivatives(double const b[V], double (*d)[V]) const
+  {
+    double pw[V][P + 1];
+    double dpw[V][P + 1];
+    getPowers(b, pw);
+    for (int m = 0; m < V; ++m) {
+      dpw[m][0] = 0;
+      for (int a = 1; a <= P; ++a)
+        dpw[m][a] = a * pw[m][a - 1];
+    }
+    for (int n = 0; n < N; ++n) {
+      /* products of the powers before and after each coordinate */
+      double before[V];
+      double after[V];
+      before[0] = coef[n];
+      for (int m = 1; m < V; ++m)
+        before[m] = before[m - 1] * pw[m - 1][exps[n][m - 1]];
+      after[V - 1] = 1;
+      for (int m = V - 1; m > 0; --m)
+        after[m - 1] = after[m] * pw[m][exps[n][m]];
+      for (int m = 0; m < V; ++m)
+        d[n][m] = before[m] * dpw[m][exps[n][m]] * after[m];
+    }
+  }
+private:
+  void setNode(int n, int i, int j, int k)
+  {
+    int a[4] = {i, j, k, P - i - j - k};
+    if (V == 2)
+      a[1] = P - i;
+    if (V == 3)
+      a[2] = P - i - j;
+    coef[n] = factorial(P);
+    for (int m = 0; m < V; ++m) {
+      exps[n][m] = a[m];
+      coef[n] /= factorial(a[m]);
+    }
+  }
+  static void getPowers(double const b[V], double (*pw)[P + 1])
+  {
+    for (int m = 0; m < V; ++m) {
+      pw[m][0] = 1;
+      for (int a = 1; a <= P; ++a)
+        pw[m][a] = pw[m][a - 1] * b[m];
+    }
+  }
+  double coef[N];
+  int exps[N][V];
+};
+
+template <int P>
+static void bezierCurveKernel(apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  static BernsteinKernel<P, 2> const kernel;
+  double t = 0.5*(xi[0]+1.);
+  double b[2] = {1.-t, t};
+  kernel.getValues(b, &values[0]);
+}
+
+template <int P>
+static void bezierCurveGradsKernel(apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  static BernsteinKernel<P, 2> const kernel;
+  double t = 0.5*(xi[0]+1.);
+  double b[2] = {1.-t, t};
+  double d[BernsteinKernel<P, 2>::N][2];
+  kernel.getDerivatives(b, d);
+  for (int n = 0; n < BernsteinKernel<P, 2>::N; ++n)
+    grads[n] = apf::Vector3((d[n][1]-d[n][0])/2.,0,0);
+}
+
+template <int P>
+static void bezierTriangleKernel(apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  static BernsteinKernel<P, 3> const kernel;
+  double b[3] = {1.-xi[0]-xi[1],xi[0],xi[1]};
+  kernel.getValues(b, &values[0]);
+}
+
+template <int P>
+static void bezierTriangleGradsKernel(apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  static BernsteinKernel<P, 3> const kernel;
+  double b[3] = {1.-xi[0]-xi[1],xi[0],xi[1]};
+  double d[BernsteinKernel<P, 3>::N][3];
+  kernel.getDerivatives(b, d);
+  for (int n = 0; n < BernsteinKernel<P, 3>::N; ++n)
+    grads[n] = apf::Vector3(d[n][1]-d[n][0],d[n][2]-d[n][0],0);
+}
+
+template <int P>
+static void bezierTetKernel(apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  static BernsteinKernel<P, 4> const kernel;
+  double b[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
+  kernel.getValues(b, &values[0]);
+}
+
+template <int P>
+static void bezierTetGradsKernel(apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  static BernsteinKernel<P, 4> const kernel;
+  double b[4] = {1.-xi[0]-xi[1]-xi[2],xi[0],xi[1],xi[2]};
+  double d[BernsteinKernel<P, 4>::N][4];
+  kernel.getDerivatives(b, d);
+  for (int n = 0; n < BernsteinKernel<P, 4>::N; ++n)
+    grads[n] = apf::Vector3(d[n][1]-d[n][0],d[n][2]-d[n][0],
+        d[n][3]-d[n][0]);
+}
+
+typedef void (*KernelValues)(apf::Vector3 const& xi,
+    apf::NewArray<double>& values);
+typedef void (*KernelGrads)(apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads);
+
+#define CRV_KERNEL_TABLE(name) \
+  {0, name<1>, name<2>, name<3>, name<4>, name<5>, name<6>}
+
+static KernelValues const curveKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierCurveKernel);
+static KernelGrads const curveGradsKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierCurveGradsKernel);
+static KernelValues const triangleKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierTriangleKernel);
+static KernelGrads const triangleGradsKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierTriangleGradsKernel);
+static KernelValues const tetKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierTetKernel);
+static KernelGrads const tetGradsKernels[maxKernelOrder+1] =
+  CRV_KERNEL_TABLE(bezierTetGradsKernel);
+
+#undef CRV_KERNEL_TABLE
+
+/* the entries of the shape tables below pick the kernel for the
+   order set by getBezier and fall back to the generic evaluators
+   above that */
+static void bezierCurve(int P, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    curveKernels[P](xi,values);
+  else
+    bezierCurveGeneric(P,xi,values);
+}
+
+static void bezierCurveGrads(int P, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    curveGradsKernels[P](xi,grads);
+  else
+    bezierCurveGradsGeneric(P,xi,grads);
+}
+
+static void bezierTriangle(int P, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    triangleKernels[P](xi,values);
+  else
+    bezierTriangleGeneric(P,xi,values);
+}
+
+static void bezierTriangleGrads(int P, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    triangleGradsKernels[P](xi,grads);
+  else
+    bezierTriangleGradsGeneric(P,xi,grads);
+}
+
+static void bezierTet(int P, apf::Vector3 const& xi,
+    apf::NewArray<double>& values)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    tetKernels[P](xi,values);
+  else
+    bezierTetGeneric(P,xi,values);
+}
+
+static void bezierTetGrads(int P, apf::Vector3 const& xi,
+    apf::NewArray<apf::Vector3>& grads)
+{
+  if (P >= 1 && P <= maxKernelOrder)
+    tetGradsKernels[P](xi,grads);
+  else
+    bezierTetGradsGeneric(P,xi,grads);
+}
+
 void collectNodeXi(int parentType, int childType, int P,
     const apf::Vector3* range, apf::NewArray<apf::Vector3>& xi)
 {
@@ -336,4 +592,28 @@ const bezierShapeGrads bezierGrads[apf::Mesh::TYPES] =
   NULL     //pyramid
 };
 
+const bezierShape bezierGeneric[apf::Mesh::TYPES] =
+{
+  NULL,    //vertex
+  bezierCurveGeneric,     //edge
+  bezierTriangleGeneric,  //triangle
+  NULL,    //quad
+  bezierTetGeneric,       //tet
+  NULL,    //hex
+  NULL,    //prism
+  NULL     //pyramid
+};
+
+const bezierShapeGrads bezierGenericGrads[apf::Mesh::TYPES] =
+{
+  NULL,    //vertex
+  bezierCurveGradsGeneric,     //edge
+  bezierTriangleGradsGeneric,  //triangle
+  NULL,    //quad
+  bezierTetGradsGeneric,       //tet
+  NULL,    //hex
+  NULL,    //prism
+  NULL     //pyramid
+};
+
 }
@@ -38,6 +38,12 @@ typedef void (*bezierShapeGrads)(int P,
 extern const bezierShape bezier[apf::Mesh::TYPES];
 /** \brief table of shape function gradients */
 extern const bezierShapeGrads bezierGrads[apf::Mesh::TYPES];
+/** \brief table of order-generic shape functions
+    \details bezier uses order-specialized kernels up to sixth order
+    and these above that; they are also kept as a reference */
+extern const bezierShape bezierGeneric[apf::Mesh::TYPES];
+/** \brief table of order-generic shape function gradients */
+extern const bezierShapeGrads bezierGenericGrads[apf::Mesh::TYPES];
 
 /** \brief Get transformation matrix corresponding to a parametric range
     \details Range is an array of size(num vertices), this is used for
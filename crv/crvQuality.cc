@@ -10,6 +10,9 @@
 #include "crvMath.h"
 #include "crvTables.h"
 #include "crvQuality.h"
+#include <algorithm>
+#include <string>
+#include <thread>
 
 namespace crv {
 
@@ -41,6 +44,7 @@ public:
   };
   virtual ~Quality2D() {};
   double getQuality(apf::MeshEntity* e);
+  using Quality::checkValidity;
   int checkValidity(apf::MeshEntity* e);
   int blendingOrder;
   int n;
@@ -67,10 +71,18 @@ public:
     getBezierTransformationMatrix(apf::Mesh::TET,3*(order-1),A,
         elem_vert_xi[apf::Mesh::TET]);
     invertMatrixWithPLU(n,A,transformationMatrix);
+    setupBatches();
   }
   virtual ~Quality3D() {};
   double getQuality(apf::MeshEntity* e);
   int checkValidity(apf::MeshEntity* e);
+  void checkValidity(ma::EntityArray& elements, apf::NewArray<int>& results);
+  // the checks that follow computeJacDetNodes in checkValidity
+  int checkJacDetNodes(apf::NewArray<double>& nodes);
+  // batched validity, see checkValidity(EntityArray&, ...)
+  void setupBatches();
+  void checkBlock(apf::MeshEntity* const* elements, int count,
+      int* results);
   // 3D uses an alternate method of computing these
   // returns a validity tag so both quality and validity can
   // quit early if this function thinks they should
@@ -81,6 +93,11 @@ public:
   apf::NewArray<double> subdivisionCoeffs[4];
   apf::NewArray<apf::Vector3> xi;
   mth::Matrix<double> transformationMatrix;
+  // shape function gradients at each xi, as [xi][direction][node],
+  // empty when they depend on the element (blending)
+  int nnodes;
+  apf::NewArray<double> gradTable;
+  apf::NewArray<double> transformTable;
 };
 
 Quality* makeQuality(apf::Mesh* m, int algorithm)
@@ -474,17 +491,20 @@ int Quality3D::checkValidity(apf::MeshEntity* e)
   int validityTag = computeJacDetNodes(e,nodes,true);
   if (validityTag > 1)
     return validityTag;
+  return checkJacDetNodes(nodes);
+}
+
+/* this only reads nodes and the precomputed coefficients, so
+   the batched validity check can call it from worker threads */
+int Quality3D::checkJacDetNodes(apf::NewArray<double>& nodes)
+{
 // check verts
-  apf::Downward verts;
-  mesh->getDownward(e,0,verts);
   for (int i = 0; i < 4; ++i){
     if(nodes[i] < minAcceptable){
       return 2+i;
     }
   }
 
-  apf::MeshEntity* edges[6];
-  mesh->getDownward(e,1,edges);
   double minJ = 0, maxJ = 0;
   // Vertices will already be flagged in the first check
   for (int edge = 0; edge < 6; ++edge){
@@ -524,8 +544,6 @@ int Quality3D::checkValidity(apf::MeshEntity* e)
       }
     }
   }
-  apf::MeshEntity* faces[4];
-  mesh->getDownward(e,2,faces);
   for (int face = 0; face < 4; ++face){
     double minJ = -1e10;
     for (int i = 0; i < (3*order-4)*(3*order-5)/2; ++i){
@@ -671,6 +689,203 @@ int Quality3D::computeJacDetNodes(apf::MeshEntity* e,
   return 1;
 }
 
+static int validityThreads = 1;
+
+void setValidityThreads(int threads)
+{
+  if (threads <= 0)
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  validityThreads = threads;
+}
+
+int getValidityThreads()
+{
+  return validityThreads;
+}
+
+void Quality::checkValidity(ma::EntityArray& elements,
+    apf::NewArray<int>& results)
+{
+  results.allocate(elements.getSize());
+  for (size_t i = 0; i < elements.getSize(); ++i)
+    results[i] = checkValidity(elements[i]);
+}
+
+/* the validity tag computeJacDetNodes returns when
+   the Jacobian determinant at xi[index] is too small */
+static int getJacDetNodeTag(int P, int index)
+{
+  if (index < 4)
+    return index+2;
+  int ne = 3*(P-1)-1;
+  if (index < 4+6*ne)
+    return (index-4)/ne+8;
+  int nf = (3*P-4)*(3*P-5)/2;
+  if (index < 4+6*ne+4*nf)
+    return (index-4-6*ne)/nf+14;
+  return 20;
+}
+
+/* For non-blended Bezier tets the shape function gradients at
+   the sampling points do not depend on the element, so they are
+   tabulated once here and the Jacobian determinants of a block
+   of elements become dense products with these tables. */
+void Quality3D::setupBatches()
+{
+  nnodes = 0;
+  if (order < 2 || getBlendingOrder(apf::Mesh::TET) > 0
+      || std::string(mesh->getShape()->getName()) != "Bezier")
+    return;
+  apf::EntityShape* shape =
+    mesh->getShape()->getEntityShape(apf::Mesh::TET);
+  nnodes = shape->countNodes();
+  gradTable.allocate(n*3*nnodes);
+  apf::NewArray<apf::Vector3> grads;
+  for (int i = 0; i < n; ++i) {
+    shape->getLocalGradients(mesh,0,xi[i],grads);
+    for (int d = 0; d < 3; ++d)
+      for (int k = 0; k < nnodes; ++k)
+        gradTable[(i*3+d)*nnodes+k] = grads[k][d];
+  }
+  transformTable.allocate(n*n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      transformTable[i*n+j] = transformationMatrix(i,j);
+}
+
+/* all per-element arrays below are laid out with the element
+   index fastest, so the inner loops run over the block */
+void Quality3D::checkBlock(apf::MeshEntity* const* elements, int count,
+    int* results)
+{
+  apf::NewArray<double> x(3*nnodes*count);
+  apf::NewArray<apf::Vector3> elemNodes;
+  for (int e = 0; e < count; ++e) {
+    apf::Element* elem =
+      apf::createElement(mesh->getCoordinateField(),elements[e]);
+    apf::getVectorNodes(elem,elemNodes);
+    apf::destroyElement(elem);
+    for (int c = 0; c < 3; ++c)
+      for (int k = 0; k < nnodes; ++k)
+        x[(c*nnodes+k)*count+e] = elemNodes[k][c];
+  }
+  /* the first active entries of x and ids belong to elements
+     that have passed every sampling point so far */
+  int active = count;
+  apf::NewArray<int> ids(count);
+  for (int e = 0; e < count; ++e) {
+    ids[e] = e;
+    results[e] = 1;
+  }
+  apf::NewArray<double> dets(n*count);
+  apf::NewArray<double> J(9*count);
+  apf::NewArray<double> det(count);
+  for (int i = 0; i < n && active; ++i) {
+    for (int r = 0; r < 9*count; ++r)
+      J[r] = 0;
+    for (int d = 0; d < 3; ++d)
+      for (int k = 0; k < nnodes; ++k) {
+        double g = gradTable[(i*3+d)*nnodes+k];
+        for (int c = 0; c < 3; ++c) {
+          double* Jdc = &J[(d*3+c)*count];
+          double const* xck = &x[(c*nnodes+k)*count];
+          for (int e = 0; e < active; ++e)
+            Jdc[e] += g*xck[e];
+        }
+      }
+    bool failed = false;
+    for (int e = 0; e < active; ++e) {
+      det[e] =
+          J[0*count+e]*(J[4*count+e]*J[8*count+e]-J[5*count+e]*J[7*count+e])
+        - J[1*count+e]*(J[3*count+e]*J[8*count+e]-J[5*count+e]*J[6*count+e])
+        + J[2*count+e]*(J[3*count+e]*J[7*count+e]-J[4*count+e]*J[6*count+e]);
+      dets[i*count+ids[e]] = det[e];
+      failed = failed || det[e] < 1e-10;
+    }
+    if (!failed)
+      continue;
+    /* like computeJacDetNodes, stop at the first bad point */
+    int kept = 0;
+    for (int e = 0; e < active; ++e) {
+      if (det[e] < 1e-10) {
+        results[ids[e]] = getJacDetNodeTag(order,i);
+        continue;
+      }
+      ids[kept] = ids[e];
+      for (int r = 0; r < 3*nnodes; ++r)
+        x[r*count+kept] = x[r*count+e];
+      ++kept;
+    }
+    active = kept;
+  }
+  /* only elements that passed the sampling check
+     need their Bezier coefficients */
+  int nvalid = active;
+  if (!nvalid)
+    return;
+  apf::NewArray<double> validDets(n*nvalid);
+  for (int i = 0; i < n; ++i)
+    for (int v = 0; v < nvalid; ++v)
+      validDets[i*nvalid+v] = dets[i*count+ids[v]];
+  apf::NewArray<double> coeffs(n*nvalid);
+  for (int i = 0; i < n*nvalid; ++i)
+    coeffs[i] = 0;
+  for (int i = 0; i < n; ++i) {
+    double* ci = &coeffs[i*nvalid];
+    for (int j = 0; j < n; ++j) {
+      double t = transformTable[i*n+j];
+      double const* dj = &validDets[j*nvalid];
+      for (int v = 0; v < nvalid; ++v)
+        ci[v] += t*dj[v];
+    }
+  }
+  apf::NewArray<double> nodes(n);
+  for (int v = 0; v < nvalid; ++v) {
+    for (int i = 0; i < n; ++i)
+      nodes[i] = coeffs[i*nvalid+v];
+    results[ids[v]] = checkJacDetNodes(nodes);
+  }
+}
+
+static int const validityBlockSize = 32;
+
+static void checkRange(Quality3D* q, apf::MeshEntity* const* elements,
+    size_t count, int* results)
+{
+  for (size_t b = 0; b < count; b += validityBlockSize) {
+    int size = std::min<size_t>(validityBlockSize, count - b);
+    q->checkBlock(elements + b, size, results + b);
+  }
+}
+
+/* elements are split into one contiguous range per thread, and
+   each range is checked in blocks; worker threads only read the
+   mesh and this object */
+void Quality3D::checkValidity(ma::EntityArray& elements,
+    apf::NewArray<int>& results)
+{
+  if (!nnodes) {
+    Quality::checkValidity(elements,results);
+    return;
+  }
+  size_t count = elements.getSize();
+  results.allocate(count);
+  if (!count)
+    return;
+  int threads = std::min<size_t>(validityThreads,
+      (count + validityBlockSize - 1) / validityBlockSize);
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; ++i) {
+    size_t b = (count * i) / threads;
+    size_t e = (count * (i + 1)) / threads;
+    workers.push_back(std::thread(checkRange, this,
+          &elements[b], e - b, &results[b]));
+  }
+  checkRange(this, &elements[0], count / threads, &results[0]);
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+}
+
 double Quality2D::getQuality(apf::MeshEntity* e)
 {
   apf::Element* elem = apf::createElement(mesh->getCoordinateField(),e);
@@ -761,6 +976,14 @@ int checkValidity(apf::Mesh* m, apf::MeshEntity* e,
   return validity;
 }
 
+void checkValidity(apf::Mesh* m, ma::EntityArray& elements,
+    apf::NewArray<int>& results, int algorithm)
+{
+  Quality* qual = makeQuality(m,algorithm);
+  qual->checkValidity(elements,results);
+  delete qual;
+}
+
 double getQuality(apf::Mesh* m, apf::MeshEntity* e)
 {
   Quality* qual = makeQuality(m,2);
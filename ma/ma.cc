@@ -46,6 +46,7 @@ void adapt(Input* in)
   Mesh* m = a->mesh;
   delete a;
   // cleanup input object and associated sizefield and solutiontransfer objects
+  in->sizeField->dropCache();
   if (in->ownsSizeField)
     delete in->sizeField;
   if (in->ownsSolutionTransfer)
@@ -71,20 +72,30 @@ void adaptVerbose(Input* in, bool verbose)
   for (int i = 0; i < in->maximumIterations; ++i)
   {
     print("iteration %d",i);
+    double ti = PCU_Time();
+    double t = ti;
     coarsen(a);
+    double tc = PCU_Time() - t;
     if (verbose && in->shouldCoarsen)
       ma_dbg::dumpMeshWithQualities(a,i,"after_coarsen");
     coarsenLayer(a);
     midBalance(a);
+    t = PCU_Time();
     refine(a);
+    double tr = PCU_Time() - t;
     if (verbose)
       ma_dbg::dumpMeshWithQualities(a,i,"after_refine");
+    t = PCU_Time();
     snap(a);
+    double ts = PCU_Time() - t;
     if (verbose && in->shouldSnap)
       ma_dbg::dumpMeshWithQualities(a,i,"after_snap");
     fixElementShapes(a);
     if (verbose && in->shouldFixShape)
       ma_dbg::dumpMeshWithQualities(a,i,"after_fix");
+    if (verbose)
+      print("iteration %d took %f seconds: coarsen %f refine %f snap %f",
+          i,PCU_Time()-ti,tc,tr,ts);
   }
   allowSplitCollapseOutsideLayer(a);
   if (verbose) ma_dbg::dumpMeshWithQualities(a,999,"after_final_fix");
@@ -120,6 +131,7 @@ void adaptVerbose(Input* in, bool verbose)
   Mesh* m = a->mesh;
   delete a;
   // cleanup input object and associated sizefield and solutiontransfer objects
+  in->sizeField->dropCache();
   if (in->ownsSizeField)
     delete in->sizeField;
   if (in->ownsSolutionTransfer)
@@ -19,6 +19,8 @@
 #include "maShapeHandler.h"
 #include "maLayer.h"
 #include <apf.h>
+#include <apfMDS.h>
+#include <algorithm>
 #include <cfloat>
 #include <pcu_util.h>
 #include <stdarg.h>
@@ -29,6 +31,7 @@ Adapt::Adapt(Input* in)
 {
   input = in;
   mesh = in->mesh;
+  mdsTags = apf::isMdsMesh(mesh);
   setupFlags(this);
   setupQualityCache(this);
   deleteCallback = 0;
@@ -48,6 +51,10 @@ Adapt::Adapt(Input* in)
   resetLayer(this);
   if (hasLayer)
     checkLayerShape(mesh, "input mesh");
+  worklists = 0;
+  if (in->shouldUseWorklists && mdsTags && PCU_Comm_Peers() == 1 &&
+      ( ! hasLayer) && ( ! mesh->hasMatching()))
+    worklists = new Worklists(this);
 }
 
 Adapt::~Adapt()
@@ -56,6 +63,7 @@ Adapt::~Adapt()
   clearQualityCache(this);
   delete refine;
   delete shape;
+  delete worklists;
 }
 
 void setupFlags(Adapt* a)
@@ -67,7 +75,8 @@ void clearFlags(Adapt* a)
 {
   Mesh* m = a->mesh;
   Entity* e;
-  for (int d=0; d <= 3; ++d)
+  /* MDS frees all the tag data at once when the tag is destroyed */
+  for (int d=0; d <= 3 && !a->mdsTags; ++d)
   {
     Iterator* it = m->begin(d);
     while ((e = m->iterate(it)))
@@ -81,6 +90,10 @@ void clearFlags(Adapt* a)
 int getFlags(Adapt* a, Entity* e)
 {
   Mesh* m = a->mesh;
+  if (a->mdsTags) {
+    int* p = static_cast<int*>(apf::getMdsTagData(m,a->flagsTag,e));
+    return p ? *p : 0;
+  }
   if ( ! m->hasTag(e,a->flagsTag))
     return 0; //we assume 0 is the default value for all flags
   int flags;
@@ -90,7 +103,10 @@ int getFlags(Adapt* a, Entity* e)
 
 void setFlags(Adapt* a, Entity* e, int flags)
 {
-  a->mesh->setIntTag(e,a->flagsTag,&flags);
+  if (a->mdsTags)
+    *static_cast<int*>(apf::giveMdsTagData(a->mesh,a->flagsTag,e)) = flags;
+  else
+    a->mesh->setIntTag(e,a->flagsTag,&flags);
 }
 
 bool getFlag(Adapt* a, Entity* e, int flag)
@@ -148,6 +164,12 @@ void clearFlagFromDimension(Adapt* a, int flag, int dimension)
   m->end(it);
 }
 
+void clearFlagFromList(Adapt* a, int flag, std::vector<Entity*>& entities)
+{
+  for (size_t i = 0; i < entities.size(); ++i)
+    clearFlag(a, entities[i], flag);
+}
+
 void setupQualityCache(Adapt* a)
 {
   a->qualityCache = a->mesh->createDoubleTag("ma_qual_cache",1);
@@ -158,7 +180,7 @@ void clearQualityCache(Adapt* a)
   Mesh* m = a->mesh;
   Entity* e;
   // only faces and regions can have the quality tag
-  for (int d=2; d <= 3; ++d)
+  for (int d=2; d <= 3 && !a->mdsTags; ++d)
   {
     Iterator* it = m->begin(d);
     while ((e = m->iterate(it)))
@@ -169,12 +191,24 @@ void clearQualityCache(Adapt* a)
   m->destroyTag(a->qualityCache);
 }
 
+bool hasCachedQuality(Adapt* a, Entity* e)
+{
+  if (a->mdsTags)
+    return apf::getMdsTagData(a->mesh,a->qualityCache,e) != 0;
+  return a->mesh->hasTag(e,a->qualityCache);
+}
+
 double getCachedQuality(Adapt* a, Entity* e)
 {
   Mesh* m = a->mesh;
   int type = m->getType(e);
   int ed = apf::Mesh::typeDimension[type];
   PCU_ALWAYS_ASSERT(ed == 2 || ed == 3);
+  if (a->mdsTags) {
+    double* p = static_cast<double*>(
+        apf::getMdsTagData(m,a->qualityCache,e));
+    return p ? *p : 0.0;
+  }
   if ( ! m->hasTag(e,a->qualityCache))
     return 0.0; //we assume 0.0 is the default value for all qualities
   double qual;
@@ -188,7 +222,10 @@ void setCachedQuality(Adapt* a, Entity* e, double q)
   int type = m->getType(e);
   int ed = apf::Mesh::typeDimension[type];
   PCU_ALWAYS_ASSERT(ed == 2 || ed == 3);
-  m->setDoubleTag(e,a->qualityCache,&q);
+  if (a->mdsTags)
+    *static_cast<double*>(apf::giveMdsTagData(m,a->qualityCache,e)) = q;
+  else
+    m->setDoubleTag(e,a->qualityCache,&q);
 }
 
 void destroyElement(Adapt* a, Entity* e)
@@ -324,6 +361,84 @@ long markEntities(
   return PCU_Add_Long(count);
 }
 
+long markEntities(
+    Adapt* a,
+    std::vector<Entity*>& entities,
+    Predicate& predicate,
+    int trueFlag,
+    int setFalseFlag,
+    int allFalseFlags)
+{
+  if (!allFalseFlags) allFalseFlags = setFalseFlag;
+  pruneWorklist(a, entities);
+  size_t n = 0;
+  for (size_t i = 0; i < entities.size(); ++i)
+  {
+    Entity* e = entities[i];
+    PCU_ALWAYS_ASSERT( ! getFlag(a,e,trueFlag));
+    if (allFalseFlags & getFlags(a,e))
+      continue;
+    if (predicate(e))
+    {
+      setFlag(a,e,trueFlag);
+      entities[n++] = e;
+    }
+    else
+      setFlag(a,e,setFalseFlag);
+  }
+  entities.resize(n);
+  return n;
+}
+
+Worklists::Worklists(Adapt* a)
+{
+  adapt = a;
+  Mesh* m = a->mesh;
+  Iterator* it = m->begin(1);
+  Entity* e;
+  while ((e = m->iterate(it)))
+    edgesToSplit.push_back(e);
+  m->end(it);
+  edgesToCollapse = edgesToSplit;
+  it = m->begin(0);
+  while ((e = m->iterate(it)))
+    vertsToSnap.push_back(e);
+  m->end(it);
+}
+
+void Worklists::call(Entity* e)
+{
+  int d = getDimension(adapt->mesh, e);
+  if (d == 0)
+    vertsToSnap.push_back(e);
+  else if (d == 1)
+  {
+    edgesToSplit.push_back(e);
+    edgesToCollapse.push_back(e);
+  }
+  if (adapt->buildCallback)
+    adapt->buildCallback->call(e);
+}
+
+/* MDS handles of one entity type compare in the
+   order the iterators visit them, and worklists only
+   hold vertices or edges */
+void pruneWorklist(Adapt* a, std::vector<Entity*>& entities)
+{
+  std::sort(entities.begin(), entities.end());
+  size_t n = 0;
+  for (size_t i = 0; i < entities.size(); ++i)
+  {
+    Entity* e = entities[i];
+    if (n && entities[n - 1] == e)
+      continue;
+    if ( ! apf::isMdsEntityLive(a->mesh, e))
+      continue;
+    entities[n++] = e;
+  }
+  entities.resize(n);
+}
+
 void NewEntities::reset()
 {
   entities.clear();
@@ -437,8 +552,9 @@ Entity* buildVertex(
     Vector const& param)
 {
   Entity* v = a->mesh->createVertex(c,point,param);
-  if (a->buildCallback)
-    a->buildCallback->call(v);
+  apf::BuildCallback* cb = getBuildCallback(a);
+  if (cb)
+    cb->call(v);
   return v;
 }
 
@@ -448,7 +564,7 @@ Entity* buildElement(
     int type,
     Entity** verts)
 {
-  return apf::buildElement(a->mesh,c,type,verts,a->buildCallback);
+  return apf::buildElement(a->mesh,c,type,verts,getBuildCallback(a));
 }
 
 Entity* rebuildElement(
@@ -457,7 +573,15 @@ Entity* rebuildElement(
     Entity* oldVert,
     Entity* newVert)
 {
-  return rebuildElement(a->mesh,original,oldVert,newVert,a->buildCallback);
+  return rebuildElement(a->mesh,original,oldVert,newVert,
+      getBuildCallback(a));
+}
+
+apf::BuildCallback* getBuildCallback(Adapt* a)
+{
+  if (a->worklists)
+    return a->worklists;
+  return a->buildCallback;
 }
 
 void setBuildCallback(Adapt* a, apf::BuildCallback* cb)
@@ -40,6 +40,7 @@ class DeleteCallback;
 class SolutionTransfer;
 class Refine;
 class ShapeHandler;
+class Worklists;
 
 class Adapt
 {
@@ -50,6 +51,7 @@ class Adapt
     Mesh* mesh;
     Tag* flagsTag;
     Tag* qualityCache; // to avoid repeated quality computations
+    bool mdsTags; // the two tags above are read as MDS arrays
     DeleteCallback* deleteCallback;
     apf::BuildCallback* buildCallback;
     SizeField* sizeField;
@@ -59,6 +61,7 @@ class Adapt
     int coarsensLeft;
     int refinesLeft;
     bool hasLayer;
+    Worklists* worklists; // zero unless Input::shouldUseWorklists applies
 };
 
 void setTolerance(Adapt* a, double t);
@@ -75,9 +78,11 @@ void clearFlag(Adapt* a, Entity* e, int flag);
 void clearFlagMatched(Adapt* a, Entity* e, int flag);
 
 void clearFlagFromDimension(Adapt* a, int flag, int dimension);
+void clearFlagFromList(Adapt* a, int flag, std::vector<Entity*>& entities);
 
 void setupQualityCache(Adapt* a);
 void clearQualityCache(Adapt* a);
+bool hasCachedQuality(Adapt* a, Entity* e);
 double getCachedQuality(Adapt* a, Entity* e);
 void   setCachedQuality(Adapt* a, Entity* e, double q);
 
@@ -113,6 +118,38 @@ long markEntities(
     int setFalseFlag,
     int allFalseFlags = 0);
 
+/* like the above, but only evaluates the listed entities.
+   the list is pruned (see pruneWorklist) and then left
+   holding just the entities that were marked. */
+long markEntities(
+    Adapt* a,
+    std::vector<Entity*>& entities,
+    Predicate& predicate,
+    int trueFlag,
+    int setFalseFlag,
+    int allFalseFlags = 0);
+
+/* when Input::shouldUseWorklists applies, these lists stand in
+   for the full-mesh sweeps of the marking steps.
+   The vertices and edges built during adaptation are added
+   as they appear, and each step puts back the entities it
+   left marked for another try. Entries may be repeated or
+   destroyed since, so users call pruneWorklist first. */
+class Worklists : public apf::BuildCallback
+{
+  public:
+    Worklists(Adapt* a);
+    virtual void call(Entity* e);
+    Adapt* adapt;
+    std::vector<Entity*> edgesToSplit;
+    std::vector<Entity*> edgesToCollapse;
+    std::vector<Entity*> vertsToSnap;
+};
+
+/* sorts a worklist into mesh iteration order, dropping
+   repeated and destroyed entities */
+void pruneWorklist(Adapt* a, std::vector<Entity*>& entities);
+
 class NewEntities : public apf::BuildCallback
 {
   public:
@@ -161,6 +198,9 @@ Entity* rebuildElement(
     Entity* oldVert,
     Entity* newVert);
 
+/* the callback to give entity builders, which includes
+   the worklists if they are in use */
+apf::BuildCallback* getBuildCallback(Adapt* a);
 void setBuildCallback(Adapt* a, apf::BuildCallback* cb);
 void clearBuildCallback(Adapt* a);
 
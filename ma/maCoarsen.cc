@@ -25,6 +25,7 @@ class CollapseChecker : public apf::CavityOp
       modelDimension(md)
     {
       collapse.Init(a);
+      setIndependentPulls(a->input->shouldPullIndependentSets);
     }
     virtual Outcome setEntity(Entity* e)
     {
@@ -72,6 +73,7 @@ class IndependentSetFinder : public apf::CavityOp
       adapt(a)
     {
       vertex = 0;
+      setIndependentPulls(a->input->shouldPullIndependentSets);
     }
     virtual Outcome setEntity(Entity* v)
     {
@@ -226,10 +228,61 @@ long markEdgesToCollapse(Adapt* a)
                       DONT_COLLAPSE | NEED_NOT_COLLAPSE);
 }
 
+/* coarsen restricted to the collapse worklist, visiting the
+   marked edges and their vertices in the order of the sweeps
+   above. Vertex COLLAPSE flags are cleared at the end since
+   later calls only look at the vertices of their own edges */
+static bool coarsenWorklist(Adapt* a)
+{
+  double t0 = PCU_Time();
+  --(a->coarsensLeft);
+  std::vector<Entity*> edges;
+  edges.swap(a->worklists->edgesToCollapse);
+  ShouldCollapse p(a);
+  long count = markEntities(a, edges, p, COLLAPSE, NEED_NOT_COLLAPSE,
+                            DONT_COLLAPSE | NEED_NOT_COLLAPSE);
+  if ( ! count)
+    return false;
+  Mesh* m = a->mesh;
+  std::vector<Entity*> verts;
+  for (size_t i = 0; i < edges.size(); ++i)
+  {
+    Entity* v[2];
+    m->getDownward(edges[i], 0, v);
+    verts.push_back(v[0]);
+    verts.push_back(v[1]);
+  }
+  int maxDimension = m->getDimension();
+  long successCount = 0;
+  for (int modelDimension=1; modelDimension <= maxDimension; ++modelDimension)
+  {
+    pruneWorklist(a, edges);
+    CollapseChecker checker(a,modelDimension);
+    checker.applyToEntities(edges);
+    clearFlagFromList(a,CHECKED,edges);
+    pruneWorklist(a, verts);
+    IndependentSetFinder finder(a);
+    finder.applyToEntities(verts);
+    clearFlagFromList(a,CHECKED,verts);
+    AllEdgeCollapser collapser(a,modelDimension);
+    applyOperator(a,&collapser,edges);
+    successCount += collapser.successCount;
+  }
+  pruneWorklist(a, verts);
+  clearFlagFromList(a,COLLAPSE,verts);
+  std::vector<Entity*>& rest = a->worklists->edgesToCollapse;
+  rest.insert(rest.end(), edges.begin(), edges.end());
+  double t1 = PCU_Time();
+  print("coarsened %li edges in %f seconds",successCount,t1-t0);
+  return true;
+}
+
 bool coarsen(Adapt* a)
 {
   if (!a->input->shouldCoarsen)
     return false;
+  if (a->worklists)
+    return coarsenWorklist(a);
   double t0 = PCU_Time();
   --(a->coarsensLeft);
   long count = markEdgesToCollapse(a);
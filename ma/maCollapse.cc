@@ -342,7 +342,7 @@ void Collapse::rebuildElements()
   APF_ITERATE(EntitySet,elementsToKeep,it)
     newElements[ni++]=
         rebuildElement(adapt->mesh, *it, vertToCollapse, vertToKeep,
-            adapt->buildCallback, rebuildCallback);
+            getBuildCallback(adapt), rebuildCallback);
   cavity.afterBuilding();
 }
 
@@ -61,6 +61,8 @@ void setDefaultValues(Input* in)
   in->shouldRefineLayer = false;
   in->shouldCoarsenLayer = false;
   in->splitAllLayerEdges = false;
+  in->shouldUseWorklists = false;
+  in->shouldPullIndependentSets = false;
   in->userDefinedLayerTagName = "";
   in->shapeHandler = 0;
 }
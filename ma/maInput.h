@@ -125,6 +125,18 @@ class Input
     bool shouldCoarsenLayer;
 /** \brief set to true during UR to get splits in the normal direction */
     bool splitAllLayerEdges;
+/** \brief whether iterations after the first revisit only the entities
+    that earlier ones created or left marked, instead of sweeping the
+    whole mesh (default false)
+    \details this takes effect on serial MDS meshes without boundary
+    layers or matching; other meshes are always swept */
+    bool shouldUseWorklists;
+/** \brief whether cavities that span parts are only migrated when no
+    other part wants their elements in the same round (default false)
+    \details see apf::CavityOp::setIndependentPulls. This moves fewer
+    elements per round of coarsening and other cavity operations, at
+    the cost of more rounds */
+    bool shouldPullIndependentSets;
 /** \brief the name of the (user defined) INT tag specifying the boundary
     layer elements. Use the value of 0 for non-layer elements and a non-zero value
     for layer elements. (default "") */
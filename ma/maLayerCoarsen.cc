@@ -207,6 +207,7 @@ void localizeLayerStacks(Mesh* m) {
     migrateForLayerCollapse(a,d,round);
   delete a;
   // cleanup input object and associated sizefield and solutiontransfer objects
+  in->sizeField->dropCache();
   if (in->ownsSizeField)
     delete in->sizeField;
   if (in->ownsSolutionTransfer)
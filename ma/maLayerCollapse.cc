@@ -148,7 +148,7 @@ void LayerCollapse::rebuildElements()
           a, *it, curves[0].back(), curves[1].back());
     else
       newLayer.push_back(rebuildLayerElement(
-          m, *it, curves[0], curves[1], a->buildCallback));
+          m, *it, curves[0], curves[1], getBuildCallback(a)));
   }
   newSimplices.setSize(nsi);
 }
@@ -9,6 +9,7 @@
 *******************************************************************************/
 #include "maOperator.h"
 #include "maAdapt.h"
+#include <apfMDS.h>
 
 namespace ma {
 
@@ -20,9 +21,13 @@ class CollectiveOperation : public apf::CavityOp, public DeleteCallback
       DeleteCallback(a)
     {
       op = o;
+      checkLive = false;
+      setIndependentPulls(a->input->shouldPullIndependentSets);
     }
     Outcome setEntity(Entity* e)
     {
+      if (checkLive && ( ! apf::isMdsEntityLive(adapt->mesh, e)))
+        return SKIP;
       if ( ! op->shouldApply(e))
         return SKIP;
       if ( ! op->requestLocality(this))
@@ -37,6 +42,7 @@ class CollectiveOperation : public apf::CavityOp, public DeleteCallback
     {
       this->preDeletion(e);
     }
+    bool checkLive;
   private:
     Operator* op;
 };
@@ -49,4 +55,11 @@ void applyOperator(Adapt* a, Operator* o)
   op.applyToDimension(o->getTargetDimension());
 }
 
+void applyOperator(Adapt* a, Operator* o, std::vector<Entity*> const& entities)
+{
+  CollectiveOperation op(a,o);
+  op.checkLive = true;
+  op.applyToEntities(entities);
+}
+
 }
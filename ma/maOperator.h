@@ -26,6 +26,9 @@ class Operator
 };
 
 void applyOperator(Adapt* a, Operator* o);
+/* serial version over a pruned worklist, see ma::Worklists.
+   entries destroyed by earlier applications are skipped */
+void applyOperator(Adapt* a, Operator* o, std::vector<Entity*> const& entities);
 
 }
 
@@ -35,28 +35,23 @@ bool areTetsValid(Mesh* m, EntityArray& tets)
 class FixedMetricIntegrator : public apf::Integrator
 {
   public:
-    FixedMetricIntegrator(Mesh* inMesh, const Matrix& inQ):
+    FixedMetricIntegrator(const Matrix& inQ):
       Integrator(1),
       measurement(0),
-      mesh(inMesh),
       Q(inQ)
     {
       dimension = 0;
-      elem = 0;
+      meshElement = 0;
     }
     virtual void inElement(apf::MeshElement* me)
     {
       dimension = apf::getDimension(me);
-      elem = apf::createElement(mesh->getCoordinateField(), me);
-    }
-    virtual void outElement()
-    {
-      apf::destroyElement(elem);
+      meshElement = me;
     }
     virtual void atPoint(Vector const& p, double w, double)
     {
       Matrix J;
-      apf::getJacobian(apf::getMeshElement(elem),p,J);
+      apf::getJacobian(meshElement,p,J);
 /* transforms the rows of J, the differential tangent vectors,
    into the metric space, then uses the generalized determinant */
       double dV2 = apf::getJacobianDeterminant(J*Q,dimension);
@@ -64,24 +59,22 @@ class FixedMetricIntegrator : public apf::Integrator
     }
     double measurement;
   private:
-    Mesh* mesh;
     Matrix Q;
     int dimension;
-    apf::Element* elem;
+    apf::MeshElement* meshElement;
 };
 
 
-static double qMeasure(Mesh* mesh, Entity* e, const Matrix& Q)
+static double qMeasure(Mesh* mesh, MeshElementCache& elements,
+    Entity* e, const Matrix& Q)
 {
-  FixedMetricIntegrator integrator(mesh, Q);
-  apf::MeshElement* me = apf::createMeshElement(mesh, e);
-  integrator.process(me);
-  apf::destroyMeshElement(me);
+  FixedMetricIntegrator integrator(Q);
+  integrator.process(elements.get(mesh, e));
   return integrator.measurement;
 }
 
 static Matrix getMetricWithMaxJacobean(Mesh* m, SizeField* sf,
-    Entity* e)
+    MeshElementCache& elements, Entity* e)
 {
   int dim = m->getDimension();
   int type = m->getType(e);
@@ -94,15 +87,14 @@ static Matrix getMetricWithMaxJacobean(Mesh* m, SizeField* sf,
   double maxJ = -1.0;
 
   for (int i = 0; i < nd; i++) {
-    apf::MeshElement* me = createMeshElement(m, dv[i]);
     Matrix currentQ;
-    sf->getTransform(me, Vector(0.0, 0.0, 0.0), currentQ);
+    sf->getTransform(elements.get(m, dv[i]), Vector(0.0, 0.0, 0.0),
+        currentQ);
     double currentJ = apf::getJacobianDeterminant(currentQ, dim);
     if (currentJ > maxJ) {
       maxJ = currentJ;
       Q = currentQ;
     }
-    apf::destroyMeshElement(me);
   }
   return Q;
 }
@@ -113,22 +105,21 @@ double measureTriQuality(Mesh* m, SizeField* f, Entity* tri, bool useMax)
    * If useMax is true metric at a (downward) vertex with the
    * largest determinant is used.
    * Note: In the future we may want to used average of Q over the tri */
+  MeshElementCache elements;
   Matrix Q;
   if (useMax)
-    Q = getMetricWithMaxJacobean(m, f, tri);
+    Q = getMetricWithMaxJacobean(m, f, elements, tri);
   else {
-    apf::MeshElement* me = createMeshElement(m, tri);
     Vector xi(1./3., 1./3., 1./3.);
-    f->getTransform(me, xi, Q);
-    apf::destroyMeshElement(me);
+    f->getTransform(elements.get(m, tri), xi, Q);
   }
 
   Entity* e[3];
   m->getDownward(tri,1,e);
   double l[3];
   for (int i=0; i < 3; ++i)
-    l[i] = qMeasure(m, e[i], Q);
-  double A = qMeasure(m, tri, Q);
+    l[i] = qMeasure(m, elements, e[i], Q);
+  double A = qMeasure(m, elements, tri, Q);
   double s = 0;
   for (int i=0; i < 3; ++i)
     s += l[i]*l[i];
@@ -142,22 +133,21 @@ double measureTetQuality(Mesh* m, SizeField* f, Entity* tet, bool useMax)
    * If useMax is true metric at a (downward) vertex with the
    * largest determinant is used.
    * Note: In the future we may want to used average of Q over the tet */
+  MeshElementCache elements;
   Matrix Q;
   if (useMax)
-    Q = getMetricWithMaxJacobean(m, f, tet);
+    Q = getMetricWithMaxJacobean(m, f, elements, tet);
   else {
-    apf::MeshElement* me = createMeshElement(m, tet);
     Vector xi(0.25, 0.25, 0.25);
-    f->getTransform(me, xi, Q);
-    apf::destroyMeshElement(me);
+    f->getTransform(elements.get(m, tet), xi, Q);
   }
 
   Entity* e[6];
   m->getDownward(tet,1,e);
   double l[6];
   for (int i=0; i < 6; ++i)
-    l[i] = qMeasure(m, e[i], Q);
-  double V = qMeasure(m, tet, Q);
+    l[i] = qMeasure(m, elements, e[i], Q);
+  double V = qMeasure(m, elements, tet, Q);
   double s=0;
   for (int i=0; i < 6; ++i)
     s += l[i]*l[i];
@@ -184,10 +174,9 @@ double measureElementQuality(Mesh* m, SizeField* f, Entity* e, bool useMax)
 double getWorstQuality(Adapt* a, Entity** e, size_t n)
 {
   PCU_ALWAYS_ASSERT(n);
-  Mesh* m = a->mesh;
   ShapeHandler* sh = a->shape;
   double worst;
-  if (m->hasTag(e[0], a->qualityCache))
+  if (hasCachedQuality(a, e[0]))
     worst = getCachedQuality(a, e[0]);
   else {
     worst = sh->getQuality(e[0]);
@@ -195,7 +184,7 @@ double getWorstQuality(Adapt* a, Entity** e, size_t n)
   }
   for (size_t i = 1; i < n; ++i) {
     double quality;
-    if (m->hasTag(e[i], a->qualityCache)) {
+    if (hasCachedQuality(a, e[i])) {
       quality = getCachedQuality(a, e[i]);
     }
     else {
@@ -114,6 +114,17 @@ void addAllMarkedEdges(Refine* r)
   m->end(it);
 }
 
+void addAllMarkedEdges(Refine* r, std::vector<Entity*> const& edges)
+{
+  int n[4] = {0,0,0,0};
+  for (size_t i=0; i < edges.size(); ++i)
+    addEdgePreAllocation(r,edges[i],n);
+  allocateRefine(r,n);
+  n[1]=n[2]=n[3]=0;
+  for (size_t i=0; i < edges.size(); ++i)
+    addEdgePostAllocation(r,edges[i],n);
+}
+
 Refine::Refine(Adapt* a)
 {
   adapt = a;
@@ -136,7 +147,7 @@ Entity* makeSplitVert(Refine* r, Entity* edge)
   SolutionTransfer* st = a->solutionTransfer;
 /* midpoint of [-1,1] */
   Vector xi(0,0,0);
-  apf::MeshElement* me = apf::createMeshElement(m,edge);
+  apf::MeshElement* me = r->splitElements.get(m,edge);
   Vector point;
   apf::mapLocalToGlobal(me,xi,point);
   Vector param(0,0,0); //prevents uninitialized values
@@ -147,7 +158,6 @@ Entity* makeSplitVert(Refine* r, Entity* edge)
   Entity* vert = buildVertex(a,c,point,param);
   st->onVertex(me,xi,vert);
   sf->interpolate(me,xi,vert);
-  apf::destroyMeshElement(me);
   return vert;
 }
 
@@ -400,6 +410,13 @@ long markEdgesToSplit(Adapt* a)
                       DONT_SPLIT | NEED_NOT_SPLIT);
 }
 
+long markEdgesToSplit(Adapt* a, std::vector<Entity*>& edges)
+{
+  ShouldSplit p(a);
+  return markEntities(a, edges, p, SPLIT, NEED_NOT_SPLIT,
+                      DONT_SPLIT | NEED_NOT_SPLIT);
+}
+
 void processNewElements(Refine* r)
 {
   linkNewVerts(r);
@@ -422,7 +439,15 @@ bool refine(Adapt* a)
   double t0 = PCU_Time();
   --(a->refinesLeft);
   setupLayerForSplit(a);
-  long count = markEdgesToSplit(a);
+  /* with worklists, new edges go to a fresh list while
+     the marked ones are being split */
+  std::vector<Entity*> edges;
+  long count;
+  if (a->worklists) {
+    edges.swap(a->worklists->edgesToSplit);
+    count = markEdgesToSplit(a, edges);
+  } else
+    count = markEdgesToSplit(a);
   if ( ! count) {
     freezeLayer(a);
     return false;
@@ -433,7 +458,10 @@ bool refine(Adapt* a)
   collectForTransfer(r);
   collectForMatching(r);
   setupRefineForLayer(r);
-  addAllMarkedEdges(r);
+  if (a->worklists)
+    addAllMarkedEdges(r, edges);
+  else
+    addAllMarkedEdges(r);
   splitElements(r);
   processNewElements(r);
   destroySplitElements(r);
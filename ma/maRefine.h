@@ -12,6 +12,7 @@
 
 #include "maMesh.h"
 #include "maTables.h"
+#include "maSize.h"
 
 namespace ma {
 
@@ -27,6 +28,7 @@ class Refine
     EntityArray toSplit[4];
     apf::DynamicArray<EntityArray> newEntities[4];
     bool shouldCollect[4];
+    MeshElementCache splitElements;
 };
 
 /** \name Methods for adding edges
@@ -50,6 +52,9 @@ void addEdgePostAllocation(Refine* r, Entity* edge, int counts[4]);
 
 void addAllMarkedEdges(Refine* r);
 long markEdgesToSplit(Adapt* a);
+/* the same for just the edges of a worklist, see ma::Worklists */
+void addAllMarkedEdges(Refine* r, std::vector<Entity*> const& edges);
+long markEdgesToSplit(Adapt* a, std::vector<Entity*>& edges);
 
 void resetCollection(Refine* r);
 void collectForTransfer(Refine* r);
@@ -13,10 +13,63 @@
 #include "apfMatrix.h"
 #include <apfShape.h>
 #include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <map>
 #include <pcu_util.h>
 
 namespace ma {
 
+MeshElementCache::MeshElementCache():
+  coordinates(0),
+  element(0)
+{
+}
+
+MeshElementCache::~MeshElementCache()
+{
+  if (element)
+    apf::destroyMeshElement(element);
+}
+
+apf::MeshElement* MeshElementCache::get(Mesh* m, Entity* e)
+{
+  if (element && coordinates == m->getCoordinateField()) {
+    apf::rebindMeshElement(element, e);
+    return element;
+  }
+  if (element)
+    apf::destroyMeshElement(element);
+  coordinates = m->getCoordinateField();
+  element = apf::createMeshElement(m, e);
+  return element;
+}
+
+FieldElementCache::FieldElementCache():
+  field(0),
+  element(0)
+{
+}
+
+FieldElementCache::~FieldElementCache()
+{
+  if (element)
+    apf::destroyElement(element);
+}
+
+apf::Element* FieldElementCache::get(apf::Field* f, apf::MeshElement* me)
+{
+  if (element && field == f) {
+    apf::rebindElement(element, me);
+    return element;
+  }
+  if (element)
+    apf::destroyElement(element);
+  field = f;
+  element = apf::createElement(f, me);
+  return element;
+}
+
 SizeField::~SizeField()
 {
 }
@@ -47,6 +100,10 @@ bool SizeField::hasNodesOn(int)
   return false;
 }
 
+void SizeField::dropCache()
+{
+}
+
 IdentitySizeField::IdentitySizeField(Mesh* m):
   mesh(m)
 {
@@ -54,10 +111,7 @@ IdentitySizeField::IdentitySizeField(Mesh* m):
 
 double IdentitySizeField::measure(Entity* e)
 {
-  apf::MeshElement* me = apf::createMeshElement(mesh,e);
-  double x = apf::measure(me);
-  apf::destroyMeshElement(me);
-  return x;
+  return apf::measure(elements.get(mesh, e));
 }
 
 bool IdentitySizeField::shouldSplit(Entity*)
@@ -204,17 +258,153 @@ class SizeFieldIntegrator : public apf::Integrator
     int dimension;
 };
 
+/* a cached edge length stays valid while the coordinates and
+   the metrics of the edge's vertices stay the same, so it is
+   stored with a key mixing their bits. a change to any one
+   of those values always changes the key. */
+static void mixKey(uint64_t& key, double const* values, int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    uint64_t bits;
+    memcpy(&bits, &values[i], sizeof(bits));
+    key = (key ^ bits) * 1099511628211ULL;
+  }
+}
+
+static void mixKey(uint64_t& key, Vector const& v)
+{
+  double values[3] = {v[0], v[1], v[2]};
+  mixKey(key, values, 3);
+}
+
+static void mixKey(uint64_t& key, Matrix const& m)
+{
+  for (int i = 0; i < 3; ++i)
+    mixKey(key, m[i]);
+}
+
 struct MetricSizeField : public SizeField
 {
-  double measure(Entity* e)
+  MetricSizeField():
+    edgePoints(0)
+  {
+  }
+  void dropCache()
+  {
+    lengths.clear();
+  }
+  double integrate(Entity* e)
   {
     SizeFieldIntegrator sFI(this,
     	std::max(mesh->getShape()->getOrder(), order)+1);
-    apf::MeshElement* me = apf::createMeshElement(mesh, e);
-    sFI.process(me);
-    apf::destroyMeshElement(me);
+    sFI.process(elements.get(mesh, e));
     return sFI.measurement;
   }
+  /* interpolates the transform at points xi of the edge from
+     the vertex values of the size field, returning false if
+     the size field is not interpolated from the vertices */
+  virtual bool getEdgeTransforms(
+      Entity* const v[2],
+      int n,
+      double const* xi,
+      Matrix* Q)
+  {
+    (void)v;
+    (void)n;
+    (void)xi;
+    (void)Q;
+    return false;
+  }
+  /* mixes the metric values at vertex v into key, returning
+     false if the size field is not interpolated from the
+     vertices */
+  virtual bool mixVertexKey(Entity* v, uint64_t& key)
+  {
+    (void)v;
+    (void)key;
+    return false;
+  }
+  bool getEdgeKey(Entity* const v[2], Vector const x[2], long& key)
+  {
+    uint64_t bits = 14695981039346656037ULL;
+    for (int i = 0; i < 2; ++i)
+    {
+      mixKey(bits, x[i]);
+      if (!mixVertexKey(v[i], bits))
+        return false;
+    }
+    key = (long)bits;
+    return true;
+  }
+  /* the integration of measure on a linear edge, where the
+     tangent is constant and the transform can come straight
+     from the vertices without Mesh or Field Elements */
+  bool measureLinearEdge(Entity* const v[2], Vector const x[2],
+      double& length)
+  {
+    if (edgePoints > maxEdgePoints)
+      return false;
+    Matrix Q[maxEdgePoints];
+    if (!getEdgeTransforms(v, edgePoints, edgeXi, Q))
+      return false;
+    Vector t = x[0] * -0.5 + x[1] * 0.5;
+    length = 0;
+    for (int p = 0; p < edgePoints; ++p)
+      length += edgeWeights[p] * (transpose(Q[p]) * t).getLength();
+    return true;
+  }
+  /* the integration rule of integrate for edges, which
+     the fast path follows */
+  void getEdgeRule(Entity* e)
+  {
+    int o = std::max(mesh->getShape()->getOrder(), order) + 1;
+    apf::MeshElement* me = elements.get(mesh, e);
+    edgePoints = apf::countIntPoints(me, o);
+    for (int p = 0; p < edgePoints && p < maxEdgePoints; ++p)
+    {
+      Vector point;
+      apf::getIntPoint(me, o, p, point);
+      edgeXi[p] = point[0];
+      edgeWeights[p] = apf::getIntWeight(me, o, p);
+    }
+  }
+  /* edges of a linear mesh with vertex metrics take the
+     fast path and keep their lengths in the size field until
+     a vertex moves or its metric changes, see getEdgeKey.
+     an edge destroyed by adaptation may leave its entry behind,
+     and a new edge reusing its handle will not match the key
+     unless it has the same vertex coordinates and metrics,
+     and so the same length. */
+  double measureEdge(Entity* e)
+  {
+    Entity* v[2];
+    mesh->getDownward(e, 0, v);
+    Vector x[2];
+    mesh->getPoint(v[0], 0, x[0]);
+    mesh->getPoint(v[1], 0, x[1]);
+    long key;
+    if (!getEdgeKey(v, x, key))
+      return integrate(e);
+    if (!edgePoints)
+      getEdgeRule(e);
+    CachedLength& cached = lengths[e];
+    if (cached.key == key && cached.length >= 0)
+      return cached.length;
+    double length;
+    if (!measureLinearEdge(v, x, length))
+      length = integrate(e);
+    cached.key = key;
+    cached.length = length;
+    return length;
+  }
+  double measure(Entity* e)
+  {
+    if (mesh->getType(e) == apf::Mesh::EDGE &&
+        mesh->getShape() == apf::getLagrange(1))
+      return measureEdge(e);
+    return integrate(e);
+  }
   bool shouldSplit(Entity* edge)
   {
     return this->measure(edge) > 1.5;
@@ -230,6 +420,18 @@ struct MetricSizeField : public SizeField
   }
   Mesh* mesh;
   int order; // this is the underlying sizefield order (default 1)
+  MeshElementCache elements;
+  struct CachedLength
+  {
+    CachedLength():key(0),length(-1) {}
+    long key;
+    double length;
+  };
+  std::map<Entity*, CachedLength> lengths;
+  enum { maxEdgePoints = 4 };
+  int edgePoints;
+  double edgeXi[maxEdgePoints];
+  double edgeWeights[maxEdgePoints];
 };
 
 AnisotropicFunction::~AnisotropicFunction()
@@ -398,35 +600,70 @@ struct AnisoSizeField : public MetricSizeField
       Vector const& xi,
       Matrix& Q)
   {
-    apf::Element* hElement = apf::createElement(hField,me);
-    apf::Element* rElement = apf::createElement(rField,me);
     Vector h;
     Matrix R;
-    apf::getVector(hElement,xi,h);
-    apf::getMatrix(rElement,xi,R);
-    apf::destroyElement(hElement);
-    apf::destroyElement(rElement);
+    apf::getVector(hElements.get(hField,me),xi,h);
+    apf::getMatrix(rElements.get(rField,me),xi,R);
     orthogonalizeR(R);
     Matrix S(1/h[0],0,0,
              0,1/h[1],0,
              0,0,1/h[2]);
     Q = R*S;
   }
+  bool getEdgeTransforms(
+      Entity* const v[2],
+      int n,
+      double const* xi,
+      Matrix* Q)
+  {
+    if (apf::getShape(hField) != apf::getLagrange(1) ||
+        apf::getShape(rField) != apf::getLagrange(1))
+      return false;
+    Vector h[2];
+    Matrix R[2];
+    for (int i = 0; i < 2; ++i)
+    {
+      apf::getVector(hField, v[i], 0, h[i]);
+      apf::getMatrix(rField, v[i], 0, R[i]);
+    }
+    for (int p = 0; p < n; ++p)
+    {
+      double n0 = (1.0 - xi[p]) / 2.0;
+      double n1 = (1.0 + xi[p]) / 2.0;
+      Vector hp = h[0] * n0 + h[1] * n1;
+      Matrix Rp = R[0] * n0 + R[1] * n1;
+      orthogonalizeR(Rp);
+      Matrix S(1/hp[0],0,0,
+               0,1/hp[1],0,
+               0,0,1/hp[2]);
+      Q[p] = Rp*S;
+    }
+    return true;
+  }
+  bool mixVertexKey(Entity* v, uint64_t& key)
+  {
+    if (apf::getShape(hField) != apf::getLagrange(1) ||
+        apf::getShape(rField) != apf::getLagrange(1))
+      return false;
+    Vector h;
+    Matrix R;
+    apf::getVector(hField, v, 0, h);
+    apf::getMatrix(rField, v, 0, R);
+    mixKey(key, h);
+    mixKey(key, R);
+    return true;
+  }
   void interpolate(
       apf::MeshElement* parent,
       Vector const& xi,
       Entity* newVert)
   {
-    apf::Element* rElement = apf::createElement(rField,parent);
-    apf::Element* hElement = apf::createElement(hField,parent);
     Vector h;
-    apf::getVector(hElement,xi,h);
+    apf::getVector(hElements.get(hField,parent),xi,h);
     Matrix R;
-    apf::getMatrix(rElement,xi,R);
+    apf::getMatrix(rElements.get(rField,parent),xi,R);
     orthogonalizeR(R);
     this->setValue(newVert,R,h);
-    apf::destroyElement(hElement);
-    apf::destroyElement(rElement);
   }
   void setValue(
       Entity* vert,
@@ -448,6 +685,8 @@ struct AnisoSizeField : public MetricSizeField
   }
   apf::Field* hField;
   apf::Field* rField;
+  FieldElementCache hElements;
+  FieldElementCache rElements;
   BothEval bothEval;
   SizesEval sizesEval;
   FrameEval frameEval;
@@ -509,10 +748,8 @@ struct LogAnisoSizeField : public MetricSizeField
       Vector const& xi,
       Matrix& Q)
   {
-    apf::Element* logMElement = apf::createElement(logMField,me);
     Matrix logM;
-    apf::getMatrix(logMElement,xi,logM);
-    apf::destroyElement(logMElement);
+    apf::getMatrix(logMElements.get(logMField,me),xi,logM);
     Vector v;
     Matrix R;
     orthogonalEigenDecompForSymmetricMatrix(logM, v, R);
@@ -521,16 +758,48 @@ struct LogAnisoSizeField : public MetricSizeField
               0, 0, sqrt(exp(v[2])));
     Q = R*S;
   }
+  bool getEdgeTransforms(
+      Entity* const v[2],
+      int n,
+      double const* xi,
+      Matrix* Q)
+  {
+    if (apf::getShape(logMField) != apf::getLagrange(1))
+      return false;
+    Matrix logM[2];
+    for (int i = 0; i < 2; ++i)
+      apf::getMatrix(logMField, v[i], 0, logM[i]);
+    for (int p = 0; p < n; ++p)
+    {
+      Matrix logMp = logM[0] * ((1.0 - xi[p]) / 2.0) +
+                     logM[1] * ((1.0 + xi[p]) / 2.0);
+      Vector s;
+      Matrix R;
+      orthogonalEigenDecompForSymmetricMatrix(logMp, s, R);
+      Matrix S( sqrt(exp(s[0])), 0, 0,
+                0, sqrt(exp(s[1])), 0,
+                0, 0, sqrt(exp(s[2])));
+      Q[p] = R*S;
+    }
+    return true;
+  }
+  bool mixVertexKey(Entity* v, uint64_t& key)
+  {
+    if (apf::getShape(logMField) != apf::getLagrange(1))
+      return false;
+    Matrix logM;
+    apf::getMatrix(logMField, v, 0, logM);
+    mixKey(key, logM);
+    return true;
+  }
   void interpolate(
       apf::MeshElement* parent,
       Vector const& xi,
       Entity* newVert)
   {
-    apf::Element* logMElement = apf::createElement(logMField,parent);
     Matrix logM;
-    apf::getMatrix(logMElement,xi,logM);
+    apf::getMatrix(logMElements.get(logMField,parent),xi,logM);
     this->setValue(newVert,logM);
-    apf::destroyElement(logMElement);
   }
   void setValue(
       Entity* vert,
@@ -576,6 +845,7 @@ struct LogAnisoSizeField : public MetricSizeField
   }
   apf::NewArray<double> fieldVal;
   apf::Field* logMField;
+  FieldElementCache logMElements;
   LogMEval logMEval;
 };
 
@@ -20,6 +20,40 @@ namespace ma {
 
 typedef apf::Matrix3x3 Matrix;
 
+/** \brief A Mesh Element reused across entities
+  * \details size field and quality queries run once per edge or
+  * element, so rather than creating and destroying a Mesh Element
+  * per query this one is rebound to each new entity.
+  * It is recreated if the mesh coordinate field changes. */
+class MeshElementCache
+{
+  public:
+    MeshElementCache();
+    ~MeshElementCache();
+    apf::MeshElement* get(Mesh* m, Entity* e);
+  private:
+    MeshElementCache(MeshElementCache const&);
+    MeshElementCache& operator=(MeshElementCache const&);
+    apf::Field* coordinates;
+    apf::MeshElement* element;
+};
+
+/** \brief A Field Element reused across Mesh Elements
+  * \details the Field Element analogue of ma::MeshElementCache,
+  * get returns an element of field f over the entity of me. */
+class FieldElementCache
+{
+  public:
+    FieldElementCache();
+    ~FieldElementCache();
+    apf::Element* get(apf::Field* f, apf::MeshElement* me);
+  private:
+    FieldElementCache(FieldElementCache const&);
+    FieldElementCache& operator=(FieldElementCache const&);
+    apf::Field* field;
+    apf::Element* element;
+};
+
 class SizeField
 {
   public:
@@ -44,6 +78,10 @@ class SizeField
         EntityArray& newEntities);
     virtual int getTransferDimension();
     virtual bool hasNodesOn(int dimension);
+    /** \brief forget any cached measurements
+      \details ma::adapt calls this before it returns to free
+      the memory they use */
+    virtual void dropCache();
 };
 
 struct IdentitySizeField : public SizeField
@@ -62,7 +100,7 @@ struct IdentitySizeField : public SizeField
           Matrix& t);
   double getWeight(Entity*);
   Mesh* mesh;
-
+  MeshElementCache elements;
 };
 
 struct UniformRefiner : public IdentitySizeField
@@ -98,6 +136,13 @@ class IsotropicFunction
     virtual double getValue(Entity* vert) = 0;
 };
 
+/** \brief make a metric size field
+  * \details on linear meshes with vertex metrics the metric size fields
+  * keep edge lengths in a cache of their own, keyed by the coordinates
+  * and the metric values of the edge's vertices, so moving a vertex or
+  * setting its metric by any means measures its edges again. nothing is
+  * stored on the mesh, and the cache is freed with the size field or
+  * by SizeField::dropCache, which ma::adapt calls before it returns. */
 SizeField* makeSizeField(Mesh* m, apf::Field* sizes, apf::Field* frames,
     bool logInterpolation = false);
 SizeField* makeSizeField(Mesh* m, AnisotropicFunction* f,
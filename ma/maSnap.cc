@@ -776,10 +776,14 @@ class SnapAll : public Operator
     Snapper snapper;
 };
 
-bool snapAllVerts(Adapt* a, Tag* t, bool isSimple, long& successCount)
+bool snapAllVerts(Adapt* a, Tag* t, bool isSimple, long& successCount,
+    std::vector<Entity*>* verts)
 {
   SnapAll op(a, t, isSimple);
-  applyOperator(a, &op);
+  if (verts)
+    applyOperator(a, &op, *verts);
+  else
+    applyOperator(a, &op);
   successCount += PCU_Add_Long(op.successCount);
   return PCU_Or(op.didAnything);
 }
@@ -835,47 +839,68 @@ bool snapMatchedVerts(Adapt* a, Tag* t, bool isSimple, long& successCount)
   return PCU_Or(op.didAnything);
 }
 
+static bool tagVertToSnap(Mesh* m, Entity* v, Tag* t)
+{
+  int md = m->getModelType(m->toModel(v));
+  if (m->getDimension() == 3 && md == 3)
+    return false;
+  Vector s;
+  getSnapPoint(m, v, s);
+  Vector x = getPosition(m, v);
+  if (apf::areClose(s, x, 1e-12))
+    return false;
+  m->setDoubleTag(v, t, &s[0]);
+  return m->isOwned(v);
+}
+
 long tagVertsToSnap(Adapt* a, Tag*& t)
 {
   Mesh* m = a->mesh;
-  int dim = m->getDimension();
   t = m->createDoubleTag("ma_snap", 3);
   Entity* v;
   long n = 0;
   Iterator* it = m->begin(0);
-  while ((v = m->iterate(it))) {
-    int md = m->getModelType(m->toModel(v));
-    if (dim == 3 && md == 3)
-      continue;
-    Vector s;
-    getSnapPoint(m, v, s);
-    Vector x = getPosition(m, v);
-    if (apf::areClose(s, x, 1e-12))
-      continue;
-    m->setDoubleTag(v, t, &s[0]);
-    if (m->isOwned(v))
+  while ((v = m->iterate(it)))
+    if (tagVertToSnap(m, v, t))
       ++n;
-  }
   m->end(it);
   return PCU_Add_Long(n);
 }
 
-static void markVertsToSnap(Adapt* a, Tag* t)
+/* vertices marked DONT_SNAP are never looked at again,
+   so the worklist version leaves them untagged */
+static long tagVertsToSnap(Adapt* a, Tag*& t, std::vector<Entity*>& verts)
+{
+  Mesh* m = a->mesh;
+  t = m->createDoubleTag("ma_snap", 3);
+  long n = 0;
+  for (size_t i = 0; i < verts.size(); ++i)
+    if (( ! getFlag(a, verts[i], DONT_SNAP)) &&
+        tagVertToSnap(m, verts[i], t))
+      ++n;
+  return n;
+}
+
+static void markVertsToSnap(Adapt* a, Tag* t, std::vector<Entity*>* verts)
 {
   HasTag p(a->mesh, t);
-  markEntities(a, 0, p, SNAP, DONT_SNAP);
+  if (verts)
+    markEntities(a, *verts, p, SNAP, DONT_SNAP);
+  else
+    markEntities(a, 0, p, SNAP, DONT_SNAP);
 }
 
-bool snapOneRound(Adapt* a, Tag* t, bool isSimple, long& successCount)
+bool snapOneRound(Adapt* a, Tag* t, bool isSimple, long& successCount,
+    std::vector<Entity*>* verts)
 {
-  markVertsToSnap(a, t);
+  markVertsToSnap(a, t, verts);
   if (a->mesh->hasMatching())
     return snapMatchedVerts(a, t, isSimple, successCount);
   else
-    return snapAllVerts(a, t, isSimple, successCount);
+    return snapAllVerts(a, t, isSimple, successCount, verts);
 }
 
-long snapTaggedVerts(Adapt* a, Tag* tag)
+long snapTaggedVerts(Adapt* a, Tag* tag, std::vector<Entity*>* verts)
 {
   long successCount = 0;
   /* there are two approaches possible here:
@@ -893,8 +918,8 @@ long snapTaggedVerts(Adapt* a, Tag* tag)
    * difficult due to the change in location of neighboring verticies
    * that will be snapped before the problematic vert to-be-snapped.
    */
-  while (snapOneRound(a, tag, false, successCount));
-  while (snapOneRound(a, tag, true, successCount));
+  while (snapOneRound(a, tag, false, successCount, verts));
+  while (snapOneRound(a, tag, true, successCount, verts));
   return successCount;
 }
 
@@ -908,10 +933,27 @@ void snap(Adapt* a)
      meshes, including snapping+UR. this should prevent snapping
      from modifying any matched entities */
   preventMatchedCavityMods(a);
-  long targets = tagVertsToSnap(a, tag);
-  long success = snapTaggedVerts(a, tag);
-  snapLayer(a, tag);
-  apf::removeTagFromDimension(a->mesh, tag, 0);
+  long targets, success;
+  if (a->worklists) {
+    /* each round narrows the list down to the vertices it
+       marked, which are the only ones that can still be
+       tagged. they are put back for the next call */
+    std::vector<Entity*> verts;
+    verts.swap(a->worklists->vertsToSnap);
+    pruneWorklist(a, verts);
+    targets = tagVertsToSnap(a, tag, verts);
+    success = snapTaggedVerts(a, tag, &verts);
+    pruneWorklist(a, verts);
+    for (size_t i = 0; i < verts.size(); ++i)
+      a->mesh->removeTag(verts[i], tag);
+    std::vector<Entity*>& rest = a->worklists->vertsToSnap;
+    rest.insert(rest.end(), verts.begin(), verts.end());
+  } else {
+    targets = tagVertsToSnap(a, tag);
+    success = snapTaggedVerts(a, tag);
+    snapLayer(a, tag);
+    apf::removeTagFromDimension(a->mesh, tag, 0);
+  }
   a->mesh->destroyTag(tag);
   double t1 = PCU_Time();
   print("snapped in %f seconds: %ld targets, %ld non-layer snaps",
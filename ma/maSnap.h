@@ -11,6 +11,7 @@
 #define MA_SNAP_H
 
 #include "maMesh.h"
+#include <vector>
 
 namespace ma {
 
@@ -19,7 +20,10 @@ class Adapt;
 void snap(Adapt* a);
 void visualizeGeometricInfo(Mesh* m, const char* name);
 
-long snapTaggedVerts(Adapt* a, Tag* snapTag);
+/* with \a verts, only those vertices are marked and snapped,
+   and the list is narrowed down to the marked ones */
+long snapTaggedVerts(Adapt* a, Tag* snapTag,
+    std::vector<Entity*>* verts = 0);
 
 void interpolateParametricCoordinates(
     apf::Mesh* m,
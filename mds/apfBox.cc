@@ -2,6 +2,7 @@
 
 #include "apfMDS.h"
 #include <gmi_lookup.h>
+#include <PCU.h>
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <cstdlib>
@@ -343,5 +344,30 @@ gmi_model* makeMdsBoxModel(
   return bb.buildModel();
 }
 
+Mesh2* makeMdsBoxOnPartZero(
+    int nex, int ney, int nez,
+    double wx, double wy, double wz, bool is)
+{
+  /* building a box or its model accepts changes, which talks to
+     the other parts, so part zero builds the box on its own
+     communicator and the others only build the model */
+  MPI_Comm all = PCU_Get_Comm();
+  MPI_Comm one;
+  int self = PCU_Comm_Self();
+  MPI_Comm_split(all, self != 0, 0, &one);
+  PCU_Switch_Comm(one);
+  Mesh2* m = 0;
+  gmi_model* g;
+  if (!self) {
+    m = makeMdsBox(nex, ney, nez, wx, wy, wz, is);
+    g = m->getModel();
+  } else {
+    g = makeMdsBoxModel(nex, ney, nez, wx, wy, wz, is);
+  }
+  PCU_Switch_Comm(all);
+  MPI_Comm_free(&one);
+  return expandMdsMesh(m, g, 1);
+}
+
 
 }
@@ -77,6 +77,14 @@ Mesh2* makeMdsBox(
 gmi_model* makeMdsBoxModel(
     int nx, int ny, int nz, double wx, double wy, double wz, bool is);
 
+/** \brief create a box on part zero of a parallel mesh
+  \details see makeMdsBox. Part zero holds the whole box and the
+  other parts are empty, as after apf::expandMdsMesh, ready to be
+  partitioned by a splitter or balancer.
+  This is a collective call. */
+Mesh2* makeMdsBoxOnPartZero(
+    int nx, int ny, int nz, double wx, double wy, double wz, bool is);
+
 
 }
 
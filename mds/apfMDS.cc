@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <limits>
 #include <deque>
+#include <algorithm>
 
 extern "C" {
 
@@ -158,6 +159,28 @@ static int apf2mds(int t_apf)
   return table[t_apf];
 }
 
+/* a tag looked up by name once and then reused until tags
+   are created, destroyed or renamed on any mesh */
+class TagHandle
+{
+  public:
+    TagHandle():tag(0),changes(0),found(false) {}
+    MeshTag* find(Mesh* m, const char* name)
+    {
+      unsigned long now = mds_tag_changes();
+      if (!found || now != changes) {
+        tag = m->findTag(name);
+        changes = now;
+        found = true;
+      }
+      return tag;
+    }
+  private:
+    MeshTag* tag;
+    unsigned long changes;
+    bool found;
+};
+
 class MeshMDS : public Mesh2
 {
   public:
@@ -266,7 +289,7 @@ class MeshMDS : public Mesh2
     }
     bool isGhost(MeshEntity* e)
     {
-      MeshTag* t = findTag("ghost_tag");
+      MeshTag* t = ghostTag.find(this, "ghost_tag");
       if (t && hasTag(e, t))
         return true;
       return false;
@@ -279,7 +302,7 @@ class MeshMDS : public Mesh2
 
     bool isGhosted(MeshEntity* e)
     {
-      MeshTag* t = findTag("ghosted_tag");
+      MeshTag* t = ghostedTag.find(this, "ghosted_tag");
       if (t && hasTag(e, t))
         return true;
       return false;
@@ -354,6 +377,35 @@ class MeshMDS : public Mesh2
       mds_id id = fromEnt(e);
       p.toArray(mds_apf_point(mesh,id));
     }
+    /* without holes the vertex index is the iteration
+       order, so the point array can be handed out as is */
+    bool hasDenseVertices()
+    {
+      return mesh->mds.n[MDS_VERTEX] &&
+        mesh->mds.n[MDS_VERTEX] == mesh->mds.end[MDS_VERTEX];
+    }
+    void getPoints(MeshSpan<double>& points)
+    {
+      if (!hasDenseVertices() || !hasNativePoints())
+        return Mesh::getPoints(points);
+      points.view(&(mesh->point[0][0]), mesh->mds.n[MDS_VERTEX] * 3);
+    }
+    void getElementVertices(int type, MeshSpan<int>& vertices)
+    {
+      if (!hasDenseVertices())
+        return Mesh::getElementVertices(type, vertices);
+      int t = apf2mds(type);
+      int nv = mds_degree[t][0];
+      int* out = vertices.allocate(mesh->mds.n[t] * nv);
+      mds_set s;
+      for (mds_id i = 0; i < mesh->mds.end[t]; ++i) {
+        if (mesh->mds.free[t][i] != MDS_LIVE)
+          continue;
+        mds_get_adjacent(&(mesh->mds), mds_identify(t, i), 0, &s);
+        for (int j = 0; j < nv; ++j)
+          *out++ = mds_index(s.e[j]);
+      }
+    }
     void getParam(MeshEntity* e, Vector3& p)
     {
       mds_id id = fromEnt(e);
@@ -528,7 +580,7 @@ class MeshMDS : public Mesh2
     {
       mds_tag* tag;
       tag = reinterpret_cast<mds_tag*>(t);
-      mds_rename_tag(tag,newName);
+      mds_rename_tag(&(mesh->tags),tag,newName);
     }
     /* \brief 16 bit additive checksum of a tag
      * \remark the code is from
@@ -772,6 +824,8 @@ class MeshMDS : public Mesh2
       return table[type];
     }
     mds_apf* mesh;
+    TagHandle ghostTag;
+    TagHandle ghostedTag;
     PM pmodel;
     bool isMatched;
     bool ownsModel;
@@ -927,8 +981,33 @@ Mesh2* loadSerialMdsMesh(gmi_model* model, const char* meshfile)
   return m;
 }
 
+/* a shared file with fewer parts than ranks is read by the
+   ranks that apf::expandMdsMesh keeps the original parts on */
+static Mesh2* loadExpandedMdsMesh(gmi_model* model, const char* meshfile,
+    int parts)
+{
+  PCU_ALWAYS_ASSERT_VERBOSE(parts <= PCU_Comm_Peers(),
+      "can't read more mesh parts than there are ranks");
+  apf::Contract contract(parts, PCU_Comm_Peers());
+  int self = PCU_Comm_Self();
+  bool isOriginal = contract.isValid(self);
+  MPI_Comm all = PCU_Get_Comm();
+  MPI_Comm group;
+  MPI_Comm_split(all, !isOriginal, isOriginal ? contract(self) : 0, &group);
+  PCU_Switch_Comm(group);
+  Mesh2* m = 0;
+  if (isOriginal)
+    m = loadMdsMesh(model, meshfile);
+  PCU_Switch_Comm(all);
+  MPI_Comm_free(&group);
+  return expandMdsMesh(m, model, parts);
+}
+
 Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile)
 {
+  int parts = mds_count_smb_parts(meshfile);
+  if (parts != PCU_Comm_Peers())
+    return loadExpandedMdsMesh(model, meshfile, parts);
   double t0 = PCU_Time();
   Mesh2* m = new MeshMDS(model, meshfile);
   initResidence(m, m->getDimension());
@@ -969,6 +1048,36 @@ void reorderMdsMesh(Mesh2* mesh, MeshTag* t)
     lion_oprint(1,"mesh reordered in %f seconds\n", PCU_Time()-t0);
 }
 
+void reorderMdsMeshByElements(Mesh2* mesh, MeshTag* t)
+{
+  double t0 = PCU_Time();
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  PCU_ALWAYS_ASSERT(mesh->getTagType(t) == Mesh::INT);
+  m->mesh = mds_reorder_by_elements(m->mesh, 0,
+      reinterpret_cast<mds_tag*>(t));
+  if (!PCU_Comm_Self())
+    lion_oprint(1,"mesh reordered in %f seconds\n", PCU_Time()-t0);
+}
+
+void compactMdsMesh(Mesh2* mesh)
+{
+  double t0 = PCU_Time();
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  mds_apf_compact(m->mesh, 0);
+  if (!PCU_Comm_Self())
+    lion_oprint(1,"mesh compacted in %f seconds\n", PCU_Time()-t0);
+}
+
+void reorderMdsMesh(Mesh2* mesh, Ordering o, bool elementsFirst)
+{
+  if (elementsFirst)
+    reorderMdsMeshByElements(mesh, orderElements(mesh, o, "mds_order"));
+  else if (o == BREADTH_FIRST)
+    reorderMdsMesh(mesh);
+  else
+    reorderMdsMesh(mesh, orderVertices(mesh, o, "mds_order"));
+}
+
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount)
 {
   double t0 = PCU_Time();
@@ -1282,6 +1391,136 @@ MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index)
   return 0;
 }
 
+bool isMdsMesh(Mesh* m)
+{
+  return dynamic_cast<MeshMDS*>(m) != 0;
+}
+
+void* getMdsTagData(Mesh2*, MeshTag* t, MeshEntity* e)
+{
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  if (!mds_has_tag(tag, id))
+    return 0;
+  return mds_get_tag(tag, id);
+}
+
+void* giveMdsTagData(Mesh2* in, MeshTag* t, MeshEntity* e)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  mds_id id = fromEnt(e);
+  if (!mds_has_tag(tag, id))
+    mds_give_tag(tag, &(m->mesh->mds), id);
+  return mds_get_tag(tag, id);
+}
+
+bool isMdsEntityLive(Mesh2* in, MeshEntity* e)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds* mds = &(m->mesh->mds);
+  mds_id id = fromEnt(e);
+  int t = mds_type(id);
+  mds_id i = mds_index(id);
+  return i < mds->end[t] && mds->free[t][i] == MDS_LIVE;
+}
+
+/* splits a range of dimension-unique indices into
+   ranges of each entity type of that dimension */
+template <class F>
+static void forTypeRanges(mds* mds, int dim, int first, int count, F f)
+{
+  int offset = 0;
+  for (int t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] != dim)
+      continue;
+    int lo = std::max(first, offset);
+    int hi = std::min(first + count, offset + int(mds->n[t]));
+    if (lo < hi)
+      f(t, lo - offset, hi - lo, lo - first);
+    offset += mds->n[t];
+  }
+  PCU_ALWAYS_ASSERT(first + count <= offset);
+}
+
+struct GetTagRange
+{
+  mds_tag* tag;
+  char* out;
+  void operator()(int t, int first, int count, int at)
+  {
+    for (int i = first; i < first + count; ++i)
+      PCU_DEBUG_ASSERT(mds_has_tag(tag, mds_identify(t, i)));
+    mds_get_tag_range(tag, t, first, count, out + at * tag->bytes);
+  }
+};
+
+void getMdsTagRange(Mesh2* in, MeshTag* t, int dim, int first, int count,
+    void* out)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  GetTagRange f;
+  f.tag = reinterpret_cast<mds_tag*>(t);
+  f.out = static_cast<char*>(out);
+  forTypeRanges(&(m->mesh->mds), dim, first, count, f);
+}
+
+struct SetTagRange
+{
+  mds_tag* tag;
+  mds* mesh;
+  char const* in;
+  void operator()(int t, int first, int count, int at)
+  {
+    mds_set_tag_range(tag, mesh, t, first, count, in + at * tag->bytes);
+  }
+};
+
+void setMdsTagRange(Mesh2* in, MeshTag* t, int dim, int first, int count,
+    void const* in_data)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  SetTagRange f;
+  f.tag = reinterpret_cast<mds_tag*>(t);
+  f.mesh = &(m->mesh->mds);
+  f.in = static_cast<char const*>(in_data);
+  forTypeRanges(f.mesh, dim, first, count, f);
+}
+
+void freezeMdsTopology(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_freeze(&(m->mesh->mds));
+}
+
+void thawMdsTopology(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_thaw(&(m->mesh->mds));
+}
+
+bool isMdsTopologyFrozen(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  return m->mesh->mds.frozen != 0;
+}
+
+MdsSpan getMdsElements(Mesh2* in, MeshEntity* e)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  int n;
+  mds_id const* ids = mds_frozen_up(&(m->mesh->mds), fromEnt(e), &n);
+  return MdsSpan(ids, n);
+}
+
+MdsSpan getMdsNeighbors(Mesh2* in, MeshEntity* e)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  int n;
+  mds_id const* ids = mds_frozen_bridge(&(m->mesh->mds), fromEnt(e), &n);
+  return MdsSpan(ids, n);
+}
+
 void disownMdsModel(Mesh2* in)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
@@ -36,7 +36,9 @@
 // AJP: alternative is to allow common cgns base header
 //      but trying to avoid that since it's not core functionality
 #include <apf.h> 
+#include <apfNumbering.h>
 //
+#include <mds_config.h>
 struct gmi_model;
 
 namespace apf {
@@ -76,8 +78,15 @@ Mesh2* loadMdsMesh(const char* modelfile, const char* meshfile);
                   If the path is "something/", then the
                   file "something/N.smb" will be loaded.
                   For both of these cases, if the path is
-                  prepended with "bz2:", then it will be uncompressed
+                  prepended with "bz2:" or "zst:", then it will be
+                  uncompressed with bzip2 or zstd
                   using PCU file IO functions.
+                  If the path is "something.smbs", then all
+                  parts are read from that one file with
+                  collective MPI-IO. Such a file with fewer
+                  parts than ranks is loaded as if by
+                  apf::expandMdsMesh, leaving empty parts
+                  to be filled by a partitioner.
                   Calling apf::Mesh::writeNative on the
                   resulting object will do the same in reverse. */
 Mesh2* loadMdsMesh(gmi_model* model, const char* meshfile);
@@ -108,6 +117,34 @@ Mesh2* createMdsMesh(gmi_model* model, Mesh* from, bool reorder=false, bool copy
            there are no gaps in the MDS arrays after this */
 void reorderMdsMesh(Mesh2* mesh, MeshTag* t = 0);
 
+/** \brief reorder the MDS arrays by one of the apf::Ordering schemes
+  \param elementsFirst if true the elements are ordered first
+           (see apf::orderElements) and every other entity follows
+           the first element that uses it, otherwise the vertices
+           are ordered first (see apf::orderVertices) and the
+           other entities follow them as in the function above.
+  \details BREADTH_FIRST with vertices first is the
+           same as calling reorderMdsMesh(mesh). */
+void reorderMdsMesh(Mesh2* mesh, Ordering o, bool elementsFirst = false);
+
+/** \brief reorder the MDS arrays starting from an element ordering
+  \param t a unique integer on each element in the range
+           [0, #elements), it is destroyed by this call.
+  \details the other entities are numbered in order of the
+           first element whose closure contains them */
+void reorderMdsMeshByElements(Mesh2* mesh, MeshTag* t);
+
+/** \brief remove the gaps left in the MDS arrays by destroyed entities
+  \details unlike apf::reorderMdsMesh this works in place:
+           live entities keep their iteration order and slide down
+           into the gaps, then the arrays shrink to fit, so no
+           second copy of the mesh is made.
+           This is collective, since the ids of remote,
+           matched and ghost copies change too.
+           Like reordering, it invalidates all MeshEntity pointers,
+           while tags, fields and numberings keep their values. */
+void compactMdsMesh(Mesh2* mesh);
+
 Mesh2* repeatMdsMesh(Mesh2* m, gmi_model* g, Migration* plan, int factor);
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount);
 
@@ -187,7 +224,7 @@ void changeMdsDimension(Mesh2* in, int d);
 
 /** \brief returns the dimension-unique index for this entity
  \details this function only works when the arrays have no gaps,
- so call apf::reorderMdsMesh after any mesh modification. */
+ so call apf::compactMdsMesh after any mesh modification. */
 int getMdsIndex(Mesh2* in, MeshEntity* e);
 
 /** \brief retrieve an entity by dimension and index
@@ -195,9 +232,97 @@ int getMdsIndex(Mesh2* in, MeshEntity* e);
   function is equivalent to iterating (index) times,
   but is actually much faster than that.
   this function only works when the arrays have no gaps,
-  so call apf::reorderMdsMesh after any mesh modification. */
+  so call apf::compactMdsMesh after any mesh modification. */
 MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index);
 
+/** \brief returns true if this mesh is an MDS mesh */
+bool isMdsMesh(Mesh* m);
+
+/** \brief direct access to the data of an MDS tag
+  \details MDS stores tag data in arrays indexed like its
+  entity arrays and grown along with them.
+  This returns the address of the data of tag \a t on
+  entity \a e, or zero if \a e does not have the tag,
+  without the virtual calls and copies of apf::Mesh::getTag.
+  The address is invalidated when entities are added. */
+void* getMdsTagData(Mesh2* in, MeshTag* t, MeshEntity* e);
+
+/** \brief attach an MDS tag and return its data address
+  \details like apf::getMdsTagData, but if \a e does not have
+  the tag, it is attached first. The data of a newly
+  attached tag is not initialized. */
+void* giveMdsTagData(Mesh2* in, MeshTag* t, MeshEntity* e);
+
+/** \brief whether \a e is an entity of the MDS mesh
+  \details the handle of a destroyed entity stays decodable,
+  so callers holding on to handles across mesh modification
+  can use this to skip the ones that were destroyed.
+  A later entity of the same type may reuse the handle. */
+bool isMdsEntityLive(Mesh2* in, MeshEntity* e);
+
+/** \brief copy the tag data of a range of entities into an array
+  \details the entities of dimension \a dim with apf::getMdsIndex
+  in [first, first + count) must all have tag \a t.
+  \a out receives count * apf::Mesh::getTagSize values of the
+  tag's type, in index order.
+  Like getMdsIndex, this only works when the arrays have no gaps. */
+void getMdsTagRange(Mesh2* in, MeshTag* t, int dim, int first, int count,
+    void* out);
+
+/** \brief set the tag data of a range of entities from an array
+  \details the counterpart of apf::getMdsTagRange,
+  which attaches the tag to entities that do not have it. */
+void setMdsTagRange(Mesh2* in, MeshTag* t, int dim, int first, int count,
+    void const* in_data);
+
+/** \brief a read-only list of entities stored in frozen MDS arrays
+  \details entries are decoded from the arrays when accessed,
+  nothing is copied. */
+class MdsSpan
+{
+  public:
+    MdsSpan():ids(0),n(0) {}
+    MdsSpan(MDS_ID_TYPE const* i, int s):ids(i),n(s) {}
+    int getSize() const {return n;}
+    MeshEntity* operator[](int i) const
+    {
+      return reinterpret_cast<MeshEntity*>(((char*)1) + ids[i]);
+    }
+  private:
+    MDS_ID_TYPE const* ids;
+    int n;
+};
+
+/** \brief build contiguous adjacency arrays for an unchanging mesh
+  \details for analysis phases that do not modify the mesh,
+  this builds compressed-row arrays of the elements adjacent
+  to every lower dimensional entity and of the elements
+  adjacent to every element across its sides.
+  These are read with apf::getMdsElements and
+  apf::getMdsNeighbors.
+  Creating or destroying any entity frees the arrays,
+  apf::thawMdsTopology frees them explicitly. */
+void freezeMdsTopology(Mesh2* in);
+
+/** \brief free the arrays built by apf::freezeMdsTopology */
+void thawMdsTopology(Mesh2* in);
+
+/** \brief returns true while the arrays of
+  apf::freezeMdsTopology are valid */
+bool isMdsTopologyFrozen(Mesh2* in);
+
+/** \brief get the elements adjacent to an entity of lower dimension
+  \details the topology must be frozen. Elements are listed
+  in iteration order, which may differ from the order of
+  apf::Mesh::getAdjacent. */
+MdsSpan getMdsElements(Mesh2* in, MeshEntity* e);
+
+/** \brief get the elements that share a side with an element
+  \details the topology must be frozen.
+  This is the frozen equivalent of apf::getBridgeAdjacent
+  from elements through their sides to elements. */
+MdsSpan getMdsNeighbors(Mesh2* in, MeshEntity* e);
+
 Mesh2* loadMdsFromCGNS(gmi_model* g, const char* filename, CGNSBCMap& cgnsBCMap);
 
 // names of mesh data to read from file: (VERTEX, VelocityX; CellCentre, Pressure)
@@ -283,6 +283,7 @@ void mds_destroy(struct mds* m)
 {
   int i;
   mds_id old_cap[MDS_TYPES];
+  mds_thaw(m);
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
   ZERO(m->cap);
@@ -606,6 +607,7 @@ static void unrelate_ent(struct mds* m, mds_id e)
 void mds_destroy_entity(struct mds* m, mds_id e)
 {
   check_ent(m,e);
+  mds_thaw(m);
   if (TYPE(e) != MDS_VERTEX)
     unrelate_ent(m,e);
   free_ent(m,e);
@@ -621,6 +623,7 @@ void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down)
   mds_id od;
   check_ent(m, up);
   check_ent(m, down);
+  mds_thaw(m);
   ut = TYPE(up);
   ui = INDEX(up);
   dd = mds_dim[ut] - 1;
@@ -674,6 +677,7 @@ mds_id mds_create_entity(struct mds* m, int t, mds_id* from)
 {
   PCU_ALWAYS_ASSERT(0 <= t);
   PCU_ALWAYS_ASSERT(t < MDS_TYPES);
+  mds_thaw(m);
   if (t == MDS_VERTEX)
     return alloc_ent(m, t);
   return add_ent(m, t, from);
@@ -833,8 +837,281 @@ static void decrease_dimension(struct mds* m)
 
 void mds_change_dimension(struct mds* m, int d)
 {
+  mds_thaw(m);
   while (m->d < d)
     increase_dimension(m);
   while (m->d > d)
     decrease_dimension(m);
 }
+
+/* compaction slides every live entity down to its rank among the
+   live entities of its type, which keeps the iteration order.
+   the rows of adjacency arrays only ever move to lower slots,
+   so one increasing pass reads every row before it is overwritten. */
+
+void mds_get_compact_map(struct mds* m, mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  mds_id j;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    new_of[t] = malloc(m->end[t] * sizeof(mds_id));
+    j = 0;
+    for (i = 0; i < m->end[t]; ++i)
+      new_of[t][i] = (m->free[t][i] == MDS_LIVE) ? j++ : MDS_NONE;
+    PCU_ALWAYS_ASSERT(j == m->n[t]);
+  }
+}
+
+void mds_free_compact_map(mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t)
+    free(new_of[t]);
+}
+
+static mds_id compact_id(mds_id* new_of[MDS_TYPES], mds_id e)
+{
+  return ID(TYPE(e), new_of[TYPE(e)][INDEX(e)]);
+}
+
+/* up lists link uses, which are ids of the form
+   ID(t, i * deg + j) for the j'th down entity of entity i */
+static mds_id compact_use(mds_id* new_of[MDS_TYPES], mds_id u, int down_dim)
+{
+  int t;
+  int deg;
+  mds_id i;
+  if (u == MDS_NONE)
+    return MDS_NONE;
+  t = TYPE(u);
+  deg = mds_degree[t][down_dim];
+  i = INDEX(u);
+  return ID(t, new_of[t][i / deg] * deg + i % deg);
+}
+
+static void compact_down(struct mds* m, int from, int to,
+    mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  int deg;
+  int k;
+  mds_id i;
+  mds_id j;
+  mds_id* a;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] != from)
+      continue;
+    deg = mds_degree[t][to];
+    a = m->down[to][t];
+    for (i = 0; i < m->end[t]; ++i) {
+      j = new_of[t][i];
+      if (j == MDS_NONE)
+        continue;
+      for (k = 0; k < deg; ++k)
+        a[j * deg + k] = compact_id(new_of, a[i * deg + k]);
+    }
+  }
+}
+
+static void compact_up(struct mds* m, int from, int to,
+    mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  int deg;
+  int k;
+  mds_id i;
+  mds_id j;
+  mds_id* a;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] == to) {
+      deg = mds_degree[t][from];
+      a = m->up[from][t];
+    } else if (mds_dim[t] == from) {
+      deg = 1;
+      a = m->first_up[to][t];
+    } else
+      continue;
+    for (i = 0; i < m->end[t]; ++i) {
+      j = new_of[t][i];
+      if (j == MDS_NONE)
+        continue;
+      for (k = 0; k < deg; ++k)
+        a[j * deg + k] = compact_use(new_of, a[i * deg + k], from);
+    }
+  }
+}
+
+void mds_compact(struct mds* m, mds_id* new_of[MDS_TYPES])
+{
+  int i,j;
+  int t;
+  mds_id k;
+  mds_id old_cap[MDS_TYPES];
+  mds_thaw(m);
+  for (i = 0; i <= 3; ++i)
+  for (j = 0; j <= 3; ++j) {
+    if (i == j || !m->mrm[i][j])
+      continue;
+    if (i < j)
+      compact_up(m, i, j, new_of);
+    else
+      compact_down(m, i, j, new_of);
+  }
+  for (t = 0; t < MDS_TYPES; ++t) {
+    old_cap[t] = m->cap[t];
+    m->cap[t] = m->end[t] = m->n[t];
+    m->first_free[t] = MDS_NONE;
+  }
+  resize(m, old_cap);
+  for (t = 0; t < MDS_TYPES; ++t)
+    for (k = 0; k < m->n[t]; ++k)
+      m->free[t][k] = MDS_LIVE;
+}
+
+/* the frozen arrays trade the linked lists of upward adjacency
+   for compressed rows, which are built with two passes over the
+   elements: one counting the row sizes, one filling the rows.
+   rows list elements in iteration order. */
+
+static void alloc_rows(struct mds* m, struct mds_csr* c, int dim)
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == dim)
+      c->offset[t] = calloc(m->end[t] + 1, sizeof(mds_id));
+}
+
+/* turns the row sizes stored at offset[t][i + 1] into offsets,
+   continuing across all types of the row dimension,
+   and makes a copy of the row starts to use as fill cursors */
+static void fill_offsets(struct mds* m, struct mds_csr* c,
+    mds_id* at[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  mds_id total = 0;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    at[t] = NULL;
+    if (!c->offset[t])
+      continue;
+    c->offset[t][0] = total;
+    for (i = 0; i < m->end[t]; ++i)
+      c->offset[t][i + 1] += c->offset[t][i];
+    total = c->offset[t][m->end[t]];
+    at[t] = malloc((m->end[t] + 1) * sizeof(mds_id));
+    memcpy(at[t], c->offset[t], (m->end[t] + 1) * sizeof(mds_id));
+  }
+  c->e = malloc((total + 1) * sizeof(mds_id));
+}
+
+static void free_cursors(mds_id* at[MDS_TYPES])
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t)
+    free(at[t]);
+}
+
+static void build_up(struct mds* m, int d, struct mds_csr* c)
+{
+  mds_id e;
+  mds_id* at[MDS_TYPES];
+  struct mds_set s;
+  int j;
+  alloc_rows(m, c, d);
+  for (e = mds_begin(m, m->d); e != MDS_NONE; e = mds_next(m, e)) {
+    mds_get_adjacent(m, e, d, &s);
+    for (j = 0; j < s.n; ++j)
+      ++(c->offset[TYPE(s.e[j])][INDEX(s.e[j]) + 1]);
+  }
+  fill_offsets(m, c, at);
+  for (e = mds_begin(m, m->d); e != MDS_NONE; e = mds_next(m, e)) {
+    mds_get_adjacent(m, e, d, &s);
+    for (j = 0; j < s.n; ++j)
+      c->e[at[TYPE(s.e[j])][INDEX(s.e[j])]++] = e;
+  }
+  free_cursors(at);
+}
+
+static void build_bridge(struct mds* m, struct mds_csr* c)
+{
+  int pass;
+  mds_id e;
+  mds_id* at[MDS_TYPES];
+  struct mds_set s;
+  mds_id const* up;
+  int n;
+  int i, j;
+  alloc_rows(m, c, m->d);
+  for (pass = 0; pass < 2; ++pass) {
+    if (pass)
+      fill_offsets(m, c, at);
+    for (e = mds_begin(m, m->d); e != MDS_NONE; e = mds_next(m, e)) {
+      mds_get_adjacent(m, e, m->d - 1, &s);
+      for (i = 0; i < s.n; ++i) {
+        up = mds_frozen_up(m, s.e[i], &n);
+        for (j = 0; j < n; ++j) {
+          if (up[j] == e)
+            continue;
+          if (pass)
+            c->e[at[TYPE(e)][INDEX(e)]++] = up[j];
+          else
+            ++(c->offset[TYPE(e)][INDEX(e) + 1]);
+        }
+      }
+    }
+  }
+  free_cursors(at);
+}
+
+static void free_rows(struct mds_csr* c)
+{
+  int t;
+  for (t = 0; t < MDS_TYPES; ++t)
+    free(c->offset[t]);
+  free(c->e);
+}
+
+void mds_freeze(struct mds* m)
+{
+  int d;
+  mds_thaw(m);
+  PCU_ALWAYS_ASSERT(m->d >= 1);
+  m->frozen = calloc(1, sizeof(struct mds_frozen));
+  for (d = 0; d < m->d; ++d)
+    build_up(m, d, &m->frozen->up[d]);
+  build_bridge(m, &m->frozen->bridge);
+}
+
+void mds_thaw(struct mds* m)
+{
+  int d;
+  if (!m->frozen)
+    return;
+  for (d = 0; d < 4; ++d)
+    free_rows(&m->frozen->up[d]);
+  free_rows(&m->frozen->bridge);
+  free(m->frozen);
+  m->frozen = NULL;
+}
+
+static mds_id const* get_row(struct mds_csr* c, mds_id e, int* n)
+{
+  mds_id* o = c->offset[TYPE(e)] + INDEX(e);
+  *n = o[1] - o[0];
+  return c->e + o[0];
+}
+
+mds_id const* mds_frozen_up(struct mds* m, mds_id e, int* n)
+{
+  PCU_DEBUG_ASSERT(m->frozen);
+  PCU_DEBUG_ASSERT(mds_dim[TYPE(e)] < m->d);
+  return get_row(&m->frozen->up[mds_dim[TYPE(e)]], e, n);
+}
+
+mds_id const* mds_frozen_bridge(struct mds* m, mds_id e, int* n)
+{
+  PCU_DEBUG_ASSERT(m->frozen);
+  PCU_DEBUG_ASSERT(mds_dim[TYPE(e)] == m->d);
+  return get_row(&m->frozen->bridge, e, n);
+}
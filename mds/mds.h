@@ -30,6 +30,20 @@ typedef MDS_ID_TYPE mds_id;
 #define MDS_NONE -1
 #define MDS_LIVE -2
 
+/* compressed rows of entities, one row per entity slot.
+   the row of entity (t,i) is e[offset[t][i]] to e[offset[t][i+1]] */
+struct mds_csr {
+  mds_id* offset[MDS_TYPES];
+  mds_id* e;
+};
+
+/* contiguous adjacency arrays for a mesh whose topology is not
+   changing, built by mds_freeze and freed by any topology change */
+struct mds_frozen {
+  struct mds_csr up[4]; /* from each lower dimension to elements */
+  struct mds_csr bridge; /* elements to elements across sides */
+};
+
 struct mds {
   int d;
   mds_id n[MDS_TYPES];
@@ -41,6 +55,7 @@ struct mds {
   mds_id* first_up[4][MDS_TYPES];
   mds_id* free[MDS_TYPES];
   mds_id first_free[MDS_TYPES];
+  struct mds_frozen* frozen;
 };
 
 struct mds_set {
@@ -72,4 +87,13 @@ void mds_change_dimension(struct mds* m, int d);
 
 void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down);
 
+void mds_get_compact_map(struct mds* m, mds_id* new_of[MDS_TYPES]);
+void mds_free_compact_map(mds_id* new_of[MDS_TYPES]);
+void mds_compact(struct mds* m, mds_id* new_of[MDS_TYPES]);
+
+void mds_freeze(struct mds* m);
+void mds_thaw(struct mds* m);
+mds_id const* mds_frozen_up(struct mds* m, mds_id e, int* n);
+mds_id const* mds_frozen_bridge(struct mds* m, mds_id e, int* n);
+
 #endif
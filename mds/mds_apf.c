@@ -10,6 +10,7 @@
 
 #include "mds_apf.h"
 #include <stdlib.h>
+#include <string.h>
 #include <pcu_util.h>
 #include <PCU.h>
 
@@ -123,6 +124,72 @@ void mds_apf_destroy_entity(struct mds_apf* m, mds_id e)
   mds_destroy_entity(&(m->mds),e);
 }
 
+static void compact_arrays(struct mds_apf* m, mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  mds_id j;
+  for (t = 0; t < MDS_TYPES; ++t)
+    for (i = 0; i < m->mds.end[t]; ++i) {
+      j = new_of[t][i];
+      if (j == MDS_NONE || j == i)
+        continue;
+      m->model[t][j] = m->model[t][i];
+      m->parts[t][j] = m->parts[t][i];
+      if (t == MDS_VERTEX) {
+        memcpy(m->point[j], m->point[i], sizeof(*(m->point)));
+        memcpy(m->param[j], m->param[i], sizeof(*(m->param)));
+      }
+    }
+}
+
+static void shrink_arrays(struct mds_apf* m, mds_id old_cap[MDS_TYPES])
+{
+  int t;
+  mds_grow_tags(&(m->tags),&(m->mds),old_cap);
+  m->point = realloc(m->point,m->mds.cap[MDS_VERTEX] * sizeof(*(m->point)));
+  m->param = realloc(m->param,m->mds.cap[MDS_VERTEX] * sizeof(*(m->param)));
+  for (t = 0; t < MDS_TYPES; ++t) {
+    m->model[t] = realloc(m->model[t],
+        m->mds.cap[t] * sizeof(*(m->model[t])));
+    m->parts[t] = realloc(m->parts[t],
+        m->mds.cap[t] * sizeof(*(m->parts[t])));
+  }
+  mds_grow_net(&m->remotes, &m->mds, old_cap);
+  mds_grow_net(&m->ghosts, &m->mds, old_cap);
+  mds_grow_net(&m->matches, &m->mds, old_cap);
+}
+
+/* removes the holes left by destroyed entities without building a
+   second mesh: live entities slide down in place, every stored id
+   is mapped to its new value and the arrays shrink to fit.
+   when peers are not ignored this is collective, since the
+   copies on other parts also change ids. */
+void mds_apf_compact(struct mds_apf* m, int ignore_peers)
+{
+  mds_id* new_of[MDS_TYPES];
+  mds_id old_cap[MDS_TYPES];
+  struct mds_net* nets[3];
+  int t;
+  mds_get_compact_map(&m->mds, new_of);
+  if (!ignore_peers) {
+    nets[0] = &m->remotes;
+    nets[1] = &m->ghosts;
+    nets[2] = &m->matches;
+    mds_renumber_nets(nets, 3, &m->mds, new_of);
+  }
+  mds_compact_tags(&m->tags, &m->mds, new_of);
+  mds_compact_net(&m->remotes, &m->mds, new_of);
+  mds_compact_net(&m->ghosts, &m->mds, new_of);
+  mds_compact_net(&m->matches, &m->mds, new_of);
+  compact_arrays(m, new_of);
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
+  mds_compact(&m->mds, new_of);
+  shrink_arrays(m, old_cap);
+  mds_free_compact_map(new_of);
+}
+
 void* mds_get_part(struct mds_apf* m, mds_id e)
 {
   return m->parts[mds_type(e)][mds_index(e)];
@@ -50,6 +50,7 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model);
 mds_id mds_apf_create_entity(
     struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from);
 void mds_apf_destroy_entity(struct mds_apf* m, mds_id e);
+void mds_apf_compact(struct mds_apf* m, int ignore_peers);
 
 void* mds_get_part(struct mds_apf* m, mds_id e);
 void mds_set_part(struct mds_apf* m, mds_id e, void* p);
@@ -57,6 +58,8 @@ void mds_set_part(struct mds_apf* m, mds_id e, void* p);
 struct mds_tag* mds_number_verts_bfs(struct mds_apf* m);
 struct mds_apf* mds_reorder(struct mds_apf* m, int ignore_peers,
     struct mds_tag* vert_numbers);
+struct mds_apf* mds_reorder_by_elements(struct mds_apf* m, int ignore_peers,
+    struct mds_tag* elem_numbers);
 
 struct gmi_ent* mds_find_model(struct mds_apf* m, int dim, int id);
 int mds_model_dim(struct mds_apf* m, struct gmi_ent* model);
@@ -66,6 +69,7 @@ struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
     int ignore_peers, void* apf_mesh);
 struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     int ignore_peers, void* apf_mesh);
+int mds_count_smb_parts(const char* pathname);
 
 void mds_verify(struct mds_apf* m);
 void mds_verify_residence(struct mds_apf* m, mds_id e);
@@ -91,6 +91,115 @@ void mds_grow_net(
     }
 }
 
+/* moves copies to the slots given by mds_get_compact_map,
+   call this before mds_compact and mds_grow_net after it */
+void mds_compact_net(
+    struct mds_net* net,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  mds_id j;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (!net->data[t])
+      continue;
+    for (i = 0; i < m->end[t]; ++i) {
+      j = new_of[t][i];
+      if (j == MDS_NONE) {
+        PCU_ALWAYS_ASSERT(!net->data[t][i]);
+        continue;
+      }
+      net->data[t][j] = net->data[t][i];
+    }
+    for (i = m->n[t]; i < m->end[t]; ++i)
+      net->data[t][i] = NULL;
+  }
+}
+
+struct renumbering {
+  int to;
+  int net;
+  mds_id e;
+  int copy;
+  mds_id ce;
+};
+
+/* copies are not always symmetric (a ghost only knows its owner,
+   while every copy of the owner knows the ghost), so each part
+   asks the peers of its copies for their new ids and they reply */
+void mds_renumber_nets(
+    struct mds_net** nets,
+    int count,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES])
+{
+  int k;
+  int t;
+  mds_id i;
+  int j;
+  mds_id e;
+  mds_id ce;
+  struct mds_copies* cs;
+  struct renumbering* r;
+  size_t n, cap;
+  size_t a;
+  r = NULL;
+  n = cap = 0;
+  PCU_Comm_Begin();
+  for (k = 0; k < count; ++k)
+    for (t = 0; t < MDS_TYPES; ++t) {
+      if (!nets[k]->data[t])
+        continue;
+      for (i = 0; i < m->end[t]; ++i) {
+        cs = nets[k]->data[t][i];
+        if (!cs)
+          continue;
+        e = mds_identify(t, i);
+        for (j = 0; j < cs->n; ++j) {
+          PCU_COMM_PACK(cs->c[j].p, k);
+          PCU_COMM_PACK(cs->c[j].p, e);
+          PCU_COMM_PACK(cs->c[j].p, j);
+          PCU_COMM_PACK(cs->c[j].p, cs->c[j].e);
+        }
+      }
+    }
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    if (n == cap) {
+      cap = cap * 2 + 16;
+      r = realloc(r, cap * sizeof(*r));
+    }
+    r[n].to = PCU_Comm_Sender();
+    PCU_COMM_UNPACK(r[n].net);
+    PCU_COMM_UNPACK(r[n].e);
+    PCU_COMM_UNPACK(r[n].copy);
+    PCU_COMM_UNPACK(ce);
+    t = mds_type(ce);
+    r[n].ce = mds_identify(t, new_of[t][mds_index(ce)]);
+    ++n;
+  }
+  PCU_Comm_Begin();
+  for (a = 0; a < n; ++a) {
+    PCU_COMM_PACK(r[a].to, r[a].net);
+    PCU_COMM_PACK(r[a].to, r[a].e);
+    PCU_COMM_PACK(r[a].to, r[a].copy);
+    PCU_COMM_PACK(r[a].to, r[a].ce);
+  }
+  free(r);
+  PCU_Comm_Send();
+  while (PCU_Comm_Receive()) {
+    PCU_COMM_UNPACK(k);
+    PCU_COMM_UNPACK(e);
+    PCU_COMM_UNPACK(j);
+    PCU_COMM_UNPACK(ce);
+    cs = mds_get_copies(nets[k], e);
+    PCU_ALWAYS_ASSERT(cs && j < cs->n);
+    PCU_ALWAYS_ASSERT(cs->c[j].p == PCU_Comm_Sender());
+    cs->c[j].e = ce;
+  }
+}
+
 static int find_place(struct mds_copies* cs, int p)
 {
   int i;
@@ -46,6 +46,15 @@ void mds_grow_net(
     struct mds_net* net,
     struct mds* m,
     mds_id old_cap[MDS_TYPES]);
+void mds_compact_net(
+    struct mds_net* net,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES]);
+void mds_renumber_nets(
+    struct mds_net** nets,
+    int count,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES]);
 
 void mds_add_copy(struct mds_net* net, struct mds* m, mds_id e,
     struct mds_copy c);
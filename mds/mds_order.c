@@ -416,3 +416,83 @@ struct mds_apf* mds_reorder(struct mds_apf* m, int ignore_peers,
   mds_apf_destroy(m);
   return m2;
 }
+
+static mds_id* sort_elements(struct mds_apf* m, struct mds_tag* tag,
+    mds_id* count)
+{
+  int t;
+  mds_id e;
+  mds_id* sorted;
+  int* ip;
+  *count = 0;
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == m->mds.d)
+      *count += m->mds.n[t];
+  sorted = malloc(sizeof(mds_id) * (*count));
+  for (e = mds_begin(&m->mds, m->mds.d);
+       e != MDS_NONE;
+       e = mds_next(&m->mds, e)) {
+    ip = mds_get_tag(tag, e);
+    PCU_ALWAYS_ASSERT(0 <= *ip && *ip < *count);
+    sorted[*ip] = e;
+  }
+  return sorted;
+}
+
+static void visit_closure(struct mds* m, struct mds_tag* tag,
+    int* labels, mds_id e)
+{
+  struct mds_set adj;
+  int d;
+  int i;
+  visit(m, tag, &labels[mds_type(e)], e);
+  for (d = mds_dim[mds_type(e)] - 1; d >= 0; --d) {
+    mds_get_adjacent(m, e, d, &adj);
+    for (i = 0; i < adj.n; ++i)
+      visit(m, tag, &labels[mds_type(adj.e[i])], adj.e[i]);
+  }
+}
+
+/* elements are numbered by the given labels and every other
+   entity follows the first element whose closure contains it,
+   so the vertices of neighboring elements end up close together */
+static struct mds_tag* number_from_elements(struct mds_apf* m,
+    struct mds_tag* elem_numbers)
+{
+  struct mds_tag* tag;
+  mds_id* sorted;
+  mds_id count;
+  mds_id i;
+  mds_id e;
+  int labels[MDS_TYPES];
+  int t;
+  int d;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    PCU_ALWAYS_ASSERT(m->mds.n[t] < INT_MAX);
+    labels[t] = 0;
+  }
+  tag = mds_create_tag(&m->tags, "mds_number", sizeof(int), 1);
+  sorted = sort_elements(m, elem_numbers, &count);
+  for (i = 0; i < count; ++i)
+    visit_closure(&m->mds, tag, labels, sorted[i]);
+  free(sorted);
+  /* entities not bounding any element keep their old order */
+  for (d = 0; d < m->mds.d; ++d)
+    for (e = mds_begin(&m->mds, d); e != MDS_NONE; e = mds_next(&m->mds, e))
+      visit(&m->mds, tag, &labels[mds_type(e)], e);
+  for (t = 0; t < MDS_TYPES; ++t)
+    PCU_ALWAYS_ASSERT(labels[t] == m->mds.n[t]);
+  return tag;
+}
+
+struct mds_apf* mds_reorder_by_elements(struct mds_apf* m, int ignore_peers,
+    struct mds_tag* elem_numbers)
+{
+  struct mds_tag* tag;
+  struct mds_apf* m2;
+  tag = number_from_elements(m, elem_numbers);
+  mds_destroy_tag(&m->tags, elem_numbers);
+  m2 = rebuild(m, tag, ignore_peers);
+  mds_apf_destroy(m);
+  return m2;
+}
@@ -557,11 +557,10 @@ static void write_matches(struct pcu_file* f, struct mds_apf* m,
     write_type_matches(f, m, smb2mds(t), ignore_peers);
 }
 
-static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+static struct mds_apf* read_smb(struct gmi_model* model, struct pcu_file* f,
+    int ignore_peers, void* apf_mesh)
 {
   struct mds_apf* m;
-  struct pcu_file* f;
   unsigned version;
   unsigned dim;
   unsigned n[SMB_TYPES];
@@ -569,8 +568,6 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
   int i;
   unsigned tmp;
   unsigned pi, pj;
-  f = pcu_fopen(filename, 0, zip);
-  PCU_ALWAYS_ASSERT(f);
   read_header(f, &version, &dim, ignore_peers);
   pcu_read_unsigneds(f, n, SMB_TYPES);
   for (i = 0; i < MDS_TYPES; ++i) {
@@ -599,7 +596,6 @@ static struct mds_apf* read_smb(struct gmi_model* model, const char* filename,
     read_matches_old(f, m, ignore_peers);
   if (version >= 5)
     mds_read_smb_meta(f, m, apf_mesh);
-  pcu_fclose(f);
   return m;
 }
 
@@ -612,14 +608,11 @@ static void write_coords(struct pcu_file* f, struct mds_apf* m)
   pcu_write_doubles(f, &m->param[0][0], count);
 }
 
-static void write_smb(struct mds_apf* m, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+static void write_smb(struct mds_apf* m, struct pcu_file* f,
+    int ignore_peers, void* apf_mesh)
 {
-  struct pcu_file* f;
   unsigned n[SMB_TYPES] = {0};
   int i;
-  f = pcu_fopen(filename, 1, zip);
-  PCU_ALWAYS_ASSERT(f);
   write_header(f, m->mds.d, ignore_peers);
   for (i = 0; i < MDS_TYPES; ++i)
     n[mds2smb(i)] = m->mds.end[i];
@@ -631,7 +624,6 @@ static void write_smb(struct mds_apf* m, const char* filename,
   write_tags(f, m);
   write_matches(f, m, ignore_peers);
   mds_write_smb_meta(f, apf_mesh);
-  pcu_fclose(f);
 }
 
 static int ends_with(const char* s, const char* w)
@@ -686,10 +678,23 @@ static void safe_mkdir(const char* path, mode_t mode)
     reel_fail("MDS: could not create directory \"%s\"\n", path);
 }
 
+/* a "bz2:" or "zst:" prefix picks the pcu_fopen codec */
+static int remove_codec(char* path)
+{
+  static const char* prefixes[] = {"bz2:", "zst:"};
+  static const int codecs[] = {PCU_CODEC_BZIP2, PCU_CODEC_ZSTD};
+  int i;
+  for (i = 0; i < 2; ++i)
+    if (starts_with(path, prefixes[i])) {
+      remove_prefix(path, prefixes[i]);
+      return codecs[i];
+    }
+  return PCU_CODEC_RAW;
+}
+
 static char* handle_path(const char* in, int is_write, int* zip,
     int ignore_peers)
 {
-  static const char* zippre = "bz2:";
   static const char* smbext = ".smb";
   size_t bufsize;
   char* path;
@@ -698,12 +703,7 @@ static char* handle_path(const char* in, int is_write, int* zip,
   bufsize = strlen(in) + 256;
   path = malloc(bufsize);
   strcpy(path, in);
-  if (starts_with(path, zippre)) {
-    *zip = 1;
-    remove_prefix(path, zippre);
-  } else {
-    *zip = 0;
-  }
+  *zip = remove_codec(path);
   if (ignore_peers)
     return path;
   if (ends_with(path, "/")) {
@@ -729,15 +729,49 @@ static char* handle_path(const char* in, int is_write, int* zip,
   return path;
 }
 
-struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
-    int ignore_peers, void* apf_mesh)
+/* "foo.smbs" names one file holding every part,
+   see pcu_shared_open */
+static int is_shared(const char* pathname, int ignore_peers)
+{
+  if (!ends_with(pathname, ".smbs"))
+    return 0;
+  if (ignore_peers || starts_with(pathname, "bz2:") ||
+      starts_with(pathname, "zst:"))
+    reel_fail("MDS: shared smb file \"%s\" can only be used "
+        "uncompressed by all ranks at once\n", pathname);
+  return 1;
+}
+
+static struct pcu_file* open_smb(const char* pathname, int is_write,
+    int ignore_peers)
 {
   char* filename;
   int zip;
-  struct mds_apf* m;
-  filename = handle_path(pathname, 0, &zip, ignore_peers);
-  m = read_smb(model, filename, zip, ignore_peers, apf_mesh);
+  struct pcu_file* f;
+  if (is_shared(pathname, ignore_peers))
+    return pcu_shared_open(pathname, PCU_Comm_Self(), is_write);
+  filename = handle_path(pathname, is_write, &zip, ignore_peers);
+  f = pcu_fopen(filename, is_write, zip);
+  PCU_ALWAYS_ASSERT(f);
   free(filename);
+  return f;
+}
+
+int mds_count_smb_parts(const char* pathname)
+{
+  if (!is_shared(pathname, 0))
+    return PCU_Comm_Peers();
+  return pcu_count_shared(pathname);
+}
+
+struct mds_apf* mds_read_smb(struct gmi_model* model, const char* pathname,
+    int ignore_peers, void* apf_mesh)
+{
+  struct pcu_file* f;
+  struct mds_apf* m;
+  f = open_smb(pathname, 0, ignore_peers);
+  m = read_smb(model, f, ignore_peers, apf_mesh);
+  pcu_fclose(f);
   return m;
 }
 
@@ -754,8 +788,7 @@ struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     int ignore_peers, void* apf_mesh)
 {
   const char* reorderWarning ="MDS: reordering before writing smb files\n";
-  char* filename;
-  int zip;
+  struct pcu_file* f;
   if (ignore_peers && (!is_compact(m))) {
     if(!PCU_Comm_Self()) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(m, 1, mds_number_verts_bfs(m));
@@ -764,9 +797,9 @@ struct mds_apf* mds_write_smb(struct mds_apf* m, const char* pathname,
     if(!PCU_Comm_Self()) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(m, 0, mds_number_verts_bfs(m));
   }
-  filename = handle_path(pathname, 1, &zip, ignore_peers);
-  write_smb(m, filename, zip, ignore_peers, apf_mesh);
-  free(filename);
+  f = open_smb(pathname, 1, ignore_peers);
+  write_smb(m, f, ignore_peers, apf_mesh);
+  pcu_fclose(f);
   return m;
 }
 
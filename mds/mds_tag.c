@@ -12,15 +12,95 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* counts every change to the set or names of tags of any mesh,
+   so that users can cache the results of mds_find_tag */
+static unsigned long changes = 0;
+
+unsigned long mds_tag_changes(void)
+{
+  return changes;
+}
+
 void mds_create_tags(struct mds_tags* ts)
 {
   ts->first = NULL;
+  ts->table = NULL;
+  ts->table_size = 0;
+  ts->count = 0;
+  ++changes;
 }
 
 void mds_destroy_tags(struct mds_tags* ts)
 {
   while (ts->first)
     mds_destroy_tag(ts,ts->first);
+  free(ts->table);
+  ts->table = NULL;
+  ts->table_size = 0;
+  ++changes;
+}
+
+/* FNV-1a */
+static unsigned hash_name(const char* name)
+{
+  unsigned h = 2166136261u;
+  for (; *name; ++name) {
+    h ^= (unsigned char)(*name);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void link_hash(struct mds_tags* ts, struct mds_tag* t)
+{
+  struct mds_tag** head;
+  head = &ts->table[t->hash & (ts->table_size - 1)];
+  t->hash_next = *head;
+  *head = t;
+}
+
+/* the table size is a power of two at least the tag count.
+   chains are kept newest first, like the list, so that a name
+   used twice finds the newest tag: the list is walked from the
+   newest tag and each one is appended to its chain */
+static void grow_table(struct mds_tags* ts)
+{
+  struct mds_tag* t;
+  struct mds_tag** tail;
+  if (ts->count < ts->table_size)
+    return;
+  ts->table_size = ts->table_size ? ts->table_size * 2 : 16;
+  free(ts->table);
+  ts->table = calloc(ts->table_size, sizeof(*(ts->table)));
+  for (t = ts->first; t; t = t->next) {
+    if (t->hash_next == t)
+      continue;
+    for (tail = &ts->table[t->hash & (ts->table_size - 1)];
+         *tail; tail = &((*tail)->hash_next));
+    t->hash_next = NULL;
+    *tail = t;
+  }
+}
+
+static void hash_tag(struct mds_tags* ts, struct mds_tag* t)
+{
+  t->hash = hash_name(t->name);
+  /* marks the tag as not yet in the table for grow_table */
+  t->hash_next = t;
+  ++ts->count;
+  grow_table(ts);
+  link_hash(ts, t);
+  ++changes;
+}
+
+static void unhash_tag(struct mds_tags* ts, struct mds_tag* t)
+{
+  struct mds_tag** p;
+  for (p = &ts->table[t->hash & (ts->table_size - 1)];
+       *p != t; p = &((*p)->hash_next));
+  *p = t->hash_next;
+  --ts->count;
+  ++changes;
 }
 
 static void grow_tag(
@@ -54,6 +134,45 @@ void mds_grow_tags(
     grow_tag(t,m,old_cap);
 }
 
+static void compact_tag(
+    struct mds_tag* tag,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES])
+{
+  int t;
+  mds_id i;
+  mds_id j;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if ( ! tag->has[t])
+      continue;
+    for (i = 0; i < m->end[t]; ++i) {
+      j = new_of[t][i];
+      if (j == MDS_NONE || j == i)
+        continue;
+      if (mds_has_tag(tag, mds_identify(t, i))) {
+        memcpy(tag->data[t] + tag->bytes * j,
+               tag->data[t] + tag->bytes * i, tag->bytes);
+        mds_give_tag(tag, m, mds_identify(t, j));
+      } else
+        mds_take_tag(tag, mds_identify(t, j));
+    }
+    for (i = m->n[t]; i < m->end[t]; ++i)
+      mds_take_tag(tag, mds_identify(t, i));
+  }
+}
+
+/* moves tag data to the slots given by mds_get_compact_map,
+   call this before mds_compact and mds_grow_tags after it */
+void mds_compact_tags(
+    struct mds_tags* ts,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES])
+{
+  struct mds_tag* t;
+  for (t = ts->first; t; t = t->next)
+    compact_tag(t,m,new_of);
+}
+
 struct mds_tag* mds_create_tag(
     struct mds_tags* ts,
     const char* name,
@@ -70,6 +189,7 @@ struct mds_tag* mds_create_tag(
   l = strlen(name);
   t->name = malloc(l + 1);
   strcpy(t->name,name);
+  hash_tag(ts, t);
   return t;
 }
 
@@ -77,6 +197,7 @@ void mds_destroy_tag(struct mds_tags* ts, struct mds_tag* t)
 {
   struct mds_tag** p;
   int i;
+  unhash_tag(ts, t);
   for (p = &(ts->first); *p != t; p = &((*p)->next));
   *p = (*p)->next;
   for (i = 0; i < MDS_TYPES; ++i)
@@ -95,8 +216,12 @@ void* mds_get_tag(struct mds_tag* tag, mds_id e)
 struct mds_tag* mds_find_tag(struct mds_tags* ts, const char* name)
 {
   struct mds_tag* p;
-  for (p = ts->first; p; p = p->next)
-    if ( ! strcmp(p->name,name))
+  unsigned h;
+  if (!ts->table_size)
+    return 0;
+  h = hash_name(name);
+  for (p = ts->table[h & (ts->table_size - 1)]; p; p = p->hash_next)
+    if (p->hash == h && ! strcmp(p->name,name))
       return p;
   return 0;
 }
@@ -154,13 +279,40 @@ void mds_take_tag(struct mds_tag* tag, mds_id e)
   *has &= ~(1 << b);
 }
 
-void mds_rename_tag(struct mds_tag* tag, const char* newName)
+void mds_rename_tag(struct mds_tags* ts, struct mds_tag* tag,
+    const char* newName)
 {
   int l;
+  unhash_tag(ts, tag);
   l = strlen(newName);
   free(tag->name);
   tag->name = malloc(l + 1);
   strcpy(tag->name,newName);
+  hash_tag(ts, tag);
+}
+
+/* copies the data of the entities of one type with indices
+   [first, first + count) into (out), those entities
+   must all have the tag */
+void mds_get_tag_range(struct mds_tag* tag, int type,
+    mds_id first, mds_id count, void* out)
+{
+  if (!count)
+    return;
+  memcpy(out, tag->data[type] + tag->bytes * first, tag->bytes * count);
+}
+
+/* gives the tag to the entities of one type with indices
+   [first, first + count) and copies their data from (in) */
+void mds_set_tag_range(struct mds_tag* tag, struct mds* m, int type,
+    mds_id first, mds_id count, void const* in)
+{
+  mds_id i;
+  if (!count)
+    return;
+  for (i = first; i < first + count; ++i)
+    mds_give_tag(tag, m, mds_identify(type, i));
+  memcpy(tag->data[type] + tag->bytes * first, in, tag->bytes * count);
 }
 
 static struct mds_tag** find_prev(struct mds_tags* ts, struct mds_tag* t)
@@ -187,6 +339,8 @@ void mds_swap_tag_structs(struct mds_tags* as, struct mds_tag** a,
   struct mds_tag** pb;
   struct mds_tag tmp;
   struct mds_tag* tmp_p;
+  unhash_tag(as, *a);
+  unhash_tag(bs, *b);
   pa = find_prev(as, *a);
   pb = find_prev(bs, *b);
   tmp = **a;
@@ -197,4 +351,6 @@ void mds_swap_tag_structs(struct mds_tags* as, struct mds_tag** a,
   tmp_p = *a;
   *a = *b;
   *b = tmp_p;
+  hash_tag(as, *a);
+  hash_tag(bs, *b);
 }
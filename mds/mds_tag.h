@@ -20,18 +20,31 @@ struct mds_tag {
   char* data[MDS_TYPES];
   unsigned char* has[MDS_TYPES];
   char* name;
+  unsigned hash;
+  struct mds_tag* hash_next;
 };
 
+/* tags are kept in a list, in creation order from last to first,
+   and in a table of hash chains for lookup by name */
 struct mds_tags {
   struct mds_tag* first;
+  struct mds_tag** table;
+  unsigned table_size;
+  unsigned count;
 };
 
+unsigned long mds_tag_changes(void);
+
 void mds_create_tags(struct mds_tags* ts);
 void mds_destroy_tags(struct mds_tags* ts);
 void mds_grow_tags(
     struct mds_tags* ts,
     struct mds* m,
     mds_id old_cap[MDS_TYPES]);
+void mds_compact_tags(
+    struct mds_tags* ts,
+    struct mds* m,
+    mds_id* new_of[MDS_TYPES]);
 struct mds_tag* mds_create_tag(
     struct mds_tags* ts,
     const char* name,
@@ -43,7 +56,13 @@ struct mds_tag* mds_find_tag(struct mds_tags* ts, const char* name);
 int mds_has_tag(struct mds_tag* tag, mds_id e);
 void mds_give_tag(struct mds_tag* tag, struct mds* m, mds_id e);
 void mds_take_tag(struct mds_tag* tag, mds_id e);
-void mds_rename_tag(struct mds_tag* tag, const char* newName);
+void mds_rename_tag(struct mds_tags* ts, struct mds_tag* tag,
+    const char* newName);
+
+void mds_get_tag_range(struct mds_tag* tag, int type,
+    mds_id first, mds_id count, void* out);
+void mds_set_tag_range(struct mds_tag* tag, struct mds* m, int type,
+    mds_id first, mds_id count, void const* in);
 
 void mds_swap_tag_structs(struct mds_tags* as, struct mds_tag** a,
     struct mds_tags* bs, struct mds_tag** b);
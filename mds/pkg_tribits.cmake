@@ -29,6 +29,7 @@ endif(ENABLE_CGNS)
 set(MDS_HEADERS
   apfMDS.h
   apfBox.h
+  ${CMAKE_CURRENT_BINARY_DIR}/mds_config.h
 )
 
 # THIS IS WHERE TRIBITS GETS HEADERS
@@ -213,7 +213,19 @@ static void fields_from_osh(apf::Mesh* am, osh::Mesh* om) {
 }
 
 static void coords_to_osh(osh::Mesh* om, apf::Mesh* am) {
-  field_to_osh(om, am->getCoordinateField());
+  auto f = am->getCoordinateField();
+  if (apf::getShape(f) != apf::getLagrange(1)) {
+    field_to_osh(om, f);
+    return;
+  }
+  auto dim = om->dim();
+  apf::MeshSpan<double> points;
+  am->getPoints(points);
+  auto nverts = osh::LO(points.getSize() / 3);
+  auto data = osh::HostWrite<osh::Real>(nverts * dim);
+  for (osh::LO i = 0; i < nverts; ++i)
+    for (int j = 0; j < dim; ++j) data[i * dim + j] = points[i * 3 + j];
+  om->add_tag(0, apf::getName(f), dim, osh::Reals(data.write()));
 }
 
 static void coords_from_osh(apf::Mesh* am, osh::Mesh* om) {
@@ -239,24 +251,14 @@ static void class_to_osh(osh::Mesh* mesh_osh, apf::Mesh* mesh_apf, int dim) {
   mesh_osh->add_tag(dim, "class_id", 1, osh::LOs(host_class_id.write()));
 }
 
-static void conn_to_osh(osh::Mesh* mesh_osh, apf::Mesh* mesh_apf,
-    apf::Numbering* vert_nums, int d) {
+static void conn_to_osh(osh::Mesh* mesh_osh, apf::Mesh* mesh_apf, int d) {
   auto nhigh = osh::LO(mesh_apf->count(d));
   auto deg = d + 1;
+  apf::MeshSpan<int> verts;
+  mesh_apf->getElementVertices(apf::Mesh::simplexTypes[d], verts);
+  OMEGA_H_CHECK(osh::LO(verts.getSize()) == nhigh * deg);
   osh::HostWrite<osh::LO> host_ev2v(nhigh * deg);
-  auto iter = mesh_apf->begin(d);
-  apf::MeshEntity* he;
-  int i = 0;
-  while ((he = mesh_apf->iterate(iter))) {
-    apf::Downward eev;
-    auto deg2 = mesh_apf->getDownward(he, 0, eev);
-    OMEGA_H_CHECK(deg == deg2);
-    for (int j = 0; j < deg; ++j) {
-      host_ev2v[i * deg + j] = apf::getNumber(vert_nums, eev[j], 0, 0);
-    }
-    ++i;
-  }
-  mesh_apf->end(iter);
+  for (osh::LO i = 0; i < nhigh * deg; ++i) host_ev2v[i] = verts[i];
   auto ev2v = osh::LOs(host_ev2v.write());
   osh::Adj high2low;
   if (d == 1) {
@@ -306,13 +308,11 @@ void to_omega_h(osh::Mesh* om, apf::Mesh* am) {
   coords_to_osh(om, am);
   class_to_osh(om, am, 0);
   globals_to_osh(om, am, 0);
-  auto vert_nums = apf::numberOverlapDimension(am, "apf2osh", 0);
   for (int d = 1; d <= dim; ++d) {
-    conn_to_osh(om, am, vert_nums, d);
+    conn_to_osh(om, am, d);
     class_to_osh(om, am, d);
     globals_to_osh(om, am, d);
   }
-  apf::destroyNumbering(vert_nums);
   fields_to_osh(om, am);
 }
 
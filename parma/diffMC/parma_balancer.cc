@@ -3,6 +3,8 @@
 #include "parma_monitor.h"
 #include "parma_graphDist.h"
 #include "parma_commons.h"
+#include "parma_tracker.h"
+#include <pcu_util.h>
 
 namespace {
   void printTiming(const char* type, int steps, double tol, double time) {
@@ -16,6 +18,8 @@ namespace parma {
   Balancer::Balancer(apf::Mesh* m, double f, int v, const char* n)
     : mesh(m), factor(f), verbose(v), name(n) {
       maxStep = 300;
+      tracker = 0;
+      numTracked = 0;
       iS = new parma::Slope();
       iA = new parma::Average(8);
       sS = new parma::Slope();
@@ -36,9 +40,19 @@ namespace parma {
     if( 1 == PCU_Comm_Peers() ) return;
     int step = 0;
     double t0 = PCU_Time();
+    if (numTracked)
+      tracker = new Tracker(mesh, wtag, numTracked, trackedDims);
     while (runStep(wtag,tolerance) && step++ < maxStep);
+    delete tracker;
+    tracker = 0;
     printTiming(name, step, tolerance, PCU_Time()-t0);
   }
+  void Balancer::track(int n, const int dims[]) {
+    PCU_ALWAYS_ASSERT(n <= 4);
+    numTracked = n;
+    for (int i = 0; i < n; ++i)
+      trackedDims[i] = dims[i];
+  }
   void Balancer::monitorUpdate(double v, Slope* s, Average* a) {
     s->push(v);
     const double slope = (s->full()) ? s->slope() : 1.0;
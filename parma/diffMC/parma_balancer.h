@@ -6,6 +6,7 @@
 namespace parma {
   class Slope;
   class Average;
+  class Tracker;
   class Balancer : public apf::Balancer {
     public:
       Balancer(apf::Mesh* m, double f, int v, const char* n);
@@ -19,10 +20,17 @@ namespace parma {
       const char* name;
       int maxStep;
     protected:
+      /* keep the sides and the weights of dims[0..n) current across
+         the steps of balance instead of rebuilding them each step */
+      void track(int n, const int dims[]);
+      Tracker* tracker;
       Slope* iS;
       Average* iA;
       Slope* sS;
       Average* sA;
+    private:
+      int trackedDims[4];
+      int numTracked;
   };
 
   apf::Balancer* makeElmLtVtxEdgeBalancer(apf::Mesh* m, double maxVtx,
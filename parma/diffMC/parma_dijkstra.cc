@@ -2,6 +2,7 @@
 #include <apf.h>
 #include <PCU.h>
 #include <pcu_util.h>
+#include <algorithm>
 #include "parma_dijkstra.h" 
 #include "parma_meshaux.h" 
 #include "parma_distQ.h"
@@ -14,156 +15,140 @@
  * exclusively to the current component will not be distanced.
  */
 namespace {
-  void resetDist(apf::Mesh* m, parma::DijkstraContains* c, apf::MeshTag* d) {
-    const int far = INT_MAX;
-    apf::MeshEntity* v;
-    apf::MeshIterator* it = m->begin(0);
-    while( (v = m->iterate(it)) ) {
-      if( !c->has(v) ) continue;
-      m->setIntTag(v,d,&far);
-    }
-    m->end(it);
-  }
+  typedef std::vector<int> Verts;
 
-  void getCavity(apf::Mesh* m, apf::MeshEntity* v, apf::Up& cavity) {
-    cavity.n = 0;
+  /* pairs of vertices bounding the edges of the cavity around u
+     that lie in the component */
+  void getCavityEdges(apf::Mesh* m, parma::VtxGraph& g,
+      parma::DijkstraContains* c, int u, Verts& ce) {
     apf::Adjacent elms;
-    m->getAdjacent(v, m->getDimension(), elms);
-    APF_ITERATE(apf::Adjacent, elms, adjItr)
-      cavity.e[(cavity.n)++] = *adjItr;
-  }
-
-  typedef std::set<apf::MeshEntity*> CavEnts;
-  CavEnts* getCavityEdges(apf::Mesh* m, parma::DijkstraContains* c, 
-      apf::Up& cavity) {
-    CavEnts* ce = new CavEnts;
-    for(int i=0; i<cavity.n; i++) {
+    m->getAdjacent(g.vertex(u), m->getDimension(), elms);
+    APF_ITERATE(apf::Adjacent, elms, elm) {
       apf::Downward edges;
-      int ne = m->getDownward(cavity.e[i], 1, edges);
+      int ne = m->getDownward(*elm, 1, edges);
       for(int j=0; j<ne; j++) {
         apf::Downward verts;
         int nv = m->getDownward(edges[j], 0, verts);
         PCU_ALWAYS_ASSERT(nv==2);
-        if( c->has(verts[0]) && c->has(verts[1]) )
-          ce->insert(edges[j]);
+        int a = g.index(verts[0]);
+        int b = g.index(verts[1]);
+        if( c->has(a) && c->has(b) ) {
+          ce.push_back(a);
+          ce.push_back(b);
+        }
       }
     }
-    return ce;
   }
 
-  apf::MeshEntity* parentVtx(apf::Mesh* m, parma::DijkstraContains* c,
-      apf::MeshTag* d, apf::MeshEntity* u) {
-    apf::MeshEntity* parent = NULL;
-    int ud; m->getIntTag(u,d,&ud);
-    apf::Adjacent adjVtx;
-    getEdgeAdjVtx(m,u,adjVtx);
-    APF_ITERATE(apf::Adjacent, adjVtx, v) {
-      int vd; m->getIntTag(*v,d,&vd);
-      if( vd == ud-1 && c->has(*v) ) {
-        parent = *v;
-        break;
+  int parentVtx(parma::VtxGraph& g, parma::DijkstraContains* c,
+      Verts& dist, int u, Verts& adj) {
+    g.getAdjacent(u, adj);
+    for(size_t i=0; i<adj.size(); i++)
+      if( dist[adj[i]] == dist[u]-1 && c->has(adj[i]) )
+        return adj[i];
+    return -1;
+  }
+
+  /* the vertices reached from p along cavity edges without
+     passing through s */
+  void walkCavEdges(Verts& ce, int p, int s, Verts& adjVtx) {
+    Verts seen(1, p);
+    for(size_t i=0; i<seen.size(); i++) {
+      int u = seen[i];
+      for(size_t j=0; j<ce.size(); j+=2) {
+        int v;
+        if( ce[j] == u )
+          v = ce[j+1];
+        else if( ce[j+1] == u )
+          v = ce[j];
+        else
+          continue;
+        if( v == s || std::find(seen.begin(), seen.end(), v) != seen.end() )
+          continue;
+        seen.push_back(v);
+        adjVtx.push_back(v);
       }
     }
-    return parent;
   }
 
-  typedef std::set<apf::MeshEntity*> Level;
-  void walkCavEdges(apf::Mesh* m, CavEnts* ce, apf::MeshEntity* p,
-      apf::MeshEntity* s, apf::Adjacent& adjVtx) {
-    typedef apf::DynamicArray<apf::MeshEntity*> entArr;
-    //should be an upper bound
-    const unsigned maxVisited = TO_UINT(ce->size()*2);
-    entArr visited(maxVisited);
-    adjVtx.setSize(maxVisited);
-    unsigned visCnt=0;
-    size_t numAdj=0;
-    apf::MeshTag* lvlT = m->createIntTag("parmaCavWalk",1);
-    Level cur;
-    Level next; 
-    next.insert(p);
-    int treeDepth = 0;
-    while( ! next.empty() ) {
-      cur = next;
-      next.clear();
-      treeDepth++;
-      APF_ITERATE(Level, cur, vtxItr) {
-        apf::MeshEntity* u = *vtxItr;
-        if( m->hasTag(u,lvlT) ) continue;
-        m->setIntTag(u,lvlT,&treeDepth);
-        visited[visCnt++] = u;
-        PCU_ALWAYS_ASSERT(visCnt < maxVisited);
-        apf::Up edges;
-        m->getUp(u,edges);
-        for(int i=0; i<edges.n; i++) {
-          if( ! ce->count(edges.e[i]) ) 
-            continue; //not a cavity edge
-          apf::MeshEntity* v = 
-            apf::getEdgeVertOppositeVert(m,edges.e[i],u);
-          if( v != s && ! m->hasTag(v,lvlT) && ! cur.count(v) ) {
-            next.insert(v);
-            adjVtx[numAdj++] = v;
-          }
-        }
+  void getConnectedVtx(apf::Mesh* m, parma::VtxGraph& g,
+      parma::DijkstraContains* c, Verts& dist, int u, Verts& adjVtx) {
+    adjVtx.clear();
+    if( c->bdryHas(u) ) {
+      Verts adj;
+      int p = parentVtx(g,c,dist,u,adj);
+      if( p >= 0 ) {
+        Verts ce;
+        getCavityEdges(m,g,c,u,ce);
+        walkCavEdges(ce,p,u,adjVtx);
       }
     }
-    adjVtx.setSize(numAdj);
-    for(std::size_t i = 0; i<visCnt; i++) {
-      PCU_ALWAYS_ASSERT(m->hasTag(visited[i],lvlT));
-      m->removeTag(visited[i],lvlT);
+    if( adjVtx.empty() )
+      g.getAdjacent(u,adjVtx);
+  }
+}
+
+namespace parma {
+  VtxGraph::VtxGraph(apf::Mesh* mesh) : m(mesh) {
+    ids = m->createIntTag("parma_vtx_index",1);
+    verts.reserve(m->count(0));
+    apf::MeshEntity* v;
+    apf::MeshIterator* it = m->begin(0);
+    while( (v = m->iterate(it)) ) {
+      int i = size();
+      m->setIntTag(v,ids,&i);
+      verts.push_back(v);
     }
-    m->destroyTag(lvlT);
+    m->end(it);
+    first.assign(verts.size(), -1);
+    count.assign(verts.size(), 0);
   }
 
-  void getConnectedVtx(apf::Mesh* m, parma::DijkstraContains* c, 
-      apf::MeshTag* d, apf::MeshEntity* u, apf::Adjacent& adjVtx) {
-    if( c->bdryHas(u) ) {
-      apf::MeshEntity* p = parentVtx(m,c,d,u);
-      if( p ) {
-        apf::Up cav;
-        getCavity(m,u,cav);
-        CavEnts* ce = getCavityEdges(m,c,cav);
-        walkCavEdges(m,ce,p,u,adjVtx);
-        delete ce;
-      }
+  VtxGraph::~VtxGraph() {
+    apf::removeTagFromDimension(m,ids,0);
+    m->destroyTag(ids);
+  }
+
+  int VtxGraph::size() {
+    return TO_INT(verts.size());
+  }
+
+  int VtxGraph::index(apf::MeshEntity* v) {
+    int i; m->getIntTag(v,ids,&i);
+    return i;
+  }
+
+  void VtxGraph::getAdjacent(int i, std::vector<int>& adj) {
+    if( first[i] < 0 ) {
+      apf::Adjacent adjVtx;
+      getEdgeAdjVtx(m,verts[i],adjVtx);
+      first[i] = TO_INT(adjacent.size());
+      count[i] = TO_INT(adjVtx.getSize());
+      APF_ITERATE(apf::Adjacent, adjVtx, v)
+        adjacent.push_back(index(*v));
     }
-    if( !adjVtx.getSize() )
-      getEdgeAdjVtx(m,u,adjVtx); 
+    adj.assign(adjacent.begin() + first[i],
+        adjacent.begin() + first[i] + count[i]);
   }
 
-  void dijkstra_(apf::Mesh* m, parma::DijkstraContains* c,
-      parma::DistanceQueue<parma::Less>& pq, apf::MeshTag* d) {
-    while( !pq.empty() ) {
-      apf::MeshEntity* v = pq.pop();
+  void dijkstra(apf::Mesh* m, VtxGraph& g, DijkstraContains* c,
+      LevelQueue& q, std::vector<int>& dist) {
+    Verts adjVtx;
+    while( q.advance() ) {
+      int v = q.pop();
       if( ! c->has(v) ) continue;
-      int vd; m->getIntTag(v, d, &vd);
+      int vd = dist[v];
+      /* v was queued again closer to the sources */
+      if( vd != q.distance() ) continue;
       PCU_ALWAYS_ASSERT( vd >= 0 && vd != INT_MAX );
-      apf::Adjacent adjVtx;
-      getConnectedVtx(m,c,d,v,adjVtx);
-      APF_ITERATE(apf::Adjacent, adjVtx, eItr) {
-        apf::MeshEntity* u = *eItr;
-        int ud; m->getIntTag(u,d,&ud);
-        if( vd+1 < ud && c->has(u) ) {
-          int l = vd+1;
-          m->setIntTag(u,d,&l);
-          pq.push(u,l);
+      getConnectedVtx(m,g,c,dist,v,adjVtx);
+      for(size_t i=0; i<adjVtx.size(); i++) {
+        int u = adjVtx[i];
+        if( vd+1 < dist[u] && c->has(u) ) {
+          dist[u] = vd+1;
+          q.push(u,vd+1);
         }
       }
     }
   }
 }
-
-namespace parma {
-  void dijkstra(apf::Mesh* m, DijkstraContains* c,
-      apf::MeshEntity* src, apf::MeshTag* d) {
-    resetDist(m,c,d);
-    parma::DistanceQueue<parma::Less> pq(m);
-    int zero = 0;
-    m->setIntTag(src, d, &zero);
-    pq.push(src,zero);
-    dijkstra_(m,c,pq,d);
-  }
-  void dijkstra(apf::Mesh* m, DijkstraContains* c,
-      DistanceQueue<Less>& pq, apf::MeshTag* d) {
-    dijkstra_(m,c,pq,d);
-  }
-}
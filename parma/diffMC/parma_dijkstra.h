@@ -2,21 +2,41 @@
 #define PARMA_DIJKSTRA_H_
 
 #include <apfMesh.h>
-#include <set>
+#include <vector>
 #include "parma_distQ.h"
 
 namespace parma {
+  /* The vertices of the part numbered densely. The vertices sharing an
+     edge with a vertex are gathered the first time they are asked for
+     and kept as a flat row, in the order getEdgeAdjVtx gives them. */
+  class VtxGraph {
+    public:
+      VtxGraph(apf::Mesh* m);
+      ~VtxGraph();
+      int size();
+      int index(apf::MeshEntity* v);
+      apf::MeshEntity* vertex(int i) { return verts[i]; }
+      /* the indices of the vertices sharing an edge with vertex i */
+      void getAdjacent(int i, std::vector<int>& adj);
+    private:
+      apf::Mesh* m;
+      apf::MeshTag* ids;
+      std::vector<apf::MeshEntity*> verts;
+      std::vector<int> first;
+      std::vector<int> count;
+      std::vector<int> adjacent;
+  };
+
   class DijkstraContains {
     public:
       virtual ~DijkstraContains() {}
-      virtual bool has(apf::MeshEntity* e)=0;
-      virtual bool bdryHas(apf::MeshEntity* e)=0;
+      virtual bool has(int v)=0;
+      virtual bool bdryHas(int v)=0;
   };
 
-  void dijkstra(apf::Mesh* m, DijkstraContains* c,
-      apf::MeshEntity* src, apf::MeshTag* d);
-  void dijkstra(apf::Mesh* m, DijkstraContains* c,
-      parma::DistanceQueue<parma::Less>& pq, apf::MeshTag* d);
+  /* distances of the vertices in g, indexed the same way */
+  void dijkstra(apf::Mesh* m, VtxGraph& g, DijkstraContains* c,
+      LevelQueue& q, std::vector<int>& dist);
 }
 
 #endif
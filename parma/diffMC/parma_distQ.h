@@ -3,6 +3,8 @@
 
 #include <apfMesh.h>
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <pcu_util.h>
 
 namespace parma {
@@ -84,6 +86,69 @@ namespace parma {
       return rit;
     }
   };
+
+  /* A monotone bucket queue of dense vertex indices for unit edge
+     lengths. Sources may be pushed with any distance before the first
+     pop, after that every push is one more than the last pop. Each
+     level is a flat array and the sources are sorted once. */
+  class LevelQueue {
+    public:
+    LevelQueue() : at(0), next(0), lvl(0), started(false) {}
+
+    void push(int v, int dist)
+    {
+      if ( ! started ) {
+        sources.push_back(std::make_pair(dist, v));
+        return;
+      }
+      PCU_ALWAYS_ASSERT( dist == lvl + 1 );
+      upper.push_back(v);
+    }
+
+    /* advance to the next entry, false when the queue is empty */
+    bool advance()
+    {
+      if ( ! started ) {
+        started = true;
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()),
+            sources.end());
+      }
+      while ( at == level.size() ) {
+        if ( upper.empty() && next == sources.size() )
+          return false;
+        int l = upper.empty() ? sources[next].first : lvl + 1;
+        level.clear();
+        at = 0;
+        level.swap(upper);
+        lvl = l;
+        while ( next < sources.size() && sources[next].first == l )
+          level.push_back(sources[next++].second);
+      }
+      return true;
+    }
+
+    /* call after advance returned true */
+    int pop()
+    {
+      return level[at++];
+    }
+
+    /* the distance of the last pop */
+    int distance()
+    {
+      return lvl;
+    }
+
+    private:
+    std::vector<std::pair<int, int> > sources;
+    std::vector<int> level;
+    std::vector<int> upper;
+    size_t at;
+    size_t next;
+    int lvl;
+    bool started;
+  };
 }
 
 #endif
@@ -7,6 +7,7 @@
 #include "parma_targets.h"
 #include "parma_selector.h"
 #include "parma_commons.h"
+#include "parma_tracker.h"
 
 namespace {
   using parmaCommons::status;
@@ -20,14 +21,15 @@ namespace {
           parma::Sides* s = parma::makeVtxSides(mesh);
           sideTol = parma::avgSharedSides(s);
           delete s;
+          const int dims[1] = {mesh->getDimension()};
+          track(1, dims);
       }
       bool runStep(apf::MeshTag* wtag, double tolerance) {
-        const double maxElmImb =
-          Parma_GetWeightedEntImbalance(mesh, wtag, mesh->getDimension());
-        parma::Sides* s = parma::makeVtxSides(mesh);
+        parma::Sides* s = tracker->makeSides();
         double avgSides = parma::avgSharedSides(s);
-        parma::Weights* w =
-          parma::makeEntWeights(mesh, wtag, s, mesh->getDimension());
+        parma::Weights* w = tracker->makeWeights(s, mesh->getDimension());
+        double maxElmImb, avgElm;
+        parma::getImbalance(w, maxElmImb, avgElm);
         parma::Targets* t = parma::makeTargets(s, w, factor);
         parma::Selector* sel = parma::makeElmSelector(mesh, wtag);
 
@@ -38,7 +40,8 @@ namespace {
         parma::BalOrStall* stopper =
           new parma::BalOrStall(iA, sA, sideTol*.001, verbose);
 
-        parma::Stepper b(mesh, factor, s, w, t, sel, "elm", stopper);
+        parma::Stepper b(mesh, factor, s, w, t, sel, "elm", stopper,
+            tracker);
         return b.step(tolerance, verbose);
       }
   };
@@ -1,4 +1,5 @@
 #include <apf.h>
+#include <apfNumbering.h>
 #include <PCU.h>
 #include <pcu_util.h>
 #include "parma_graphDist.h"
@@ -9,21 +10,11 @@
 #include "parma_commons.h"
 #include <list>
 #include <set>
+#include <vector>
 #include <limits.h>
 #include <stdlib.h>
 
 namespace {
-  apf::MeshTag* initTag(apf::Mesh* m, const char* name,
-      int initVal=0, int dim=0) {
-    apf::MeshTag* t = m->createIntTag(name,1);
-    apf::MeshEntity* e;
-    apf::MeshIterator* it = m->begin(dim);
-    while( (e = m->iterate(it)) )
-      m->setIntTag(e,t,&initVal);
-    m->end(it);
-    return t;
-  }
-
   unsigned* getMaxDist(apf::Mesh* m, parma::dcComponents& c, apf::MeshTag* dt) {
     const unsigned check = m->getTagChecksum(dt,apf::Mesh::VERTEX);
     unsigned* rmax = new unsigned[c.size()];
@@ -101,7 +92,7 @@ namespace {
   }
 
 
-  class CompContains : public parma::DijkstraContains {
+  class CompContains {
     public:
       CompContains(parma::dcComponents& comps, unsigned compid)
         : c(comps), id(compid) {}
@@ -124,23 +115,69 @@ namespace {
       unsigned id;
   };
 
+  /* the same membership as CompContains on dense vertex indices */
+  class CompVtxContains : public parma::DijkstraContains {
+    public:
+      CompVtxContains(std::vector<int>& comps, std::vector<int>& bdrys,
+          int compid) : c(comps), b(bdrys), id(compid) {}
+      ~CompVtxContains() {}
+      bool has(int v) {
+        return ( c[v] == id || b[v] == id );
+      }
+      bool bdryHas(int v) {
+        return b[v] == id;
+      }
+    private:
+      std::vector<int>& c;
+      std::vector<int>& b;
+      int id;
+  };
+
   const char* distanceTagName() {
     return "parmaDistance";
   }
 
-  apf::MeshTag* createDistTag(apf::Mesh* m) {
-    int initVal = INT_MAX;
-    return initTag(m, distanceTagName(), initVal);
+  /* the distance tag is a view of the flat distance array */
+  void setDistances(parma::VtxGraph& g, std::vector<int>& dist,
+      apf::Mesh* m, apf::MeshTag* t) {
+    for(int i=0; i<g.size(); i++)
+      m->setIntTag(g.vertex(i),t,&(dist[i]));
   }
 
   apf::MeshTag* computeDistance(apf::Mesh* m, parma::dcComponents& c) {
-    apf::MeshTag* distT = createDistTag(m);
+    parma::VtxGraph g(m);
+    const int n = g.size();
+    std::vector<int> comp(n,-1);
+    std::vector<std::vector<int> > members(c.size());
+    for(int i=0; i<n; i++) {
+      apf::MeshEntity* v = g.vertex(i);
+      if( !c.has(v) ) continue;
+      comp[i] = TO_INT(c.getId(v));
+      members[comp[i]].push_back(i);
+    }
+    std::vector<int> bdry(n,-1);
+    std::vector<int> dist(n,INT_MAX);
     for(unsigned i=0; i<c.size(); i++) {
-      CompContains* contains = new CompContains(c,i);
-      apf::MeshEntity* src = c.getCore(i);
-      parma::dijkstra(m, contains, src, distT);
-      delete contains;
+      // each component starts over on its own vertices and boundary
+      apf::MeshEntity* v;
+      c.beginBdry(i);
+      while( (v = c.iterateBdry()) ) {
+        int b = g.index(v);
+        bdry[b] = TO_INT(i);
+        dist[b] = INT_MAX;
+      }
+      c.endBdry();
+      for(size_t j=0; j<members[i].size(); j++)
+        dist[members[i][j]] = INT_MAX;
+      CompVtxContains contains(comp,bdry,TO_INT(i));
+      int src = g.index(c.getCore(i));
+      dist[src] = 0;
+      parma::LevelQueue q;
+      q.push(src,0);
+      parma::dijkstra(m,g,&contains,q,dist);
     }
+    apf::MeshTag* distT = m->createIntTag(distanceTagName(),1);
+    setDistances(g,dist,m,distT);
     return distT;
   }
 
@@ -180,36 +217,33 @@ namespace {
    *   during the walks will have a INT_MAX distance which will bias diffusion
    *   to migrate the bounded cavities before other cavities.
    */
-  void getBdryVtx(apf::Mesh* m, apf::MeshTag* dist,
-      parma::DistanceQueue<parma::Less>& pq) {
-    int dmax = INT_MAX;
-    apf::MeshEntity* u;
-    apf::MeshIterator* it = m->begin(0);
-    while( (u = m->iterate(it)) ) {
+  void getBdryVtx(apf::Mesh* m, parma::VtxGraph& g,
+      std::vector<int>& dist, parma::LevelQueue& pq) {
+    for(int i=0; i<g.size(); i++) {
+      apf::MeshEntity* u = g.vertex(i);
       if( !m->isShared(u) && !onMdlBdry(m,u) ) continue;
-      m->setIntTag(u,dist,&dmax); // (1)
+      dist[i] = INT_MAX; // (1)
       apf::Adjacent verts;
       getElmAdjVtx(m,u,verts);
       APF_ITERATE(apf::Adjacent, verts, v) {
         if( !m->isShared(*v) && !onMdlBdry(m,*v) ) {
-          int vd; m->getIntTag(*v,dist,&vd);
-          if( vd == INT_MAX ) continue;
-          pq.push(*v,vd);
+          int j = g.index(*v);
+          if( dist[j] == INT_MAX ) continue;
+          pq.push(j,dist[j]);
         }
       }
     }
-    m->end(it);
   }
 
   class CompUpdateContains : public parma::DijkstraContains {
     public:
       CompUpdateContains() {}
       ~CompUpdateContains() {}
-      bool has(apf::MeshEntity*) {
+      bool has(int) {
         return true;
       }
       //disable the non-manifold boundary detection mechanism
-      bool bdryHas(apf::MeshEntity*) {
+      bool bdryHas(int) {
         return false;
       }
   };
@@ -217,10 +251,15 @@ namespace {
   apf::MeshTag* updateDistance(apf::Mesh* m) {
     PCU_Debug_Print("updateDistance\n");
     apf::MeshTag* dist = parma::getDistTag(m);
-    parma::DistanceQueue<parma::Less> pq(m);
-    getBdryVtx(m,dist,pq);
+    parma::VtxGraph g(m);
+    std::vector<int> d(g.size());
+    for(int i=0; i<g.size(); i++)
+      m->getIntTag(g.vertex(i),dist,&(d[i]));
+    parma::LevelQueue pq;
+    getBdryVtx(m,g,d,pq);
     CompUpdateContains c;
-    parma::dijkstra(m,&c,pq,dist);
+    parma::dijkstra(m,g,&c,pq,d);
+    setDistances(g,d,m,dist);
     return dist;
   }
 } //end namespace
@@ -235,7 +274,7 @@ namespace parma_ordering {
     return e;
   }
 
-  int bfs(apf::Mesh* m, parma::DijkstraContains* c,
+  int bfs(apf::Mesh* m, CompContains* c,
        apf::MeshEntity* src, apf::MeshTag* order, int num) {
     if( !src )
       return num;
@@ -406,3 +445,14 @@ apf::MeshTag* Parma_BfsReorder(apf::Mesh* m, int) {
   parmaCommons::printElapsedTime(__func__,PCU_Time()-t0);
   return order;
 }
+
+apf::MeshTag* Parma_Reorder(apf::Mesh* m, apf::Ordering o, int verbosity) {
+  if( o == apf::BREADTH_FIRST )
+    return Parma_BfsReorder(m,verbosity);
+  double t0 = PCU_Time();
+  parma_ordering::la(m);
+  apf::MeshTag* order = apf::orderVertices(m,o,"parma_ordering");
+  parma_ordering::la(m,order);
+  parmaCommons::printElapsedTime(__func__,PCU_Time()-t0);
+  return order;
+}
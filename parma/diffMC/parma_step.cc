@@ -6,6 +6,7 @@
 #include "parma_targets.h"
 #include "parma_selector.h"
 #include "parma_stop.h"
+#include "parma_tracker.h"
 #include "parma_commons.h"
 
 namespace parma {
@@ -13,9 +14,9 @@ namespace parma {
 
   Stepper::Stepper(apf::Mesh* mIn, double alphaIn,
      Sides* s, Weights* w, Targets* t, Selector* sel,
-     const char* entType, Stop* stopper)
+     const char* entType, Stop* stopper, Tracker* tracker)
     : m(mIn), alpha(alphaIn), sides(s), weights(w), targets(t),
-    selects(sel), name(entType), stop(stopper) {
+    selects(sel), name(entType), stop(stopper), track(tracker) {
       verbose = 0;
   }
 
@@ -37,7 +38,10 @@ namespace parma {
     apf::Migration* plan = selects->run(targets);
     int planSz = PCU_Add_Int(plan->count());
     const double t0 = PCU_Time();
-    m->migrate(plan);
+    if (track)
+      track->migrate(plan);
+    else
+      m->migrate(plan);
     if ( !PCU_Comm_Self() && verbosity )
       status("%d elements migrated in %f seconds\n", planSz, PCU_Time()-t0);
     if( verbosity > 1 ) 
@@ -9,11 +9,13 @@ namespace parma {
   class Weights;
   class Targets;
   class Selector;
+  class Tracker;
   class Stepper {
     public:
       Stepper(apf::Mesh* mIn, double alphaIn,
         Sides* s, Weights* w, Targets* t, Selector* sel,
-        const char* entType, Stop* stopper = new Less);
+        const char* entType, Stop* stopper = new Less,
+        Tracker* tracker = 0);
       virtual ~Stepper();
       bool step(double maxImb, int verbosity=0);
     private:
@@ -27,6 +29,7 @@ namespace parma {
       Selector* selects;
       const char* name;
       Stop* stop;
+      Tracker* track;
   };
 }
 #endif
@@ -0,0 +1,255 @@
+#include <PCU.h>
+#include <pcu_util.h>
+#include <apf.h>
+#include "parma_tracker.h"
+#include "parma_sides.h"
+#include "parma_weights.h"
+
+namespace {
+  class TrackedSides : public parma::Sides {
+    public:
+      TrackedSides(apf::Mesh* m, std::map<int, int> const& s, int total)
+        : Sides(m) {
+        std::map<int, int>::const_iterator it;
+        for (it = s.begin(); it != s.end(); ++it)
+          if (it->second > 0)
+            set(it->first, it->second);
+        totalSides = total;
+      }
+  };
+
+  class TrackedWeights : public parma::Weights {
+    public:
+      TrackedWeights(apf::Mesh* m, apf::MeshTag* w, parma::Sides* s,
+          double self)
+        : Weights(m, w, s), weight(self) {
+        init(s);
+      }
+      double self() {
+        return weight;
+      }
+    private:
+      double weight;
+      void init(parma::Sides* s) {
+        PCU_Comm_Begin();
+        const parma::Sides::Item* side;
+        s->begin();
+        while( (side = s->iterate()) )
+          PCU_COMM_PACK(side->first, weight);
+        s->end();
+        PCU_Comm_Send();
+        while (PCU_Comm_Listen()) {
+          double otherWeight;
+          PCU_COMM_UNPACK(otherWeight);
+          set(PCU_Comm_Sender(), otherWeight);
+        }
+      }
+  };
+}
+
+namespace parma {
+  Tracker::Tracker(apf::Mesh* m, apf::MeshTag* w, int n, const int dims[])
+    : mesh(m), wtag(w), totalSides(0), received(0)
+  {
+    const int dim = m->getDimension();
+    for (int d = 0; d < 4; ++d) {
+      tracks[d] = false;
+      weights[d] = 0;
+    }
+    for (int i = 0; i < n; ++i) {
+      PCU_ALWAYS_ASSERT(dims[i] >= 0 && dims[i] <= dim);
+      tracks[dims[i]] = true;
+    }
+    for (int d = 0; d < 4; ++d)
+      needs[d] = (d == 0 || tracks[d]);
+    affectedTag = m->createIntTag("parma_tracker_affected", 1);
+    sentTag = m->createIntTag("parma_tracker_sent", 1);
+    for (int d = 0; d <= dim; ++d) {
+      if (!needs[d])
+        continue;
+      apf::MeshIterator* it = m->begin(d);
+      apf::MeshEntity* e;
+      while ((e = m->iterate(it)))
+        count(e, d, 1);
+      m->end(it);
+    }
+  }
+
+  Tracker::~Tracker() {
+    mesh->destroyTag(affectedTag);
+    mesh->destroyTag(sentTag);
+  }
+
+  /* add or remove the part's share of e in the sides and weights */
+  void Tracker::count(apf::MeshEntity* e, int dim, int sign) {
+    if (tracks[dim])
+      weights[dim] += sign * getEntWeight(mesh, e, wtag);
+    if (dim == 0 && mesh->isShared(e)) {
+      apf::Copies rmts;
+      mesh->getRemotes(e, rmts);
+      APF_ITERATE(apf::Copies, rmts, r)
+        sides[r->first] += sign;
+      totalSides += sign;
+    }
+  }
+
+  /* whether e keeps an element on this part after the migration */
+  bool Tracker::stays(apf::MeshEntity* e) {
+    apf::Adjacent elms;
+    mesh->getAdjacent(e, mesh->getDimension(), elms);
+    for (size_t i = 0; i < elms.getSize(); ++i)
+      if (!mesh->hasTag(elms[i], sentTag))
+        return true;
+    return false;
+  }
+
+  /* e is new to this part */
+  void Tracker::arrive(apf::MeshEntity* e, int dim, Entities& verts) {
+    int dummy = 0;
+    mesh->setIntTag(e, affectedTag, &dummy);
+    touched.push_back(e);
+    count(e, dim, 1);
+    if (dim == 0)
+      verts.push_back(e);
+  }
+
+  /* elm was migrated here, count it and the new entities
+     of its closure */
+  void Tracker::receive(apf::MeshEntity* elm, Entities& verts) {
+    const int dim = mesh->getDimension();
+    mesh->removeTag(elm, sentTag);
+    ++received;
+    if (tracks[dim])
+      count(elm, dim, 1);
+    for (int d = 0; d < dim; ++d) {
+      if (!needs[d])
+        continue;
+      apf::Downward down;
+      int nd = mesh->getDownward(elm, d, down);
+      for (int i = 0; i < nd; ++i)
+        if (!mesh->hasTag(down[i], affectedTag))
+          arrive(down[i], d, verts);
+    }
+  }
+
+  void Tracker::migrate(apf::Migration* plan) {
+    const int dim = mesh->getDimension();
+    const int self = PCU_Comm_Self();
+    int dummy = 0;
+    /* the elements leaving this part and their closure, plus every
+       remote copy of that closure, lose their old contribution */
+    Entities affected[4];
+    for (int i = 0; i < plan->count(); ++i) {
+      apf::MeshEntity* e = plan->get(i);
+      if (plan->sending(e) == self)
+        continue;
+      mesh->setIntTag(e, sentTag, &dummy);
+      affected[dim].push_back(e);
+    }
+    long sent = static_cast<long>(affected[dim].size());
+    PCU_Comm_Begin();
+    for (int d = 0; d < dim; ++d) {
+      if (!needs[d])
+        continue;
+      APF_ITERATE(Entities, affected[dim], it) {
+        apf::Downward down;
+        int nd = mesh->getDownward(*it, d, down);
+        for (int i = 0; i < nd; ++i) {
+          if (mesh->hasTag(down[i], affectedTag))
+            continue;
+          mesh->setIntTag(down[i], affectedTag, &dummy);
+          affected[d].push_back(down[i]);
+          apf::Copies rmts;
+          mesh->getRemotes(down[i], rmts);
+          APF_ITERATE(apf::Copies, rmts, r)
+            PCU_COMM_PACK(r->first, r->second);
+        }
+      }
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      apf::MeshEntity* e;
+      PCU_COMM_UNPACK(e);
+      if (mesh->hasTag(e, affectedTag))
+        continue;
+      mesh->setIntTag(e, affectedTag, &dummy);
+      affected[apf::getDimension(mesh, e)].push_back(e);
+    }
+    /* the affected tag would travel with the migrated entities,
+       so it comes off here and goes back on what stays */
+    Entities kept;
+    for (int d = 0; d <= dim; ++d)
+      APF_ITERATE(Entities, affected[d], it) {
+        count(*it, d, -1);
+        if (d == dim)
+          continue;
+        mesh->removeTag(*it, affectedTag);
+        if (stays(*it))
+          kept.push_back(*it);
+      }
+    mesh->migrate(plan);
+    /* what stayed is counted again with its new remote copies,
+       and tells the new copies of its vertices where they are */
+    PCU_Comm_Begin();
+    APF_ITERATE(Entities, kept, it) {
+      mesh->setIntTag(*it, affectedTag, &dummy);
+      touched.push_back(*it);
+    }
+    Entities verts;
+    APF_ITERATE(Entities, kept, it) {
+      int d = apf::getDimension(mesh, *it);
+      count(*it, d, 1);
+      if (d != 0)
+        continue;
+      verts.push_back(*it);
+      apf::Copies rmts;
+      mesh->getRemotes(*it, rmts);
+      APF_ITERATE(apf::Copies, rmts, r)
+        PCU_COMM_PACK(r->first, r->second);
+    }
+    PCU_Comm_Send();
+    while (PCU_Comm_Receive()) {
+      apf::MeshEntity* v;
+      PCU_COMM_UNPACK(v);
+      if (!mesh->hasTag(v, affectedTag))
+        arrive(v, 0, verts);
+    }
+    /* the migrated elements still carry the sent tag, walk them
+       from the known vertices */
+    for (size_t i = 0; i < verts.size(); ++i) {
+      apf::Adjacent elms;
+      mesh->getAdjacent(verts[i], dim, elms);
+      for (size_t j = 0; j < elms.getSize(); ++j)
+        if (mesh->hasTag(elms[j], sentTag))
+          receive(elms[j], verts);
+    }
+    /* a migrated piece touching no other copy is only found by a
+       sweep, which takes a whole mesh component moving at once */
+    if (PCU_Add_Long(sent) != PCU_Add_Long(received)) {
+      apf::MeshIterator* it = mesh->begin(dim);
+      apf::MeshEntity* e;
+      while ((e = mesh->iterate(it)))
+        if (mesh->hasTag(e, sentTag))
+          receive(e, verts);
+      mesh->end(it);
+    }
+    APF_ITERATE(Entities, touched, it)
+      mesh->removeTag(*it, affectedTag);
+    touched.clear();
+    received = 0;
+  }
+
+  Sides* Tracker::makeSides() {
+    return new TrackedSides(mesh, sides, totalSides);
+  }
+
+  Weights* Tracker::makeWeights(Sides* s, int dim) {
+    PCU_ALWAYS_ASSERT(tracks[dim]);
+    return new TrackedWeights(mesh, wtag, s, weights[dim]);
+  }
+
+  double Tracker::weight(int dim) {
+    PCU_ALWAYS_ASSERT(tracks[dim]);
+    return weights[dim];
+  }
+}
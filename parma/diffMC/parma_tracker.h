@@ -0,0 +1,46 @@
+#ifndef PARMA_TRACKER_H
+#define PARMA_TRACKER_H
+#include <apfMesh.h>
+#include <map>
+#include <vector>
+
+namespace parma {
+  class Sides;
+  class Weights;
+  /* Keeps the vertex sides and the entity weights of the part current
+     across diffusive steps. The mesh is swept once on construction,
+     then each migration only visits the closure of the elements it
+     moves and the remote copies of that closure. */
+  class Tracker {
+    public:
+      /* track the weights of entities of dimension dims[0..n) */
+      Tracker(apf::Mesh* m, apf::MeshTag* w, int n, const int dims[]);
+      ~Tracker();
+      /* migrate the mesh and update the sides and weights */
+      void migrate(apf::Migration* plan);
+      /* the same sides as makeVtxSides */
+      Sides* makeSides();
+      /* the same weights as makeEntWeights, dim must be tracked */
+      Weights* makeWeights(Sides* s, int dim);
+      double weight(int dim);
+    private:
+      Tracker();
+      typedef std::vector<apf::MeshEntity*> Entities;
+      void count(apf::MeshEntity* e, int dim, int sign);
+      bool stays(apf::MeshEntity* e);
+      void arrive(apf::MeshEntity* e, int dim, Entities& verts);
+      void receive(apf::MeshEntity* elm, Entities& verts);
+      apf::Mesh* mesh;
+      apf::MeshTag* wtag;
+      apf::MeshTag* affectedTag;
+      apf::MeshTag* sentTag;
+      bool tracks[4];
+      bool needs[4];
+      double weights[4];
+      std::map<int, int> sides;
+      int totalSides;
+      Entities touched;
+      long received;
+  };
+}
+#endif
@@ -11,6 +11,7 @@
 #include "parma_graphDist.h"
 #include "parma_commons.h"
 #include "parma_convert.h"
+#include "parma_tracker.h"
 
 namespace {
   using parmaCommons::status;
@@ -26,13 +27,15 @@ namespace {
           delete s;
           if( !PCU_Comm_Self() && verbose )
             status("sideTol %d\n", sideTol);
+          const int dims[1] = {0};
+          track(1, dims);
       }
 
       bool runStep(apf::MeshTag* wtag, double tolerance) {
-        const double maxVtxImb =
-          Parma_GetWeightedEntImbalance(mesh, wtag, 0);
-        parma::Sides* s = parma::makeVtxSides(mesh);
-        parma::Weights* w = parma::makeEntWeights(mesh, wtag, s, 0);
+        parma::Sides* s = tracker->makeSides();
+        parma::Weights* w = tracker->makeWeights(s, 0);
+        double maxVtxImb, avgVtx;
+        parma::getImbalance(w, maxVtxImb, avgVtx);
         parma::Targets* t =
           parma::makeWeightSideTargets(s, w, sideTol, factor);
         parma::Selector* sel = parma::makeVtxSelector(mesh, wtag);
@@ -43,7 +46,8 @@ namespace {
           status("vtxImb %f avgSides %f\n", maxVtxImb, avgSides);
         parma::BalOrStall* stopper = 
           new parma::BalOrStall(iA, sA, sideTol*.001, verbose);
-        parma::Stepper b(mesh, factor, s, w, t, sel, "vtx", stopper);
+        parma::Stepper b(mesh, factor, s, w, t, sel, "vtx", stopper,
+            tracker);
         return b.step(tolerance, verbose);
       }
   };
@@ -10,6 +10,7 @@
 #include "parma_monitor.h"
 #include "parma_commons.h"
 #include "parma_convert.h"
+#include "parma_tracker.h"
 
 namespace {
   using parmaCommons::status;
@@ -31,18 +32,18 @@ namespace {
           delete s;
           if( !PCU_Comm_Self() && verbose )
             status("sideTol %d\n", sideTol);
+          const int dims[2] = {0, mesh->getDimension()};
+          track(2, dims);
       }
       bool runStep(apf::MeshTag* wtag, double tolerance) {
-        const double maxVtxImb =
-          Parma_GetWeightedEntImbalance(mesh, wtag, 0);
-        const double maxElmImb =
-          Parma_GetWeightedEntImbalance(mesh, wtag, mesh->getDimension());
+        parma::Sides* s = tracker->makeSides();
+        parma::Weights* vtxW = tracker->makeWeights(s, 0);
+        parma::Weights* elmW = tracker->makeWeights(s, mesh->getDimension());
+        double maxVtxImb, maxElmImb, avg;
+        parma::getImbalance(vtxW, maxVtxImb, avg);
+        parma::getImbalance(elmW, maxElmImb, avg);
         if( !PCU_Comm_Self() && verbose )
           status("vtx imbalance %.3f\n", maxVtxImb);
-        parma::Sides* s = parma::makeVtxSides(mesh);
-        parma::Weights* vtxW = parma::makeEntWeights(mesh, wtag, s, 0);
-        parma::Weights* elmW =
-          parma::makeEntWeights(mesh, wtag, s, mesh->getDimension());
         parma::Targets* t =
           parma::makePreservingTargets(s, elmW, vtxW, sideTol, maxVtx, factor);
         delete vtxW;
@@ -57,7 +58,8 @@ namespace {
         parma::BalOrStall* stopper =
           new parma::BalOrStall(iA, sA, sideTol*.001, verbose);
 
-        parma::Stepper b(mesh, factor, s, elmW, t, sel, "elm", stopper);
+        parma::Stepper b(mesh, factor, s, elmW, t, sel, "elm", stopper,
+            tracker);
         return b.step(tolerance, verbose);
       }
   };
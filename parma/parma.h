@@ -13,6 +13,7 @@
 
 #include "apf.h"
 #include "apfPartition.h"
+#include "apfNumbering.h"
 
 /**
  * @brief get entity imbalance
@@ -276,6 +277,31 @@ apf::Balancer* Parma_MakeVtxElmBalancer(apf::Mesh* m,
  */
 apf::Splitter* Parma_MakeRibSplitter(apf::Mesh* m, bool sync = true);
 
+/**
+ * @brief create an APF Splitter using recursive inertial bisection
+ *        of the whole distributed mesh
+ * @details every rank keeps its elements in place while all ranks
+ *          compute the cuts together, so the result depends on the
+ *          global element distribution rather than on the input
+ *          partition. The split(weights, tolerance, multiple) call
+ *          yields multiple*PCU_Comm_Peers() parts of equal weight,
+ *          any multiple is accepted, and the plan sends each element
+ *          to its global part id. Unlike the apf::Splitter default of
+ *          local ids in [0, multiple), these are the part ids of the
+ *          mesh after expanding it by multiple, which puts part p at
+ *          p * multiple, as Parma_MakeRibSplitter does with sync on.
+ *          With a multiple of one the plan goes straight to
+ *          apf::Mesh2::migrate, otherwise to apf::repeatMdsMesh
+ *          with the multiple as its factor.
+ *          Medians are found by distributed histogram selection,
+ *          no rank ever sorts the global set.
+ *          The tolerance argument of split is ignored: every cut
+ *          splits the weight exactly, up to one element per cut.
+ * @param m (In) partitioned mesh
+ * @return apf splitter instance
+ */
+apf::Splitter* Parma_MakeGlobalRibSplitter(apf::Mesh* m);
+
 /**
  * @brief create a mesh tag that weighs elements by their memory consumption
  * @param m (In) partitioned mesh
@@ -348,4 +374,16 @@ int Parma_MisNumbering(apf::Mesh* m, int d);
  */
 apf::MeshTag* Parma_BfsReorder(apf::Mesh* m, int verbosity=0);
 
+/**
+ * @brief reorder the mesh vertices with one of the apf::Ordering schemes
+ * @remark BREADTH_FIRST is the same as Parma_BfsReorder, the others
+ *         use apf::orderVertices; the returned tag can be passed to
+ *         apf::reorderMdsMesh
+ * @param m (In) partitioned mesh
+ * @param o (In) ordering scheme
+ * @param verbosity (In) output control, higher values output more
+ * @return apf mesh tag
+ */
+apf::MeshTag* Parma_Reorder(apf::Mesh* m, apf::Ordering o, int verbosity=0);
+
 #endif
@@ -0,0 +1,331 @@
+#include <PCU.h>
+#include "parma_rib.h"
+#include <apfPartition.h>
+#include <apfMesh.h>
+#include <apf2mth.h>
+#include <mth_def.h>
+#include <pcu_util.h>
+#include <lionPrint.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+/* Recursive inertial bisection of the whole distributed mesh.
+
+   Elements never move while the cuts are computed: every rank keeps
+   its own centroids and all ranks walk the same tree of bisection
+   tasks, one level at a time. Each level takes a handful of
+   reductions whose size is the number of tasks on that level, so
+   memory and time per rank follow the local element count.
+
+   A task covering n parts is cut into n/2 and n - n/2 parts with
+   the mass split in that ratio, so any part count works. The cut
+   is found by narrowing a histogram of the projections onto the
+   inertial axis rather than by sorting. Bodies left in the final
+   bin are handed out in rank order with an exclusive scan, which
+   makes the split exact even when many centroids project onto the
+   same point. */
+
+namespace parma {
+
+namespace {
+
+/* a set of parts still to be cut, the bodies of this rank
+   in it are order[begin,end) */
+struct Task
+{
+  size_t begin;
+  size_t end;
+  int part;
+  int parts;
+};
+
+/* histogram bins per narrowing step and the cap on steps */
+int const ribBins = 16;
+int const ribMaxSteps = 12;
+/* stop narrowing once the mass in the final bin is
+   below this fraction of one part's mass */
+double const ribBinTolerance = 1e-3;
+
+class GlobalRib
+{
+  public:
+    GlobalRib(apf::Mesh* m, apf::MeshTag* weights):
+      mesh(m)
+    {
+      int dim = m->getDimension();
+      size_t n = m->count(dim);
+      elements.reserve(n);
+      bodies.reserve(n);
+      apf::MeshIterator* it = m->begin(dim);
+      apf::MeshEntity* e;
+      while ((e = m->iterate(it))) {
+        Body b;
+        b.point = apf::to_mth(apf::getLinearCentroid(m, e));
+        b.mass = 1;
+        if (weights)
+          m->getDoubleTag(e, weights, &b.mass);
+        bodies.push_back(b);
+        elements.push_back(e);
+      }
+      m->end(it);
+      order.resize(n);
+      for (size_t i = 0; i < n; ++i)
+        order[i] = i;
+      projection.resize(n);
+    }
+    /* self is the part id of this rank in the output numbering,
+       elements planned for it stay */
+    apf::Migration* run(int parts, int self)
+    {
+      std::vector<Task> tasks(1);
+      tasks[0].begin = 0;
+      tasks[0].end = order.size();
+      tasks[0].part = 0;
+      tasks[0].parts = parts;
+      while (true) {
+        std::vector<Task> active;
+        std::vector<Task> next;
+        for (size_t i = 0; i < tasks.size(); ++i)
+          if (tasks[i].parts > 1)
+            active.push_back(tasks[i]);
+          else
+            next.push_back(tasks[i]);
+        if (active.empty())
+          break;
+        bisectAll(active, next);
+        tasks.swap(next);
+      }
+      apf::Migration* plan = new apf::Migration(mesh);
+      for (size_t i = 0; i < tasks.size(); ++i)
+        for (size_t j = tasks[i].begin; j < tasks[i].end; ++j)
+          if (tasks[i].part != self)
+            plan->send(elements[order[j]], tasks[i].part);
+      return plan;
+    }
+  private:
+    void getCenters(std::vector<Task> const& t,
+        std::vector<double>& mass, std::vector<mth::Vector3<double> >& c)
+    {
+      size_t n = t.size();
+      std::vector<double> sums(4 * n, 0.0);
+      for (size_t a = 0; a < n; ++a)
+        for (size_t j = t[a].begin; j < t[a].end; ++j) {
+          Body const& b = bodies[order[j]];
+          sums[4 * a] += b.mass;
+          for (int d = 0; d < 3; ++d)
+            sums[4 * a + 1 + d] += b.mass * b.point[d];
+        }
+      PCU_Add_Doubles(&sums[0], sums.size());
+      mass.resize(n);
+      c.resize(n);
+      for (size_t a = 0; a < n; ++a) {
+        mass[a] = sums[4 * a];
+        for (int d = 0; d < 3; ++d)
+          c[a][d] = mass[a] > 0 ? sums[4 * a + 1 + d] / mass[a] : 0;
+      }
+    }
+    void getNormals(std::vector<Task> const& t,
+        std::vector<mth::Vector3<double> > const& c,
+        std::vector<mth::Vector3<double> >& normals)
+    {
+      size_t n = t.size();
+      std::vector<double> sums(9 * n, 0.0);
+      for (size_t a = 0; a < n; ++a)
+        for (size_t j = t[a].begin; j < t[a].end; ++j) {
+          Body const& b = bodies[order[j]];
+          mth::Matrix3x3<double> x = mth::cross(b.point - c[a]);
+          x = x * x * -(b.mass);
+          for (unsigned r = 0; r < 3; ++r)
+            for (unsigned s = 0; s < 3; ++s)
+              sums[9 * a + 3 * r + s] += x(r, s);
+        }
+      PCU_Add_Doubles(&sums[0], sums.size());
+      normals.resize(n);
+      for (size_t a = 0; a < n; ++a) {
+        mth::Matrix3x3<double> im;
+        for (unsigned r = 0; r < 3; ++r)
+          for (unsigned s = 0; s < 3; ++s)
+            im(r, s) = sums[9 * a + 3 * r + s];
+        getWeakestEigenvector(im, normals[a]);
+      }
+    }
+    /* narrow [lo[a],hi[a]) until it holds little mass,
+       starting from the range of the projections */
+    void findCuts(std::vector<Task> const& t,
+        std::vector<double> const& target, std::vector<double> const& tol,
+        std::vector<double>& lo, std::vector<double>& hi)
+    {
+      size_t n = t.size();
+      lo.assign(n, DBL_MAX);
+      hi.assign(n, DBL_MAX);
+      std::vector<double> maxs(n, -DBL_MAX);
+      for (size_t a = 0; a < n; ++a)
+        for (size_t j = t[a].begin; j < t[a].end; ++j) {
+          double p = projection[order[j]];
+          lo[a] = std::min(lo[a], p);
+          maxs[a] = std::max(maxs[a], p);
+        }
+      PCU_Min_Doubles(&lo[0], n);
+      PCU_Max_Doubles(&maxs[0], n);
+      std::vector<bool> done(n, false);
+      std::vector<double> below(n, 0.0);
+      for (size_t a = 0; a < n; ++a) {
+        hi[a] = std::nextafter(maxs[a], DBL_MAX);
+        done[a] = !(maxs[a] > lo[a]);
+      }
+      std::vector<double> hist(ribBins * n);
+      for (int step = 0; step < ribMaxSteps; ++step) {
+        if (std::find(done.begin(), done.end(), false) == done.end())
+          break;
+        std::fill(hist.begin(), hist.end(), 0.0);
+        for (size_t a = 0; a < n; ++a) {
+          if (done[a])
+            continue;
+          double w = (hi[a] - lo[a]) / ribBins;
+          for (size_t j = t[a].begin; j < t[a].end; ++j) {
+            double p = projection[order[j]];
+            if (p < lo[a] || p >= hi[a])
+              continue;
+            int b = std::min(ribBins - 1, (int)((p - lo[a]) / w));
+            hist[ribBins * a + b] += bodies[order[j]].mass;
+          }
+        }
+        PCU_Add_Doubles(&hist[0], hist.size());
+        for (size_t a = 0; a < n; ++a) {
+          if (done[a])
+            continue;
+          double w = (hi[a] - lo[a]) / ribBins;
+          int b = 0;
+          while (b < ribBins - 1 &&
+                 below[a] + hist[ribBins * a + b] < target[a]) {
+            below[a] += hist[ribBins * a + b];
+            ++b;
+          }
+          double newLo = lo[a] + b * w;
+          if (b < ribBins - 1)
+            hi[a] = lo[a] + (b + 1) * w;
+          lo[a] = newLo;
+          done[a] = hist[ribBins * a + b] <= tol[a] ||
+            !(hi[a] > lo[a]) || std::nextafter(lo[a], DBL_MAX) >= hi[a];
+        }
+      }
+    }
+    void bisectAll(std::vector<Task> const& t, std::vector<Task>& out)
+    {
+      size_t n = t.size();
+      std::vector<double> mass;
+      std::vector<mth::Vector3<double> > c;
+      getCenters(t, mass, c);
+      std::vector<mth::Vector3<double> > normals;
+      getNormals(t, c, normals);
+      for (size_t a = 0; a < n; ++a)
+        for (size_t j = t[a].begin; j < t[a].end; ++j)
+          projection[order[j]] = (bodies[order[j]].point - c[a]) * normals[a];
+      std::vector<double> target(n);
+      std::vector<double> tol(n);
+      for (size_t a = 0; a < n; ++a) {
+        target[a] = mass[a] * (t[a].parts / 2) / t[a].parts;
+        tol[a] = ribBinTolerance * mass[a] / t[a].parts;
+      }
+      std::vector<double> lo, hi;
+      findCuts(t, target, tol, lo, hi);
+      /* the exact mass below each cut, and this rank's
+         offset into the mass inside the final bins */
+      std::vector<double> sums(2 * n, 0.0);
+      for (size_t a = 0; a < n; ++a)
+        for (size_t j = t[a].begin; j < t[a].end; ++j) {
+          double p = projection[order[j]];
+          if (p < lo[a])
+            sums[a] += bodies[order[j]].mass;
+          else if (p < hi[a])
+            sums[n + a] += bodies[order[j]].mass;
+        }
+      std::vector<double> offsets(sums.begin() + n, sums.end());
+      PCU_Add_Doubles(&sums[0], n);
+      PCU_Exscan_Doubles(&offsets[0], n);
+      for (size_t a = 0; a < n; ++a) {
+        double need = target[a] - sums[a];
+        double taken = offsets[a];
+        std::vector<size_t>::iterator mid = std::stable_partition(
+            order.begin() + t[a].begin, order.begin() + t[a].end,
+            GoesLeft(this, lo[a], hi[a], need, taken));
+        Task left = t[a];
+        Task right = t[a];
+        left.end = mid - order.begin();
+        left.parts = t[a].parts / 2;
+        right.begin = left.end;
+        right.part = t[a].part + left.parts;
+        right.parts = t[a].parts - left.parts;
+        out.push_back(left);
+        out.push_back(right);
+      }
+    }
+    /* stable_partition visits bodies in order, so bodies in the
+       final bin go left while the mass taken stays below need */
+    struct GoesLeft
+    {
+      GoesLeft(GlobalRib* r, double l, double h, double n, double& t):
+        rib(r), lo(l), hi(h), need(n), taken(t) {}
+      bool operator()(size_t i)
+      {
+        double p = rib->projection[i];
+        if (p < lo)
+          return true;
+        if (p >= hi)
+          return false;
+        bool left = taken < need;
+        taken += rib->bodies[i].mass;
+        return left;
+      }
+      GlobalRib* rib;
+      double lo;
+      double hi;
+      double need;
+      double& taken;
+    };
+    apf::Mesh* mesh;
+    std::vector<Body> bodies;
+    std::vector<apf::MeshEntity*> elements;
+    std::vector<size_t> order;
+    std::vector<double> projection;
+};
+
+class GlobalRibSplitter : public apf::Splitter
+{
+  public:
+    GlobalRibSplitter(apf::Mesh* m):
+      mesh(m)
+    {
+    }
+    virtual ~GlobalRibSplitter() {}
+    /* the cuts are exact, so there is no tolerance to honor.
+       part ids are those of the mesh after expanding it by
+       multiple, where this part becomes part id * multiple,
+       as with the synchronized RibSplitter */
+    virtual apf::Migration* split(apf::MeshTag* weights, double,
+        int multiple)
+    {
+      double t0 = PCU_Time();
+      int parts = multiple * PCU_Comm_Peers();
+      GlobalRib rib(mesh, weights);
+      apf::Migration* plan = rib.run(parts, mesh->getId() * multiple);
+      double t1 = PCU_Time();
+      if (!PCU_Comm_Self())
+        lion_oprint(1,"planned global RIB into %d parts in %f seconds\n",
+            parts, t1 - t0);
+      return plan;
+    }
+  private:
+    apf::Mesh* mesh;
+};
+
+}
+
+}
+
+apf::Splitter* Parma_MakeGlobalRibSplitter(apf::Mesh* m)
+{
+  return new parma::GlobalRibSplitter(m);
+}
@@ -2,6 +2,7 @@
 #define PARMA_RIB_H
 
 #include <mthVector.h>
+#include <mthMatrix.h>
 
 namespace parma {
 
@@ -24,6 +25,11 @@ void bisect(Bodies* all, Bodies* left, Bodies* right);
 
 void recursivelyBisect(Bodies* all, int depth, Bodies out[]);
 
+/* the eigenvector of the smallest eigenvalue of an inertia matrix,
+   the normal of the plane that bisects along the longest axis */
+void getWeakestEigenvector(mth::Matrix3x3<double> const& A,
+    mth::Vector3<double>& v);
+
 }
 
 #endif
@@ -51,6 +51,33 @@ PCU_Comm_Unpack(&(object),sizeof(object))
   above API on/off*/
 void PCU_Comm_Order(bool on);
 
+/*turns node-aware aggregation of the
+  above API on/off*/
+void PCU_Comm_Aggregate(bool on);
+
+/*persistent neighbor exchange API*/
+struct pcu_plan;
+struct pcu_plan* PCU_Plan_New(int npeers, const int* peers);
+void PCU_Plan_Free(struct pcu_plan* p);
+int PCU_Plan_Peers(struct pcu_plan* p);
+int PCU_Plan_Peer(struct pcu_plan* p, int i);
+int PCU_Plan_Find(struct pcu_plan* p, int rank);
+void PCU_Plan_Begin(struct pcu_plan* p);
+void* PCU_Plan_Buffer(struct pcu_plan* p, int i, size_t size);
+int PCU_Plan_Pack(struct pcu_plan* p, int to_rank,
+    const void* data, size_t size);
+#define PCU_PLAN_PACK(p,to_rank,object)\
+PCU_Plan_Pack(p,to_rank,&(object),sizeof(object))
+int PCU_Plan_Send(struct pcu_plan* p);
+bool PCU_Plan_Receive(struct pcu_plan* p);
+bool PCU_Plan_Listen(struct pcu_plan* p);
+int PCU_Plan_Sender(struct pcu_plan* p);
+bool PCU_Plan_Unpacked(struct pcu_plan* p);
+int PCU_Plan_Unpack(struct pcu_plan* p, void* data, size_t size);
+void* PCU_Plan_Extract(struct pcu_plan* p, size_t size);
+#define PCU_PLAN_UNPACK(p,object)\
+PCU_Plan_Unpack(p,&(object),sizeof(object))
+
 /*collective operations*/
 void PCU_Barrier(void);
 void PCU_Add_Doubles(double* p, size_t n);
@@ -67,6 +94,7 @@ void PCU_Exscan_Ints(int* p, size_t n);
 int PCU_Exscan_Int(int x);
 void PCU_Exscan_Longs(long* p, size_t n);
 long PCU_Exscan_Long(long x);
+void PCU_Exscan_Doubles(double* p, size_t n);
 void PCU_Add_SizeTs(size_t* p, size_t n);
 size_t PCU_Add_SizeT(size_t x);
 void PCU_Min_SizeTs(size_t* p, size_t n);
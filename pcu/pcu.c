@@ -35,6 +35,7 @@
 #include "pcu_msg.h"
 #include "pcu_pmpi.h"
 #include "pcu_order.h"
+#include "pcu_node.h"
 #include "noto_malloc.h"
 #include "reel.h"
 #include <sys/types.h> /*required for mode_t for mkdir on some systems*/
@@ -82,6 +83,8 @@ int PCU_Comm_Free(void)
     reel_fail("Comm_Free called before Comm_Init");
   if (global_pmsg.order)
     pcu_order_free(global_pmsg.order);
+  if (global_pmsg.node)
+    pcu_node_free(global_pmsg.node);
   pcu_free_msg(&global_pmsg);
   pcu_pmpi_finalize();
   global_state = uninit;
@@ -245,6 +248,32 @@ void PCU_Comm_Order(bool on)
   }
 }
 
+/** \brief Turns node-aware message aggregation on or off.
+  \details When on, messages of a communication phase that go between
+  shared-memory nodes are bundled per destination node and forwarded
+  through one leader rank on each node, which cuts the number of
+  network messages when many ranks per node exchange small payloads.
+  Large messages and messages within a node are still sent directly.
+  It is off by default, and the packing and receiving API
+  is the same either way.
+  Setting the environment variable PCU_RANKS_PER_NODE to n groups
+  consecutive ranks n at a time instead of by shared memory,
+  which lets tests exercise the bundling on a single node.
+  This call is collective and should be made outside of a phase.
+ */
+void PCU_Comm_Aggregate(bool on)
+{
+  if (global_state == uninit)
+    reel_fail("Comm_Aggregate called before Comm_Init");
+  pcu_msg* m = get_msg();
+  if (on && (!m->node))
+    m->node = pcu_node_new(pcu_pmpi_comm());
+  if ((!on) && m->node) {
+    pcu_node_free(m->node);
+    m->node = NULL;
+  }
+}
+
 /** \brief Blocking barrier over all threads. */
 void PCU_Barrier(void)
 {
@@ -442,6 +471,22 @@ long PCU_Exscan_Long(long x)
   return a[0];
 }
 
+/** \brief See PCU_Exscan_Ints */
+void PCU_Exscan_Doubles(double* p, size_t n)
+{
+  if (global_state == uninit)
+    reel_fail("Exscan_Doubles called before Comm_Init");
+  if (n > (size_t)INT_MAX)
+    reel_fail("Exscan_Doubles given more than INT_MAX values");
+  /* subtracting from an inclusive scan would leave rounding
+     error behind, so use the exclusive scan directly */
+  MPI_Exscan(MPI_IN_PLACE,p,(int)n,MPI_DOUBLE,MPI_SUM,pcu_coll_comm);
+  /* MPI leaves the first rank's values undefined */
+  if (pcu_mpi_rank() == 0)
+    for (size_t i=0; i < n; ++i)
+      p[i] = 0;
+}
+
 /** \brief Performs an Allreduce minimum of int arrays.
   */
 void PCU_Min_Ints(int* p, size_t n)
@@ -748,6 +793,11 @@ void PCU_Switch_Comm(MPI_Comm new_comm)
   if (global_state == uninit)
     reel_fail("Switch_Comm called before Comm_Init");
   pcu_pmpi_switch(new_comm);
+  pcu_msg* m = get_msg();
+  if (m->node) {
+    pcu_node_free(m->node);
+    m->node = pcu_node_new(new_comm);
+  }
 }
 
 /** \brief Return the current MPI communicator
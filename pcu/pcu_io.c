@@ -23,133 +23,301 @@
 #include <bzlib.h>
 #endif
 
+#ifdef PCU_ZSTD
+#include <zstd.h>
+#endif
+
+typedef struct pcu_codec pcu_codec;
+
 typedef struct pcu_file {
   FILE* f;
-#ifdef PCU_BZIP
-  BZFILE* bzf;
-#endif
+  pcu_codec const* codec;
+  void* state;
   bool write;
-  bool compress;
+  /* shared files are buffered in memory and moved
+     to or from disk with collective MPI-IO */
+  char* shared;
+  pcu_buffer mem;
 } pcu_file;
 
-#ifdef PCU_BZIP
+/* a compressed format layered over the FILE of a pcu_file */
+struct pcu_codec {
+  void (*open)(pcu_file* pf);
+  void (*read)(pcu_file* pf, void* data, size_t size);
+  void (*write)(pcu_file* pf, void const* data, size_t size);
+  void (*close)(pcu_file* pf);
+};
 
-static void open_compressed_read(pcu_file* pf)
+static int compression_level = 1;
+static int compression_threads = 0;
+
+void pcu_set_compression(int level, int threads)
 {
-  int bzerror;
-  int verbosity = 0;
-  int small = 0;
-  void* unused = NULL;
-  int nUnused = 0;
-  pf->bzf = BZ2_bzReadOpen(&bzerror, pf->f, verbosity, small, unused, nUnused);
-  if (bzerror != BZ_OK)
-    reel_fail("BZ2_bzReadOpen failed with code %d", bzerror);
+  compression_level = level;
+  compression_threads = threads;
 }
 
-static void open_compressed_write(pcu_file* pf)
+static void raw_read(pcu_file* pf, void* data, size_t size)
 {
-  int bzerror;
-  int verbosity = 0;
-  int blockSize100k = 9;
-  int workFactor = 30;
-  pf->bzf = BZ2_bzWriteOpen(&bzerror, pf->f, blockSize100k, verbosity, workFactor);
-  if (bzerror != BZ_OK)
-    reel_fail("BZ2_bzWriteOpen failed with code %d", bzerror);
+  if (size != fread(data, 1, size, pf->f))
+    reel_fail("fread(%p, 1, %lu, %p) failed", data, size, (void*) pf->f);
 }
 
-static void open_compressed(pcu_file* pf)
+static void raw_write(pcu_file* pf, void const* data, size_t size)
 {
-  if (pf->write)
-    open_compressed_write(pf);
-  else
-    open_compressed_read(pf);
+  if (size != fwrite(data, 1, size, pf->f))
+    reel_fail("fwrite(%p, 1, %lu, %p) failed", data, size, (void*) pf->f);
+}
+
+static const uint16_t pcu_endian_value = 1;
+#define PCU_ENDIANNESS ((*((uint8_t*)(&pcu_endian_value)))==1)
+#define PCU_BIG_ENDIAN 0
+#define PCU_ENCODED_ENDIAN PCU_BIG_ENDIAN //consistent with network byte order
+
+static void pcu_swap_32(uint32_t* p);
+
+#ifdef PCU_BZIP
+
+static void bzip2_open(pcu_file* pf)
+{
+  int bzerror;
+  int verbosity = 0;
+  if (pf->write) {
+    int blockSize100k = 9;
+    int workFactor = 30;
+    pf->state = BZ2_bzWriteOpen(&bzerror, pf->f, blockSize100k, verbosity,
+        workFactor);
+    if (bzerror != BZ_OK)
+      reel_fail("BZ2_bzWriteOpen failed with code %d", bzerror);
+  } else {
+    int small = 0;
+    void* unused = NULL;
+    int nUnused = 0;
+    pf->state = BZ2_bzReadOpen(&bzerror, pf->f, verbosity, small, unused,
+        nUnused);
+    if (bzerror != BZ_OK)
+      reel_fail("BZ2_bzReadOpen failed with code %d", bzerror);
+  }
 }
 
-static void compressed_read(pcu_file* pf, void* data, size_t size)
+/* bzip2 counts bytes in ints, so big requests go in pieces */
+static void bzip2_read(pcu_file* pf, void* data, size_t size)
 {
   int bzerror;
   int len;
   int rv;
-  PCU_ALWAYS_ASSERT(size < INT_MAX);
-  len = size;
-  rv = BZ2_bzRead(&bzerror, pf->bzf, data, len);
-  if (bzerror != BZ_OK && bzerror != BZ_STREAM_END)
-    reel_fail("BZ2_bzRead failed with code %d", bzerror);
-  PCU_ALWAYS_ASSERT(rv == len);
+  char* p = data;
+  while (size) {
+    len = size < INT_MAX ? (int) size : INT_MAX;
+    rv = BZ2_bzRead(&bzerror, pf->state, p, len);
+    if (bzerror != BZ_OK && bzerror != BZ_STREAM_END)
+      reel_fail("BZ2_bzRead failed with code %d", bzerror);
+    PCU_ALWAYS_ASSERT(rv == len);
+    p += len;
+    size -= len;
+  }
 }
 
-static void compressed_write(pcu_file* pf, void const* data, size_t size)
+static void bzip2_write(pcu_file* pf, void const* data, size_t size)
 {
   int bzerror;
   int len;
-  void* bzip2_is_not_const_correct;
-  PCU_ALWAYS_ASSERT_VERBOSE(size < INT_MAX, 
-    "partition the mesh further or disable bz2 mesh compression\n");
-  len = size;
-  bzip2_is_not_const_correct = (void*)data;
-  BZ2_bzWrite(&bzerror, pf->bzf, bzip2_is_not_const_correct, len);
-  if (bzerror != BZ_OK)
-    reel_fail("BZ2_bzWrite failed with code %d", bzerror);
+  /* bzip2 is not const correct */
+  char* p = (char*) data;
+  while (size) {
+    len = size < INT_MAX ? (int) size : INT_MAX;
+    BZ2_bzWrite(&bzerror, pf->state, p, len);
+    if (bzerror != BZ_OK)
+      reel_fail("BZ2_bzWrite failed with code %d", bzerror);
+    p += len;
+    size -= len;
+  }
 }
 
-static void close_compressed_read(pcu_file* pf)
+static void bzip2_close(pcu_file* pf)
 {
   int bzerror;
-  BZ2_bzReadClose(&bzerror, pf->bzf);
-  if (bzerror != BZ_OK)
-    reel_fail("BZ2_readClose failed with code %d", bzerror);
+  if (pf->write) {
+    int abandon = 0;
+    unsigned* nbytes_in = NULL;
+    unsigned* nbytes_out = NULL;
+    BZ2_bzWriteClose(&bzerror, pf->state, abandon, nbytes_in, nbytes_out);
+    if (bzerror != BZ_OK)
+      reel_fail("BZ2_writeClose failed with code %d", bzerror);
+  } else {
+    BZ2_bzReadClose(&bzerror, pf->state);
+    if (bzerror != BZ_OK)
+      reel_fail("BZ2_readClose failed with code %d", bzerror);
+  }
 }
 
-static void close_compressed_write(pcu_file* pf)
+static pcu_codec const bzip2_codec =
+{bzip2_open, bzip2_read, bzip2_write, bzip2_close};
+
+#endif
+
+#ifdef PCU_ZSTD
+
+/* zstd files are a sequence of independently compressed chunks,
+   each preceded by its raw and compressed sizes as big endian
+   32-bit words. readers stream one chunk at a time, and
+   nothing stops the chunks from being decompressed in parallel. */
+enum { ZSTD_CHUNK = 1 << 24 };
+
+typedef struct {
+  ZSTD_CCtx* cctx;
+  ZSTD_DCtx* dctx;
+  /* the chunk being filled or consumed, size is the position */
+  pcu_buffer chunk;
+  pcu_buffer packed;
+} zstd_state;
+
+static void zstd_check(size_t rv, const char* what)
 {
-  int bzerror;
-  int abandon = 0;
-  unsigned* nbytes_in = NULL;
-  unsigned* nbytes_out = NULL;
-  BZ2_bzWriteClose(&bzerror, pf->bzf, abandon, nbytes_in, nbytes_out);
-  if (bzerror != BZ_OK)
-    reel_fail("BZ2_writeClose failed with code %d", bzerror);
+  if (ZSTD_isError(rv))
+    reel_fail("%s failed: %s", what, ZSTD_getErrorName(rv));
 }
 
-static void close_compressed(pcu_file* pf)
+static void zstd_open(pcu_file* pf)
 {
-  if (pf->write)
-    close_compressed_write(pf);
-  else
-    close_compressed_read(pf);
+  zstd_state* s = malloc(sizeof(zstd_state));
+  s->cctx = NULL;
+  s->dctx = NULL;
+  pcu_make_buffer(&s->chunk);
+  pcu_make_buffer(&s->packed);
+  if (pf->write) {
+    s->cctx = ZSTD_createCCtx();
+    zstd_check(ZSTD_CCtx_setParameter(s->cctx,
+          ZSTD_c_compressionLevel, compression_level),
+        "setting the zstd compression level");
+    if (compression_threads)
+      zstd_check(ZSTD_CCtx_setParameter(s->cctx,
+            ZSTD_c_nbWorkers, compression_threads),
+          "setting the zstd worker threads");
+    pcu_resize_buffer(&s->chunk, ZSTD_CHUNK);
+    pcu_begin_buffer(&s->chunk);
+  } else {
+    s->dctx = ZSTD_createDCtx();
+  }
+  pf->state = s;
 }
 
-#else
+static void zstd_flush(pcu_file* pf)
+{
+  zstd_state* s = pf->state;
+  uint32_t sizes[2];
+  size_t n = ZSTD_compressBound(s->chunk.size);
+  if (!s->chunk.size)
+    return;
+  pcu_resize_buffer(&s->packed, n);
+  n = ZSTD_compress2(s->cctx, s->packed.start, n,
+      s->chunk.start, s->chunk.size);
+  zstd_check(n, "ZSTD_compress2");
+  sizes[0] = s->chunk.size;
+  sizes[1] = n;
+  if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN) {
+    pcu_swap_32(&sizes[0]);
+    pcu_swap_32(&sizes[1]);
+  }
+  raw_write(pf, sizes, sizeof(sizes));
+  raw_write(pf, s->packed.start, n);
+  pcu_begin_buffer(&s->chunk);
+}
 
-static void open_compressed(pcu_file* pf)
+static void zstd_fill(pcu_file* pf)
 {
-  (void)pf;
-  reel_fail("recompile PCU with -DPCU_COMPRESS=ON");
+  zstd_state* s = pf->state;
+  uint32_t sizes[2];
+  size_t n;
+  raw_read(pf, sizes, sizeof(sizes));
+  if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN) {
+    pcu_swap_32(&sizes[0]);
+    pcu_swap_32(&sizes[1]);
+  }
+  pcu_resize_buffer(&s->packed, sizes[1]);
+  raw_read(pf, s->packed.start, sizes[1]);
+  pcu_resize_buffer(&s->chunk, sizes[0]);
+  n = ZSTD_decompressDCtx(s->dctx, s->chunk.start, sizes[0],
+      s->packed.start, sizes[1]);
+  zstd_check(n, "ZSTD_decompressDCtx");
+  PCU_ALWAYS_ASSERT(n == sizes[0]);
+  pcu_begin_buffer(&s->chunk);
 }
 
-static void compressed_read(pcu_file* pf, void* data, size_t size)
+static void zstd_read(pcu_file* pf, void* data, size_t size)
 {
-  (void)pf;
-  (void)data;
-  (void)size;
-  reel_fail("recompile PCU with -DPCU_COMPRESS=ON");
+  zstd_state* s = pf->state;
+  char* p = data;
+  size_t n;
+  while (size) {
+    if (s->chunk.size == s->chunk.capacity)
+      zstd_fill(pf);
+    n = s->chunk.capacity - s->chunk.size;
+    if (n > size)
+      n = size;
+    memcpy(p, pcu_walk_buffer(&s->chunk, n), n);
+    p += n;
+    size -= n;
+  }
 }
 
-static void compressed_write(pcu_file* pf, void const* data, size_t size)
+static void zstd_write(pcu_file* pf, void const* data, size_t size)
 {
-  (void)pf;
-  (void)data;
-  (void)size;
-  reel_fail("recompile PCU with -DPCU_COMPRESS=ON");
+  zstd_state* s = pf->state;
+  char const* p = data;
+  size_t n;
+  while (size) {
+    n = s->chunk.capacity - s->chunk.size;
+    if (n > size)
+      n = size;
+    memcpy(pcu_walk_buffer(&s->chunk, n), p, n);
+    p += n;
+    size -= n;
+    if (s->chunk.size == s->chunk.capacity)
+      zstd_flush(pf);
+  }
 }
 
-static void close_compressed(pcu_file* pf)
+static void zstd_close(pcu_file* pf)
 {
-  (void)pf;
-  reel_fail("recompile PCU with -DPCU_COMPRESS=ON");
+  zstd_state* s = pf->state;
+  if (pf->write)
+    zstd_flush(pf);
+  ZSTD_freeCCtx(s->cctx);
+  ZSTD_freeDCtx(s->dctx);
+  pcu_free_buffer(&s->chunk);
+  pcu_free_buffer(&s->packed);
+  free(s);
 }
 
+static pcu_codec const zstd_codec =
+{zstd_open, zstd_read, zstd_write, zstd_close};
+
+#endif
+
+static pcu_codec const* get_codec(int codec)
+{
+  switch (codec) {
+    case PCU_CODEC_RAW:
+      return NULL;
+#ifdef PCU_BZIP
+    case PCU_CODEC_BZIP2:
+      return &bzip2_codec;
+#else
+    case PCU_CODEC_BZIP2:
+      reel_fail("recompile PCU with -DPCU_COMPRESS=ON");
+#endif
+#ifdef PCU_ZSTD
+    case PCU_CODEC_ZSTD:
+      return &zstd_codec;
+#else
+    case PCU_CODEC_ZSTD:
+      reel_fail("recompile PCU with -DPCU_ZSTD=ON");
 #endif
+  }
+  reel_fail("pcu: unknown codec %d", codec);
+  return NULL;
+}
 
 /**
  * brief limit the number of ranks that can call fopen simultaneously
@@ -182,25 +350,34 @@ FILE* pcu_group_open(const char* path, bool write) {
   return fp;
 }
 
-pcu_file* pcu_fopen(const char* name, bool write, bool compress)
+pcu_file* pcu_fopen(const char* name, bool write, int codec)
 {
   pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
-  pf->compress = compress;
+  pf->codec = get_codec(codec);
+  pf->state = NULL;
   pf->write = write;
+  pf->shared = NULL;
   pf->f = pcu_group_open(name, write);
   if (!pf->f) {
     perror("pcu_fopen");
     reel_fail("pcu_fopen couldn't open \"%s\"", name);
   }
-  if(compress)
-    open_compressed(pf);
+  if (pf->codec)
+    pf->codec->open(pf);
   return pf;
 }
 
+static void close_shared(pcu_file* pf);
+
 void pcu_fclose(pcu_file* pf)
 {
-  if (pf->compress)
-    close_compressed(pf);
+  if (pf->shared) {
+    close_shared(pf);
+    free(pf);
+    return;
+  }
+  if (pf->codec)
+    pf->codec->close(pf);
   fclose(pf->f);
   free(pf);
 }
@@ -209,24 +386,24 @@ void pcu_fwrite(void const* p, size_t size, size_t nmemb, pcu_file * f)
 {
   if (!f->write)
     reel_fail("pcu_fwrite: file not opened for writing.");
-  if (f->compress) {
-    compressed_write(f, p, size * nmemb);
-  } else {
-    if (nmemb != fwrite(p, size, nmemb, f->f))
-      reel_fail("fwrite(%p, %lu, %lu, %p) failed", p, size, nmemb, (void*) f->f);
-  }
+  if (f->shared)
+    memcpy(pcu_push_buffer(&f->mem, size * nmemb), p, size * nmemb);
+  else if (f->codec)
+    f->codec->write(f, p, size * nmemb);
+  else
+    raw_write(f, p, size * nmemb);
 }
 
 void pcu_fread(void* p, size_t size, size_t nmemb, pcu_file * f)
 {
   if (f->write)
     reel_fail("pcu_fread: file not opened for reading.");
-  if (f->compress) {
-    compressed_read(f, p, size * nmemb);
-  } else {
-    if (nmemb != fread(p, size, nmemb, f->f))
-      reel_fail("fread(%p, %lu, %lu, %p) failed", p, size, nmemb, (void*) f->f);
-  }
+  if (f->shared)
+    memcpy(p, pcu_walk_buffer(&f->mem, size * nmemb), size * nmemb);
+  else if (f->codec)
+    f->codec->read(f, p, size * nmemb);
+  else
+    raw_read(f, p, size * nmemb);
 }
 
 void pcu_read(pcu_file* f, char* p, size_t n)
@@ -239,11 +416,6 @@ void pcu_write(pcu_file* f, const char* p, size_t n)
   pcu_fwrite(p,1,n,f);
 }
 
-static const uint16_t pcu_endian_value = 1;
-#define PCU_ENDIANNESS ((*((uint8_t*)(&pcu_endian_value)))==1)
-#define PCU_BIG_ENDIAN 0
-#define PCU_ENCODED_ENDIAN PCU_BIG_ENDIAN //consistent with network byte order
-
 static void pcu_swap_32(uint32_t* p)
 {
   uint32_t a = *p;
@@ -367,3 +539,185 @@ FILE* pcu_open_parallel(const char* prefix, const char* ext)
   noto_free(path);
   return file;
 }
+
+/* layout of a shared file, all words are 64-bit big endian:
+     magic, part count,
+     index of (part count + 1) byte offsets, part i
+       occupies [index[i], index[i + 1]),
+     part contents in part order.
+   every rank writes its own index entry, so nothing
+   has to be gathered onto one rank. */
+#define PCU_SHARED_MAGIC 0x50435553484d4231ULL
+enum { PCU_SHARED_HEADER = 2 };
+
+static void encode_words(uint64_t* p, size_t n)
+{
+  if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN)
+    for (size_t i = 0; i < n; ++i)
+      pcu_swap_64(p + i);
+}
+
+static MPI_Info shared_info(void)
+{
+  MPI_Info info;
+  MPI_Info_create(&info);
+  /* let the MPI-IO layer aggregate the per-rank pieces
+     into a few large requests */
+  MPI_Info_set(info, "romio_cb_write", "enable");
+  MPI_Info_set(info, "romio_cb_read", "enable");
+  return info;
+}
+
+static MPI_File open_shared(const char* path, bool write)
+{
+  MPI_File file;
+  MPI_Info info = shared_info();
+  int mode = write ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+  if (MPI_File_open(PCU_Get_Comm(), path, mode, info, &file) != MPI_SUCCESS)
+    reel_fail("pcu: could not open shared file \"%s\"\n", path);
+  MPI_Info_free(&info);
+  return file;
+}
+
+static int count_shared(MPI_File file, const char* path)
+{
+  uint64_t head[PCU_SHARED_HEADER] = {0, 0};
+  if (!PCU_Comm_Self()) {
+    MPI_File_read_at(file, 0, head, sizeof(head), MPI_BYTE,
+        MPI_STATUS_IGNORE);
+    encode_words(head, PCU_SHARED_HEADER);
+  }
+  MPI_Bcast(head, PCU_SHARED_HEADER * sizeof(uint64_t), MPI_BYTE, 0,
+      PCU_Get_Comm());
+  if (head[0] != PCU_SHARED_MAGIC)
+    reel_fail("pcu: \"%s\" is not a shared file\n", path);
+  PCU_ALWAYS_ASSERT(head[1] <= INT_MAX);
+  return (int) head[1];
+}
+
+/* MPI-IO counts are ints, so pieces of a shared file are
+   moved in chunks of at most this many bytes */
+enum { PCU_SHARED_CHUNK = 1 << 30 };
+
+/* the collective calls must be made as many times on every rank,
+   so all ranks go through as many chunks as the largest piece */
+static unsigned long count_chunks(size_t n)
+{
+  unsigned long chunks = (n + PCU_SHARED_CHUNK - 1) / PCU_SHARED_CHUNK;
+  MPI_Allreduce(MPI_IN_PLACE, &chunks, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+      PCU_Get_Comm());
+  return chunks;
+}
+
+static void write_at(MPI_File file, MPI_Offset at, void* p, size_t n)
+{
+  unsigned long chunks = count_chunks(n);
+  char* c = p;
+  for (unsigned long i = 0; i < chunks; ++i) {
+    int m = n < PCU_SHARED_CHUNK ? (int) n : PCU_SHARED_CHUNK;
+    if (MPI_File_write_at_all(file, at, c, m, MPI_BYTE,
+          MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      reel_fail("pcu: MPI_File_write_at_all failed");
+    at += m;
+    c += m;
+    n -= m;
+  }
+}
+
+static void read_at(MPI_File file, MPI_Offset at, void* p, size_t n)
+{
+  unsigned long chunks = count_chunks(n);
+  char* c = p;
+  for (unsigned long i = 0; i < chunks; ++i) {
+    int m = n < PCU_SHARED_CHUNK ? (int) n : PCU_SHARED_CHUNK;
+    if (MPI_File_read_at_all(file, at, c, m, MPI_BYTE,
+          MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      reel_fail("pcu: MPI_File_read_at_all failed");
+    at += m;
+    c += m;
+    n -= m;
+  }
+}
+
+static void close_shared(pcu_file* pf)
+{
+  MPI_File file;
+  uint64_t size;
+  uint64_t start = 0;
+  uint64_t words[PCU_SHARED_HEADER + 2];
+  size_t n;
+  MPI_Offset at;
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  if (pf->write) {
+    size = pf->mem.size;
+    MPI_Exscan(&size, &start, 1, MPI_UINT64_T, MPI_SUM, PCU_Get_Comm());
+    if (!self)
+      start = 0;
+    start += (PCU_SHARED_HEADER + peers + 1) * sizeof(uint64_t);
+    file = open_shared(pf->shared, true);
+    MPI_File_set_size(file, 0);
+    if (!self) {
+      words[0] = PCU_SHARED_MAGIC;
+      words[1] = peers;
+      words[2] = start;
+      words[3] = start + size;
+      n = 4;
+      at = 0;
+    } else {
+      words[0] = start + size;
+      n = 1;
+      at = (PCU_SHARED_HEADER + self + 1) * sizeof(uint64_t);
+    }
+    encode_words(words, n);
+    write_at(file, at, words, n * sizeof(uint64_t));
+    write_at(file, start, pf->mem.start, size);
+    MPI_File_close(&file);
+  }
+  pcu_free_buffer(&pf->mem);
+  free(pf->shared);
+}
+
+int pcu_count_shared(const char* path)
+{
+  MPI_File file = open_shared(path, false);
+  int parts = count_shared(file, path);
+  MPI_File_close(&file);
+  return parts;
+}
+
+pcu_file* pcu_shared_open(const char* path, int part, bool write)
+{
+  MPI_File file;
+  uint64_t range[2] = {0, 0};
+  size_t n = 0;
+  int parts;
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->f = NULL;
+  pf->codec = NULL;
+  pf->state = NULL;
+  pf->write = write;
+  pf->shared = malloc(strlen(path) + 1);
+  strcpy(pf->shared, path);
+  pcu_make_buffer(&pf->mem);
+  if (write) {
+    PCU_ALWAYS_ASSERT(part == PCU_Comm_Self());
+    return pf;
+  }
+  file = open_shared(path, false);
+  parts = count_shared(file, path);
+  if (part >= 0) {
+    PCU_ALWAYS_ASSERT(part < parts);
+    read_at(file, (PCU_SHARED_HEADER + part) * sizeof(uint64_t),
+        range, sizeof(range));
+    encode_words(range, 2);
+    n = range[1] - range[0];
+  } else {
+    read_at(file, 0, range, 0);
+  }
+  pcu_set_buffer(&pf->mem, noto_malloc(n), n);
+  read_at(file, range[0], pf->mem.start, n);
+  pcu_begin_buffer(&pf->mem);
+  MPI_File_close(&file);
+  return pf;
+}
@@ -21,7 +21,13 @@ extern "C" {
 
 struct pcu_file;
 
-struct pcu_file* pcu_fopen(const char* path, bool write, bool compress);
+/* codecs that pcu_fopen can compress a file with */
+enum { PCU_CODEC_RAW, PCU_CODEC_BZIP2, PCU_CODEC_ZSTD };
+
+struct pcu_file* pcu_fopen(const char* path, bool write, int codec);
+/* level and worker threads for codecs that have them,
+   the default is the fastest level without threads */
+void pcu_set_compression(int level, int threads);
 void pcu_fclose (struct pcu_file * pf);
 void pcu_read(struct pcu_file* f, char* p, size_t n);
 void pcu_write(struct pcu_file* f, const char* p, size_t n);
@@ -34,6 +40,13 @@ void pcu_write_doubles(struct pcu_file* f, double* p, size_t n);
 void pcu_read_string(struct pcu_file* f, char** p);
 void pcu_write_string(struct pcu_file* f, const char* p);
 
+/* one file holding a part per rank, buffered in memory.
+   opening for reading and closing after writing are collective
+   MPI-IO calls over the PCU communicator.
+   a negative part reads nothing but takes part in the call. */
+struct pcu_file* pcu_shared_open(const char* path, int part, bool write);
+int pcu_count_shared(const char* path);
+
 FILE* pcu_open_parallel(const char* prefix, const char* ext);
 FILE* pcu_group_open(const char* path, bool write);
 
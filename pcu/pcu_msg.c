@@ -9,6 +9,7 @@
 *******************************************************************************/
 #include "pcu_msg.h"
 #include "pcu_pmpi.h"
+#include "pcu_node.h"
 #include "noto_malloc.h"
 #include "reel.h"
 #include <string.h>
@@ -72,6 +73,7 @@ void pcu_make_msg(pcu_msg* m)
   make_comm(m);
   m->file = NULL;
   m->order = NULL;
+  m->node = NULL;
 }
 
 static void free_peers(pcu_aa_tree* t)
@@ -158,6 +160,12 @@ void pcu_msg_send(pcu_msg* m)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Send called at the wrong time");
+  if (m->node) {
+    /* all messages have arrived when this returns */
+    pcu_node_send(m->node, m);
+    m->state = recv_state;
+    return;
+  }
   send_peers(m->peers);
   m->state = send_recv_state;
 }
@@ -204,7 +212,12 @@ bool pcu_msg_receive(pcu_msg* m)
     reel_fail("PCU_Comm_Receive called at the wrong time");
   if ( ! pcu_msg_unpacked(m))
     reel_fail("PCU_Comm_Receive called before previous message unpacked");
-  if (receive_global(m))
+  bool received;
+  if (m->node)
+    received = pcu_node_receive(m->node, m);
+  else
+    received = receive_global(m);
+  if (received)
   {
     pcu_begin_buffer(&(m->received.buffer));
     return true;
@@ -28,6 +28,7 @@ typedef struct
 } pcu_msg_peer;
 
 struct pcu_order_struct;
+struct pcu_node_struct;
 
 struct pcu_msg_struct
 {
@@ -41,6 +42,7 @@ struct pcu_msg_struct
      pcu_thread struct to or something */
   FILE* file; //messenger-unique input or output file
   struct pcu_order_struct* order;
+  struct pcu_node_struct* node; //set to aggregate by node
 };
 typedef struct pcu_msg_struct pcu_msg;
 
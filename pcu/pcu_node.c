@@ -0,0 +1,303 @@
+/****************************************************************************** 
+
+  Copyright 2011 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_node.h"
+#include "pcu_pmpi.h"
+#include "pcu_util.h"
+#include "noto_malloc.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* the aggregated phase runs as up to three sub-phases,
+   each with the same send, receive and barrier steps as
+   a plain pcu_msg phase:
+
+1  sender -> leader of its node
+2  leader -> leader of the receiver's node
+3  leader -> receiver
+
+   messages within a node, and messages too large to gain
+   from bundling, go straight to their receiver in step 1.
+   a leader skips the hop to itself, so step 1 may also carry
+   leader to leader and leader to receiver bundles.
+   every record is at most three hops from its receiver,
+   so nothing is in flight after step 3. */
+
+/* bigger messages are not worth copying into a bundle */
+static size_t const direct_size = 16 * 1024;
+
+/* a record in a bundle, followed by size bytes of the
+   message from rank "from" to rank "to" */
+typedef struct
+{
+  int from;
+  int to;
+  size_t size;
+} record;
+
+struct pcu_node_struct
+{
+  int* leader; //the leader of each rank's node
+  pcu_aa_tree hops; //bundles being filled for the next step
+  pcu_message* arrived; //messages received by this rank
+  int count;
+  int capacity;
+  int at;
+};
+
+static void make_arrived(pcu_node n)
+{
+  n->arrived = NULL;
+  n->count = 0;
+  n->capacity = 0;
+  n->at = -1;
+}
+
+pcu_node pcu_node_new(MPI_Comm comm)
+{
+  pcu_node n;
+  MPI_Comm node;
+  int rank, size, leader;
+  char* per_node;
+  NOTO_MALLOC(n,1);
+  MPI_Comm_rank(comm,&rank);
+  MPI_Comm_size(comm,&size);
+  per_node = getenv("PCU_RANKS_PER_NODE");
+  if (per_node && atoi(per_node) > 0)
+    MPI_Comm_split(comm,rank / atoi(per_node),rank,&node);
+  else
+    MPI_Comm_split_type(comm,MPI_COMM_TYPE_SHARED,rank,MPI_INFO_NULL,&node);
+  leader = rank;
+  MPI_Bcast(&leader,1,MPI_INT,0,node);
+  MPI_Comm_free(&node);
+  NOTO_MALLOC(n->leader,size);
+  MPI_Allgather(&leader,1,MPI_INT,n->leader,1,MPI_INT,comm);
+  pcu_make_aa(&n->hops);
+  make_arrived(n);
+  return n;
+}
+
+static void free_hops(pcu_aa_tree* t)
+{
+  if (pcu_aa_empty(*t))
+    return;
+  free_hops(&((*t)->left));
+  free_hops(&((*t)->right));
+  pcu_msg_peer* hop;
+  hop = (pcu_msg_peer*) *t;
+  pcu_free_message(&(hop->message));
+  noto_free(hop);
+  pcu_make_aa(t);
+}
+
+static void free_arrived(pcu_node n)
+{
+  int i;
+  for (i = n->at + 1; i < n->count; ++i)
+    pcu_free_message(&(n->arrived[i]));
+  noto_free(n->arrived);
+  make_arrived(n);
+}
+
+void pcu_node_free(pcu_node n)
+{
+  free_hops(&n->hops);
+  free_arrived(n);
+  noto_free(n->leader);
+  noto_free(n);
+}
+
+static bool hop_less(pcu_aa_node* a, pcu_aa_node* b)
+{
+  return ((pcu_msg_peer*)a)->message.peer
+       < ((pcu_msg_peer*)b)->message.peer;
+}
+
+static pcu_buffer* get_hop(pcu_node n, int id)
+{
+  pcu_msg_peer key;
+  pcu_msg_peer* hop;
+  key.message.peer = id;
+  hop = (pcu_msg_peer*) pcu_aa_find(&(key.node),n->hops,hop_less);
+  if (!hop) {
+    NOTO_MALLOC(hop,1);
+    pcu_make_message(&(hop->message));
+    hop->message.peer = id;
+    pcu_aa_insert(&(hop->node),&(n->hops),hop_less);
+  }
+  return &(hop->message.buffer);
+}
+
+static int next_hop(pcu_node n, int to)
+{
+  int self = pcu_pmpi_rank();
+  if (n->leader[to] == n->leader[self])
+    return to;
+  if (self != n->leader[self])
+    return n->leader[self];
+  return n->leader[to];
+}
+
+static void push_record(pcu_node n, int from, int to, void* data,
+    size_t size)
+{
+  pcu_buffer* b = get_hop(n, next_hop(n, to));
+  record r;
+  r.from = from;
+  r.to = to;
+  r.size = size;
+  memcpy(pcu_push_buffer(b,sizeof(r)),&r,sizeof(r));
+  memcpy(pcu_push_buffer(b,size),data,size);
+}
+
+/* takes the buffer of m, leaving m empty */
+static void arrive(pcu_node n, int from, pcu_message* m)
+{
+  if (n->count == n->capacity) {
+    n->capacity = n->capacity ? 2 * n->capacity : 16;
+    n->arrived = noto_realloc(n->arrived,
+        n->capacity * sizeof(pcu_message));
+  }
+  n->arrived[n->count].buffer = m->buffer;
+  n->arrived[n->count].peer = from;
+  ++n->count;
+  pcu_make_buffer(&(m->buffer));
+}
+
+static void arrive_record(pcu_node n, record* r, void* data)
+{
+  pcu_message m;
+  pcu_make_message(&m);
+  pcu_resize_buffer(&m.buffer,r->size);
+  memcpy(m.buffer.start,data,r->size);
+  arrive(n, r->from, &m);
+}
+
+/* keeps the records addressed to this rank
+   and bundles the rest for the next step */
+static void route(pcu_node n, pcu_message* bundle)
+{
+  int self = pcu_pmpi_rank();
+  record r;
+  void* data;
+  pcu_begin_buffer(&(bundle->buffer));
+  while ( ! pcu_buffer_walked(&(bundle->buffer))) {
+    memcpy(&r,pcu_walk_buffer(&(bundle->buffer),sizeof(r)),sizeof(r));
+    data = pcu_walk_buffer(&(bundle->buffer),r.size);
+    if (r.to == self)
+      arrive_record(n, &r, data);
+    else
+      push_record(n, r.from, r.to, data, r.size);
+  }
+}
+
+static void send_tree(pcu_aa_tree t, int tag)
+{
+  if (pcu_aa_empty(t))
+    return;
+  pcu_msg_peer* peer;
+  peer = (pcu_msg_peer*)t;
+  pcu_pmpi_send2(&(peer->message),tag,pcu_user_comm);
+  send_tree(t->left,tag);
+  send_tree(t->right,tag);
+}
+
+static bool done_tree(pcu_aa_tree t)
+{
+  if (pcu_aa_empty(t))
+    return true;
+  pcu_msg_peer* peer;
+  peer = (pcu_msg_peer*)t;
+  return pcu_pmpi_done(&(peer->message))
+    && done_tree(t->left)
+    && done_tree(t->right);
+}
+
+/* one sub-phase: sends the bundles in out and the whole
+   messages in direct, routing what arrives into n->hops */
+static void step(pcu_node n, pcu_coll* c, pcu_aa_tree out,
+    pcu_aa_tree direct)
+{
+  pcu_message received;
+  bool sending = true;
+  pcu_make_message(&received);
+  send_tree(out,pcu_node_bundle_tag);
+  send_tree(direct,pcu_node_direct_tag);
+  while (true) {
+    received.peer = MPI_ANY_SOURCE;
+    if (pcu_pmpi_receive2(&received,pcu_node_bundle_tag,pcu_user_comm)) {
+      route(n, &received);
+      continue;
+    }
+    received.peer = MPI_ANY_SOURCE;
+    if (pcu_pmpi_receive2(&received,pcu_node_direct_tag,pcu_user_comm)) {
+      arrive(n, received.peer, &received);
+      continue;
+    }
+    if (sending && done_tree(out) && done_tree(direct)) {
+      pcu_begin_barrier(c);
+      sending = false;
+    }
+    if ((!sending) && pcu_barrier_done(c))
+      break;
+  }
+  pcu_free_message(&received);
+}
+
+/* whole messages go in direct, the rest are bundled */
+static void sort_peers(pcu_node n, pcu_aa_tree t, pcu_aa_tree* direct)
+{
+  if (pcu_aa_empty(t))
+    return;
+  pcu_msg_peer* peer;
+  peer = (pcu_msg_peer*)t;
+  sort_peers(n, t->left, direct);
+  sort_peers(n, t->right, direct);
+  int to = peer->message.peer;
+  pcu_buffer* b = &(peer->message.buffer);
+  if (next_hop(n, to) == to || b->size > direct_size) {
+    pcu_msg_peer* copy;
+    NOTO_MALLOC(copy,1);
+    copy->message.peer = to;
+    copy->message.buffer = *b;
+    pcu_make_buffer(b);
+    pcu_aa_insert(&(copy->node),direct,hop_less);
+  } else
+    push_record(n, pcu_pmpi_rank(), to, b->start, b->size);
+}
+
+void pcu_node_send(pcu_node n, pcu_msg* m)
+{
+  pcu_aa_tree out;
+  pcu_aa_tree direct;
+  int i;
+  free_arrived(n);
+  pcu_make_aa(&direct);
+  sort_peers(n, m->peers, &direct);
+  for (i = 0; i < 3; ++i) {
+    out = n->hops;
+    pcu_make_aa(&n->hops);
+    step(n, &(m->coll), out, direct);
+    free_hops(&out);
+    free_hops(&direct);
+  }
+  PCU_ALWAYS_ASSERT(pcu_aa_empty(n->hops));
+}
+
+bool pcu_node_receive(pcu_node n, pcu_msg* m)
+{
+  ++n->at;
+  if (n->at == n->count) {
+    free_arrived(n);
+    return false;
+  }
+  pcu_free_message(&(m->received));
+  m->received = n->arrived[n->at];
+  return true;
+}
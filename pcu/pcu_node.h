@@ -0,0 +1,28 @@
+/****************************************************************************** 
+
+  Copyright 2014 Scientific Computation Research Center, 
+      Rensselaer Polytechnic Institute. All rights reserved.
+  
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_NODE_H
+#define PCU_NODE_H
+
+#include <stdbool.h>
+#include "pcu_msg.h"
+
+/* node-aware aggregation of a pcu_msg phase.
+   small messages between shared-memory nodes are bundled
+   through one leader rank per node, so each pair of nodes
+   exchanges one message instead of one per pair of ranks */
+
+typedef struct pcu_node_struct* pcu_node;
+
+pcu_node pcu_node_new(MPI_Comm comm);
+void pcu_node_free(pcu_node n);
+void pcu_node_send(pcu_node n, pcu_msg* m);
+bool pcu_node_receive(pcu_node n, pcu_msg* m);
+
+#endif
@@ -0,0 +1,298 @@
+/******************************************************************************
+
+  Copyright 2011 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "PCU.h"
+#include "pcu_mpi.h"
+#include "pcu_pmpi.h"
+#include "noto_malloc.h"
+#include "reel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/* the pcu_plan exchange is a cheaper alternative to the
+   pcu_msg phase for the common case where the set of
+   communicating peers is fixed, e.g. part boundary neighbors.
+
+   Since every rank knows exactly which peers it will hear from,
+   every peer is sent one (possibly empty) message per exchange and
+   the receiver simply probes each known peer in turn.
+   This removes the barrier that starts a pcu_msg phase,
+   the termination detection barrier that ends it, and
+   the per-pack binary tree lookup of the destination buffer.
+   Buffers are kept between exchanges: send buffers keep their
+   capacity and only grow when a message is larger than any before,
+   while receive buffers are resized to each incoming message, which
+   reallocates them whenever the message size changes.
+
+   Plan messages use their own tag on the user communicator
+   (see pcu_pmpi.h),
+   and MPI guarantees messages from one rank with the same tag
+   are received in order, so a rank that starts its next exchange
+   early can not confuse a slow peer still receiving this one. */
+
+enum {
+  idle_state,
+  pack_state,
+  recv_state
+};
+
+struct pcu_plan
+{
+  int count;
+  int* ranks;
+  pcu_message* out;
+  pcu_message* in;
+  int last; //cached index of the last peer packed to
+  int at; //index of the current received buffer
+  int state;
+};
+
+static int compare_ints(const void* a, const void* b)
+{
+  int x = *(const int*)a;
+  int y = *(const int*)b;
+  return (x > y) - (x < y);
+}
+
+static int unique_ints(int* a, int n, int self)
+{
+  qsort(a, n, sizeof(int), compare_ints);
+  int m = 0;
+  for (int i = 0; i < n; ++i) {
+    if (a[i] == self)
+      continue;
+    if (m && a[m - 1] == a[i])
+      continue;
+    a[m++] = a[i];
+  }
+  return m;
+}
+
+/* peers listed by this rank may not list this rank back
+   (e.g. ghost copies are only known to the owner),
+   so one pcu_msg phase is used to make the peer sets symmetric */
+static int symmetrize(const int* peers, int n, int** result)
+{
+  int self = PCU_Comm_Self();
+  PCU_Comm_Begin();
+  for (int i = 0; i < n; ++i)
+    if (peers[i] != self)
+      PCU_COMM_PACK(peers[i], self);
+  PCU_Comm_Send();
+  int cap = n;
+  int* all;
+  NOTO_MALLOC(all, cap + 1);
+  memcpy(all, peers, n * sizeof(int));
+  int count = n;
+  while (PCU_Comm_Receive()) {
+    int from;
+    PCU_COMM_UNPACK(from);
+    if (count == cap) {
+      cap = cap * 2 + 1;
+      all = noto_realloc(all, (cap + 1) * sizeof(int));
+    }
+    all[count++] = from;
+  }
+  *result = all;
+  return unique_ints(all, count, self);
+}
+
+/** \brief Creates a persistent exchange plan with a fixed set of peers.
+  \details This is a collective call over all ranks.
+  \a peers is an array of \a npeers ranks this rank will exchange
+  messages with; duplicates and the calling rank are ignored, and
+  any rank that lists this rank is added as a peer as well.
+  The plan remains valid until PCU_Plan_Free or PCU_Switch_Comm.
+ */
+struct pcu_plan* PCU_Plan_New(int npeers, const int* peers)
+{
+  if (!PCU_Comm_Initialized())
+    reel_fail("Plan_New called before Comm_Init");
+  struct pcu_plan* p;
+  NOTO_MALLOC(p, 1);
+  p->count = symmetrize(peers, npeers, &p->ranks);
+  NOTO_MALLOC(p->out, p->count);
+  NOTO_MALLOC(p->in, p->count);
+  for (int i = 0; i < p->count; ++i) {
+    pcu_make_message(&p->out[i]);
+    pcu_make_message(&p->in[i]);
+    p->out[i].peer = p->in[i].peer = p->ranks[i];
+  }
+  p->last = 0;
+  p->at = -1;
+  p->state = idle_state;
+  return p;
+}
+
+/** \brief Frees an exchange plan and all its buffers. */
+void PCU_Plan_Free(struct pcu_plan* p)
+{
+  if (p->state != idle_state)
+    reel_fail("PCU_Plan_Free called during an exchange");
+  for (int i = 0; i < p->count; ++i) {
+    pcu_free_message(&p->out[i]);
+    pcu_free_message(&p->in[i]);
+  }
+  noto_free(p->out);
+  noto_free(p->in);
+  noto_free(p->ranks);
+  noto_free(p);
+}
+
+/** \brief Returns the number of peers in the plan. */
+int PCU_Plan_Peers(struct pcu_plan* p)
+{
+  return p->count;
+}
+
+/** \brief Returns the rank of peer \a i, peers are sorted by rank. */
+int PCU_Plan_Peer(struct pcu_plan* p, int i)
+{
+  return p->ranks[i];
+}
+
+/** \brief Returns the peer index of \a rank, or -1 if it is not a peer. */
+int PCU_Plan_Find(struct pcu_plan* p, int rank)
+{
+  if (p->count && p->ranks[p->last] == rank)
+    return p->last;
+  int* r = bsearch(&rank, p->ranks, p->count, sizeof(int), compare_ints);
+  if (!r)
+    return -1;
+  p->last = r - p->ranks;
+  return p->last;
+}
+
+/** \brief Begins an exchange over the plan.
+  \details Unlike PCU_Comm_Begin, this call does not synchronize.
+  Only the ranks in the plan need to take part in the exchange.
+ */
+void PCU_Plan_Begin(struct pcu_plan* p)
+{
+  if (p->state != idle_state)
+    reel_fail("PCU_Plan_Begin called at the wrong time");
+  for (int i = 0; i < p->count; ++i)
+    p->out[i].buffer.size = 0;
+  p->state = pack_state;
+}
+
+/** \brief Returns space for \a size bytes in the buffer sent to peer \a i.
+  \details The returned pointer is valid until the next call that
+  packs data to the same peer.
+ */
+void* PCU_Plan_Buffer(struct pcu_plan* p, int i, size_t size)
+{
+  if (p->state != pack_state)
+    reel_fail("PCU_Plan_Buffer called at the wrong time");
+  return pcu_push_buffer(&p->out[i].buffer, size);
+}
+
+/** \brief Packs data to be sent to \a to_rank, which must be a peer. */
+int PCU_Plan_Pack(struct pcu_plan* p, int to_rank,
+    const void* data, size_t size)
+{
+  int i = PCU_Plan_Find(p, to_rank);
+  if (i < 0)
+    reel_fail("PCU_Plan_Pack to rank %d which is not a peer", to_rank);
+  memcpy(PCU_Plan_Buffer(p, i, size), data, size);
+  return PCU_SUCCESS;
+}
+
+static void check_size(pcu_buffer* b)
+{
+  if (b->size > (size_t)INT_MAX)
+    reel_fail("PCU plan message size exceeds INT_MAX");
+}
+
+/** \brief Exchanges all packed buffers with the plan peers.
+  \details Every peer is sent its buffer, even if it is empty,
+  and all incoming buffers are received before this call returns.
+ */
+int PCU_Plan_Send(struct pcu_plan* p)
+{
+  if (p->state != pack_state)
+    reel_fail("PCU_Plan_Send called at the wrong time");
+  for (int i = 0; i < p->count; ++i) {
+    check_size(&p->out[i].buffer);
+    MPI_Isend(p->out[i].buffer.start, (int)p->out[i].buffer.size,
+        MPI_BYTE, p->ranks[i], pcu_plan_tag, pcu_user_comm,
+        &p->out[i].request);
+  }
+  for (int i = 0; i < p->count; ++i) {
+    MPI_Status status;
+    int count;
+    MPI_Probe(p->ranks[i], pcu_plan_tag, pcu_user_comm, &status);
+    MPI_Get_count(&status, MPI_BYTE, &count);
+    pcu_resize_buffer(&p->in[i].buffer, (size_t)count);
+    MPI_Recv(p->in[i].buffer.start, count, MPI_BYTE, p->ranks[i],
+        pcu_plan_tag, pcu_user_comm, MPI_STATUS_IGNORE);
+    pcu_begin_buffer(&p->in[i].buffer);
+  }
+  for (int i = 0; i < p->count; ++i)
+    MPI_Wait(&p->out[i].request, MPI_STATUS_IGNORE);
+  p->at = -1;
+  p->state = recv_state;
+  return PCU_SUCCESS;
+}
+
+/** \brief Moves on to the next non-empty received buffer.
+  \details Buffers are visited in increasing order of sender rank.
+  Returns false when all received buffers have been visited,
+  which ends the exchange.
+ */
+bool PCU_Plan_Listen(struct pcu_plan* p)
+{
+  if (p->state != recv_state)
+    reel_fail("PCU_Plan_Listen called at the wrong time");
+  for (++p->at; p->at < p->count; ++p->at)
+    if (p->in[p->at].buffer.capacity)
+      return true;
+  p->state = idle_state;
+  return false;
+}
+
+/** \brief Returns the rank that sent the current received buffer. */
+int PCU_Plan_Sender(struct pcu_plan* p)
+{
+  return p->ranks[p->at];
+}
+
+/** \brief Returns true if the current received buffer has been unpacked. */
+bool PCU_Plan_Unpacked(struct pcu_plan* p)
+{
+  if (p->at < 0 || p->at >= p->count)
+    return true;
+  return pcu_buffer_walked(&p->in[p->at].buffer);
+}
+
+/** \brief Unpacks \a size bytes from the current received buffer. */
+int PCU_Plan_Unpack(struct pcu_plan* p, void* data, size_t size)
+{
+  memcpy(data, pcu_walk_buffer(&p->in[p->at].buffer, size), size);
+  return PCU_SUCCESS;
+}
+
+/** \brief Unpacks \a size bytes and returns a pointer to them.
+  \details The pointer refers to the plan's internal buffer and
+  is valid until the next exchange.
+ */
+void* PCU_Plan_Extract(struct pcu_plan* p, size_t size)
+{
+  return pcu_walk_buffer(&p->in[p->at].buffer, size);
+}
+
+/** \brief Convenience wrapper over PCU_Plan_Listen and PCU_Plan_Unpacked */
+bool PCU_Plan_Receive(struct pcu_plan* p)
+{
+  while (PCU_Plan_Unpacked(p))
+    if (!PCU_Plan_Listen(p))
+      return false;
+  return true;
+}
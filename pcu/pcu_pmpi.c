@@ -54,7 +54,7 @@ int pcu_pmpi_rank(void)
 
 void pcu_pmpi_send(pcu_message* m, MPI_Comm comm)
 {
-  pcu_pmpi_send2(m,0,comm);
+  pcu_pmpi_send2(m,pcu_msg_tag,comm);
 }
 
 void pcu_pmpi_send2(pcu_message* m, int tag, MPI_Comm comm)
@@ -82,7 +82,7 @@ bool pcu_pmpi_done(pcu_message* m)
 
 bool pcu_pmpi_receive(pcu_message* m, MPI_Comm comm)
 {
-  return pcu_pmpi_receive2(m,0,comm);
+  return pcu_pmpi_receive2(m,pcu_msg_tag,comm);
 }
 
 bool pcu_pmpi_receive2(pcu_message* m, int tag, MPI_Comm comm)
@@ -30,6 +30,16 @@ MPI_Comm pcu_pmpi_comm(void);
 extern pcu_mpi pcu_pmpi;
 
 extern MPI_Comm pcu_user_comm;
+
+/* every kind of traffic on pcu_user_comm has its own tag, so
+   a rank that moves on to the next exchange early can not be
+   mistaken for a message of the kind a slow peer still expects */
+enum {
+  pcu_msg_tag = 0,
+  pcu_plan_tag = 1,
+  pcu_node_bundle_tag = 2,
+  pcu_node_direct_tag = 3
+};
 extern MPI_Comm pcu_coll_comm;
 
 #endif
@@ -40,7 +40,9 @@ set(SOURCES
    pcu_buffer.c
    pcu_mpi.c
    pcu_msg.c
+   pcu_node.c
    pcu_order.c
+   pcu_plan.c
    pcu_pmpi.c
    pcu_util.c
    noto/noto_malloc.c
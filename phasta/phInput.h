@@ -49,8 +49,8 @@ class Input
     /** \brief path to the directory that includes the input mesh
         \details the path to the SCOREC MDS mesh must end with a '/' if it is a
        directory containing multiple '<partid>.smb' files. This path
-       can also be prepended by "bz2:" to tell the mesh file reader that the
-       files have been compressed. */
+       can also be prepended by "bz2:" or "zst:" to tell the mesh file reader
+       that the files have been compressed with bzip2 or zstd. */
     std::string meshFileName;
     /** \brief output mesh file name, see meshFileName */
     std::string outMeshFileName;
@@ -55,6 +55,12 @@ public:
   virtual void parallelReduce() {
     sum = PCU_Add_Double(sum);
   }
+  virtual apf::Integrator* clone() {
+    return new TotalMetricVolumeIso(iso_field);
+  }
+  virtual void merge(apf::Integrator* other) {
+    sum += static_cast<TotalMetricVolumeIso*>(other)->sum;
+  }
 };
 
 double getTotalMetricVolumeIso(apf::Field* iso_field) {
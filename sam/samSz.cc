@@ -1,6 +1,8 @@
 #include "samSz.h"
 #include <apf.h>
 #include <apfField.h>
+#include <apfMesh.h>
+#include <PCU.h>
 #include <pcu_util.h>
 
 namespace {
@@ -28,10 +30,14 @@ void setLenAndCnt(apf::Mesh* m, apf::Field* fLen, apf::Field* fCnt) {
     apf::setScalar(fCnt, vtx, 0, cnt);
   }
   m->end(itr);
-  apf::accumulate(fLen);
-  apf::accumulate(fCnt);
-  apf::synchronize(fLen);
-  apf::synchronize(fCnt);
+  apf::Sharing* shr = apf::getSharing(m);
+  pcu_plan* plan = apf::makeNeighborPlan(m, shr);
+  apf::accumulate(fLen, shr, false, plan);
+  apf::accumulate(fCnt, shr, false, plan);
+  apf::synchronize(fLen, shr, plan);
+  apf::synchronize(fCnt, shr, plan);
+  PCU_Plan_Free(plan);
+  delete shr;
 }
 
 apf::Field* getIsoSize(apf::Mesh* m, apf::Field* fLen, apf::Field* fCnt) {
@@ -29,6 +29,10 @@ class SInt : public apf::Integrator
     {
       PCU_Add_Doubles(&r,1);
     }
+    void merge(apf::Integrator* other)
+    {
+      r += static_cast<SInt*>(other)->r;
+    }
     void reset() {r=0;}
     double r;
 };
@@ -104,6 +108,7 @@ class SelfProduct : public SInt
     {
       v.setSize(apf::countComponents(e->eps_star));
     }
+    apf::Integrator* clone() {return new SelfProduct(estimation);}
     void inElement(apf::MeshElement* meshElement)
     {
       element = apf::createElement(estimation->eps_star, meshElement);
@@ -176,6 +181,7 @@ class Error : public ElementError
       ElementError(e)
     {
     }
+    apf::Integrator* clone() {return new Error(estimation);}
     void outElement()
     {
       ElementError::outElement();
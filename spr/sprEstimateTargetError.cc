@@ -70,6 +70,10 @@ class ScalarIntegrator : public apf::Integrator
     {
       PCU_Add_Doubles(&result,1);
     }
+    void merge(apf::Integrator* other)
+    {
+      result += static_cast<ScalarIntegrator*>(other)->result;
+    }
     double result;
 };
 
@@ -119,6 +123,7 @@ class GlobalErrorTerm : public ElementError
 {
   public:
     GlobalErrorTerm(Estimation* e) : ElementError(e) {}
+    apf::Integrator* clone() {return new GlobalErrorTerm(estimation);}
     void outElement()
     {
       ElementError::outElement();
@@ -0,0 +1,82 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <vector>
+
+/* exchanges small and large messages with node aggregation on,
+   checking every sender and payload, then partitions a box and
+   verifies the mesh, which goes through many more phases.
+   an optional argument groups that many consecutive ranks into
+   each node, so the bundles go through leaders on one machine */
+
+static int sizeFor(int from, int to)
+{
+  /* every few messages are too large to bundle */
+  if ((from + to) % 5 == 0)
+    return 5000;
+  return (from * 7 + to) % 13;
+}
+
+static void exchange()
+{
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  PCU_Comm_Begin();
+  for (int to = 0; to < peers; ++to) {
+    if ((self + to) % 3 == 1)
+      continue;
+    int n = sizeFor(self, to);
+    PCU_COMM_PACK(to, n);
+    for (int i = 0; i < n; ++i) {
+      double x = self * 1000 + to + i;
+      PCU_COMM_PACK(to, x);
+    }
+  }
+  PCU_Comm_Send();
+  std::vector<int> seen(peers, 0);
+  while (PCU_Comm_Receive()) {
+    int from = PCU_Comm_Sender();
+    int n;
+    PCU_COMM_UNPACK(n);
+    PCU_ALWAYS_ASSERT(n == sizeFor(from, self));
+    for (int i = 0; i < n; ++i) {
+      double x;
+      PCU_COMM_UNPACK(x);
+      PCU_ALWAYS_ASSERT(x == from * 1000 + self + i);
+    }
+    ++seen[from];
+  }
+  for (int from = 0; from < peers; ++from)
+    PCU_ALWAYS_ASSERT(seen[from] == ((self + from) % 3 != 1));
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  if (argc == 2)
+    setenv("PCU_RANKS_PER_NODE", argv[1], 1);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  PCU_Comm_Aggregate(true);
+  exchange();
+  PCU_Comm_Order(false);
+  exchange();
+  PCU_Comm_Order(true);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(6, 6, 6, 1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  apf::verify(m);
+  PCU_Comm_Aggregate(false);
+  exchange();
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -16,12 +16,16 @@
 #include <mth_def.h>
 #include <pcu_util.h>
 #include <ostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 /* This file contains miscellaneous tests relating to bezier shapes and
  * blended bezier shapes
  */
 
 static apf::Mesh2* makeOneTriMesh(int order, apf::MeshEntity* &ent);
 static apf::Mesh2* makeOneTetMesh(int order, apf::MeshEntity* &ent);
+static void benchmark(int type, int order);
 
 
 int main(int argc, char** argv)
@@ -29,9 +33,16 @@ int main(int argc, char** argv)
   MPI_Init(&argc,&argv);
   PCU_Comm_Init();
   lion_set_verbosity(1);
+  if ( argc == 3 ) {
+    benchmark(atoi(argv[1]), atoi(argv[2]));
+    PCU_Comm_Free();
+    MPI_Finalize();
+    return 0;
+  }
   if ( argc != 7 ) {
     if ( !PCU_Comm_Self() ) {
       printf("Usage: %s <ent_type> <order> <blend_order> <xi_0> <xi_1> <xi_2>>\n", argv[0]);
+      printf("   or: %s <ent_type> <order> to benchmark the shape kernels\n", argv[0]);
       printf("<ent_type>            can only be 2 (for triangles) and 4 (for tets)\n");
       printf("<order>               is the order of bezier\n");
       printf("<blend_order>         can be -1, 0, 1, 2 (-1 means no blending)\n");
@@ -212,3 +223,62 @@ static apf::Mesh2* makeOneTetMesh(int order, apf::MeshEntity* &ent)
   }
   return mesh;
 }
+
+/* times the shape kernels used by crv::getBezier against the
+   order-generic evaluators at the same random points, and checks
+   that both give the same values and gradients */
+static void benchmark(int type, int order)
+{
+  PCU_ALWAYS_ASSERT_VERBOSE(type == 1 || type == 2 || type == 4,
+      "<ent_type> can only be 1, 2 or 4 when benchmarking!");
+  const int npts = 100000;
+  std::vector<apf::Vector3> pts(npts);
+  srand(42);
+  for (int i = 0; i < npts; ++i) {
+    double r[3];
+    for (int d = 0; d < 3; ++d)
+      r[d] = rand() / (double)RAND_MAX;
+    if (type == 1)
+      pts[i] = apf::Vector3(2*r[0]-1, 0, 0);
+    else if (type == 2)
+      pts[i] = apf::Vector3(r[0]*(1-r[1]), r[1], 0);
+    else
+      pts[i] = apf::Vector3(r[0]*(1-r[1])*(1-r[2]), r[1]*(1-r[2]), r[2]);
+  }
+  int non = crv::getBezier(order)->getEntityShape(type)->countNodes();
+  apf::NewArray<double> vals(non), ref(non);
+  apf::NewArray<apf::Vector3> grads(non), refGrads(non);
+  double sum[2] = {0, 0};
+  // warm up both paths, the kernels build their tables on first use
+  crv::bezier[type](order, pts[0], vals);
+  crv::bezierGeneric[type](order, pts[0], ref);
+  double t0 = PCU_Time();
+  for (int i = 0; i < npts; ++i) {
+    crv::bezier[type](order, pts[i], vals);
+    crv::bezierGrads[type](order, pts[i], grads);
+    sum[0] += vals[non-1] + grads[non-1][0];
+  }
+  double t1 = PCU_Time();
+  for (int i = 0; i < npts; ++i) {
+    crv::bezierGeneric[type](order, pts[i], ref);
+    crv::bezierGenericGrads[type](order, pts[i], refGrads);
+    sum[1] += ref[non-1] + refGrads[non-1][0];
+  }
+  double t2 = PCU_Time();
+  double maxDiff = 0;
+  for (int i = 0; i < npts; i += 97) {
+    crv::bezier[type](order, pts[i], vals);
+    crv::bezierGrads[type](order, pts[i], grads);
+    crv::bezierGeneric[type](order, pts[i], ref);
+    crv::bezierGenericGrads[type](order, pts[i], refGrads);
+    for (int n = 0; n < non; ++n) {
+      maxDiff = std::max(maxDiff, std::fabs(vals[n] - ref[n]));
+      maxDiff = std::max(maxDiff, (grads[n] - refGrads[n]).getLength());
+    }
+  }
+  printf("type %d order %d: kernel %.1f ns/point, generic %.1f ns/point,"
+      " max difference %e\n", type, order,
+      (t1 - t0) / npts * 1e9, (t2 - t1) / npts * 1e9, maxDiff);
+  PCU_ALWAYS_ASSERT(maxDiff < 1e-10);
+  PCU_ALWAYS_ASSERT(std::fabs(sum[0] - sum[1]) < 1e-6 * npts);
+}
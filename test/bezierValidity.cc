@@ -6,6 +6,7 @@
 #include <gmi_analytic.h>
 #include <gmi_null.h>
 #include <apfMDS.h>
+#include <apfBox.h>
 #include <apfMesh2.h>
 #include <apf.h>
 #include <apfShape.h>
@@ -398,12 +399,70 @@ void test3D()
     } else {
       PCU_ALWAYS_ASSERT(validityTag == 1);
     }
+    // the batched check agrees with the one element check
+    ma::EntityArray tets(1);
+    tets[0] = tet;
+    apf::NewArray<int> tags;
+    crv::checkValidity(m,tets,tags);
+    PCU_ALWAYS_ASSERT(tags[0] == crv::checkValidity(m,tet,2));
     crv::getQuality(m,tet);
     m->destroyNative();
     apf::destroyMesh(m);
   }
 
 }
+/* a Bezier box with the control points of every seventh edge
+   pushed out, so some tets fail somewhere in every block of the
+   batched check. with more elements than a block and more than
+   one thread, the batched tags must match the one element ones. */
+void testBatch3D()
+{
+  for(int order = 2; order <= 3; ++order){
+    apf::Mesh2* m = apf::makeMdsBox(4,4,4,1,1,1,true);
+    apf::changeMeshShape(m, crv::getBezier(order),true);
+    int non = m->getShape()->countNodesOn(apf::Mesh::EDGE);
+    apf::MeshIterator* it = m->begin(1);
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it))) {
+      if (i++ % 7)
+        continue;
+      for (int j = 0; j < non; ++j){
+        apf::Vector3 pt;
+        m->getPoint(e,j,pt);
+        pt = pt + apf::Vector3(0.2,-0.15,0.1)*(j+1);
+        m->setPoint(e,j,pt);
+      }
+    }
+    m->end(it);
+    m->acceptChanges();
+    ma::EntityArray tets(m->count(3));
+    it = m->begin(3);
+    i = 0;
+    while ((e = m->iterate(it)))
+      tets[i++] = e;
+    m->end(it);
+    apf::NewArray<int> expected(tets.getSize());
+    int invalid = 0;
+    for (size_t t = 0; t < tets.getSize(); ++t){
+      expected[t] = crv::checkValidity(m,tets[t],2);
+      invalid += (expected[t] > 1);
+    }
+    PCU_ALWAYS_ASSERT(tets.getSize() > 32);
+    PCU_ALWAYS_ASSERT(invalid > 0 && invalid < (int)tets.getSize());
+    for (int threads = 1; threads <= 3; threads += 2){
+      crv::setValidityThreads(threads);
+      apf::NewArray<int> tags;
+      crv::checkValidity(m,tets,tags);
+      for (size_t t = 0; t < tets.getSize(); ++t)
+        PCU_ALWAYS_ASSERT(tags[t] == expected[t]);
+    }
+    crv::setValidityThreads(1);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+}
+
 int main(int argc, char** argv)
 {
   MPI_Init(&argc,&argv);
@@ -411,6 +470,7 @@ int main(int argc, char** argv)
   lion_set_verbosity(1);
   test2D();
   test3D();
+  testBatch3D();
   PCU_Comm_Free();
   MPI_Finalize();
 }
@@ -0,0 +1,122 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfCavityOp.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+/* runs cavity operators on a partitioned box with independent
+   pulls: one that needs every vertex's elements on one part,
+   which must reach every vertex once, and then mesh adaptation
+   with ma::Input::shouldPullIndependentSets. */
+
+static const int boxSize = 12;
+
+/* pulls the elements around each vertex onto one part and
+   marks the vertex there */
+class VertexCavity : public apf::CavityOp
+{
+  public:
+    VertexCavity(apf::Mesh* m, apf::MeshTag* t):
+      apf::CavityOp(m),
+      tag(t),
+      applied(0)
+    {
+      setIndependentPulls(true);
+    }
+    virtual Outcome setEntity(apf::MeshEntity* v)
+    {
+      if (mesh->hasTag(v, tag))
+        return SKIP;
+      if (!requestLocality(&v, 1))
+        return REQUEST;
+      vertex = v;
+      return OK;
+    }
+    virtual void apply()
+    {
+      PCU_ALWAYS_ASSERT(!mesh->isShared(vertex));
+      int one = 1;
+      mesh->setIntTag(vertex, tag, &one);
+      ++applied;
+    }
+    apf::MeshTag* tag;
+    long applied;
+  private:
+    apf::MeshEntity* vertex;
+};
+
+static void runVertexCavities(apf::Mesh2* m)
+{
+  long vertices = PCU_Add_Long(apf::countOwned(m, 0));
+  long elements = PCU_Add_Long(m->count(3));
+  PCU_ALWAYS_ASSERT(PCU_Or((int)m->count(0) != apf::countOwned(m, 0)));
+  apf::MeshTag* tag = m->createIntTag("cavityPulls_done", 1);
+  VertexCavity op(m, tag);
+  op.applyToDimension(0);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(op.applied) == vertices);
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(m->count(3)) == elements);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    PCU_ALWAYS_ASSERT(m->hasTag(v, tag));
+  m->end(it);
+  apf::removeTagFromDimension(m, tag, 0);
+  m->destroyTag(tag);
+  m->verify();
+}
+
+class Uniform : public ma::IsotropicFunction
+{
+  public:
+    Uniform(double s):
+      size(s)
+    {
+    }
+    virtual double getValue(ma::Entity*)
+    {
+      return size;
+    }
+  private:
+    double size;
+};
+
+static void coarsen(apf::Mesh2* m)
+{
+  long before = PCU_Add_Long(m->count(3));
+  Uniform sf(2.5 * ma::getAverageEdgeLength(m));
+  ma::Input* in = ma::makeAdvanced(ma::configure(m, &sf));
+  in->shouldPullIndependentSets = true;
+  /* coarsening a small mesh can empty parts, which parma
+     does not balance, so no balancer runs */
+  in->maximumImbalance = 1e10;
+  in->maximumIterations = 2;
+  ma::adapt(in);
+  m->verify();
+  long after = PCU_Add_Long(m->count(3));
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "coarsened from %ld to %ld elements\n", before, after);
+  PCU_ALWAYS_ASSERT(after < before);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(boxSize, boxSize, boxSize,
+      1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  runVertexCavities(m);
+  coarsen(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,107 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfConvert.h>
+#include <apfPartition.h>
+#include <apf.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+/* takes a partitioned box apart into connectivity and coordinates,
+   then builds it again twice: once with apf::construct and once by
+   calling apf::assemble on a few chunks of the connectivity on each
+   part before apf::finalise. the parts share vertices, so the
+   residence brokers and the per-chunk vertex lookups both matter,
+   and both meshes must match the box. */
+
+static void countEntities(apf::Mesh* m, long counts[4])
+{
+  for (int d = 0; d <= 3; ++d)
+    counts[d] = apf::countOwned(m, d);
+  PCU_Add_Longs(counts, 4);
+}
+
+static long countShared(apf::Mesh* m)
+{
+  long n = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it)))
+    if (m->isShared(v))
+      ++n;
+  m->end(it);
+  return PCU_Add_Long(n);
+}
+
+static apf::Mesh2* build(apf::Gid* conn, int nelem, int etype,
+    double* coords, int nverts, int chunks)
+{
+  gmi_model* model = gmi_load(".null");
+  apf::Mesh2* m = apf::makeEmptyMdsMesh(model, 3, false);
+  apf::GlobalToVert outMap;
+  if (chunks == 1) {
+    apf::construct(m, conn, nelem, etype, outMap);
+  } else {
+    int nev = apf::Mesh::adjacentCount[etype][0];
+    for (int c = 0; c < chunks; ++c) {
+      int first = nelem * c / chunks;
+      int last = nelem * (c + 1) / chunks;
+      apf::assemble(m, conn + (size_t)first * nev, last - first, etype,
+          outMap);
+    }
+    apf::finalise(m, outMap);
+  }
+  apf::alignMdsRemotes(m);
+  apf::deriveMdsModel(m);
+  apf::setCoords(m, coords, nverts, outMap);
+  m->verify();
+  return m;
+}
+
+static void check(apf::Mesh* m, long const expected[4], long shared)
+{
+  long counts[4];
+  countEntities(m, counts);
+  for (int d = 0; d <= 3; ++d)
+    PCU_ALWAYS_ASSERT(counts[d] == expected[d]);
+  PCU_ALWAYS_ASSERT(countShared(m) == shared);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(5, 4, 3, 1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  long expected[4];
+  countEntities(m, expected);
+  long shared = countShared(m);
+  PCU_ALWAYS_ASSERT(PCU_Comm_Peers() == 1 || shared > 0);
+  apf::Gid* conn;
+  double* coords;
+  int nelem;
+  int etype;
+  int nverts;
+  apf::extractCoords(m, coords, nverts);
+  apf::destruct(m, conn, nelem, etype);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  int chunks[2] = {1, 3};
+  for (int i = 0; i < 2; ++i) {
+    m = build(conn, nelem, etype, coords, nverts, chunks[i]);
+    check(m, expected, shared);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  delete [] conn;
+  delete [] coords;
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -63,7 +63,7 @@ bool testReduce(apf::Mesh* m, int casenum)
 {
 
   double addval = 0;
-  if (casenum == 0)  // sum
+  if (casenum == 0 || casenum >= 3)  // sum
     addval = 0;
   else
     addval = myrank;
@@ -80,6 +80,19 @@ bool testReduce(apf::Mesh* m, int casenum)
     apf::sharedReduction(f, shr, false, apf::ReductionMax<double>());
   else if (casenum == 2)
     apf::sharedReduction(f, shr, false, apf::ReductionMin<double>());
+  else if (casenum == 3)
+  {
+    pcu_plan* plan = apf::makeNeighborPlan(m, shr);
+    apf::accumulate(f, shr, false, plan);
+    PCU_Plan_Free(plan);
+  }
+  else if (casenum == 4)
+  {
+    apf::freeze(f);
+    apf::HaloPlan* halo = apf::makeHaloPlan(m, fshape, shr);
+    apf::accumulateHalo(halo, f);
+    apf::destroyHaloPlan(halo);
+  }
 
   // verify the result is n times the number of copies
   apf::MeshEntity* e;
@@ -119,7 +132,7 @@ bool testReduce(apf::Mesh* m, int casenum)
         }
 
         // do the test
-        if (casenum == 0)
+        if (casenum == 0 || casenum >= 3)
         {
           double val = getValue(coords, addval);
           failflag = ( failflag || ( std::fabs(ntimes*val - val_f) > 1e-13 ) );
@@ -185,7 +198,7 @@ int main(int argc, char** argv)
   m = apf::loadMdsMesh(g, meshFile);
 
   bool failflag = false;
-  for (int i=0; i < 3; ++i)
+  for (int i=0; i < 5; ++i)
     failflag = failflag || testReduce(m, i);
 
   freeMesh(m);
@@ -0,0 +1,127 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfPartition.h>
+#include <parma.h>
+#include <pumi.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* synchronizes frozen quadratic fields through an apf::HaloPlan on a
+   partitioned box with a layer of ghost elements. only owned nodes
+   start with their values, the copies and ghosts get them from the
+   exchange, first for two fields at once and then for one. */
+
+static apf::Vector3 getNodePoint(apf::Mesh* m, apf::MeshEntity* e)
+{
+  if (m->getType(e) == apf::Mesh::VERTEX) {
+    apf::Vector3 x;
+    m->getPoint(e, 0, x);
+    return x;
+  }
+  return apf::getLinearCentroid(m, e);
+}
+
+static double getValue(apf::Vector3 const& x, int component)
+{
+  return x[0] + 2 * x[1] + 3 * x[2] + 10 * component;
+}
+
+/* owned nodes get their values, every other node gets garbage */
+static void fill(apf::Mesh* m, apf::Field* f)
+{
+  int nc = apf::countComponents(f);
+  apf::NewArray<double> values(nc);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = getNodePoint(m, e);
+      for (int c = 0; c < nc; ++c)
+        values[c] = m->isOwned(e) ? getValue(x, c) : -1;
+      apf::setComponents(f, e, 0, &values[0]);
+    }
+    m->end(it);
+  }
+}
+
+static void check(apf::Mesh* m, apf::Field* f)
+{
+  int nc = apf::countComponents(f);
+  apf::NewArray<double> values(nc);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = getNodePoint(m, e);
+      apf::getComponents(f, e, 0, &values[0]);
+      for (int c = 0; c < nc; ++c)
+        PCU_ALWAYS_ASSERT(std::fabs(values[c] - getValue(x, c)) < 1e-12);
+    }
+    m->end(it);
+  }
+}
+
+static void countCopies(apf::Mesh* m)
+{
+  long shared = 0;
+  long ghosts = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (m->isGhost(e))
+      ++ghosts;
+    else if (!m->isOwned(e))
+      ++shared;
+  }
+  m->end(it);
+  shared = PCU_Add_Long(shared);
+  ghosts = PCU_Add_Long(ghosts);
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%ld shared and %ld ghost vertex copies\n",
+        shared, ghosts);
+  PCU_ALWAYS_ASSERT(shared > 0);
+  PCU_ALWAYS_ASSERT(ghosts > 0);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(6, 6, 6, 1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  /* pumi ghosting works on the mesh pumi knows about */
+  pumi_mesh_load(m);
+  pumi_ghost_createLayer(m, 0, 3, 1, 1);
+  countCopies(m);
+  apf::FieldShape* shape = apf::getLagrange(2);
+  apf::Field* fields[2];
+  fields[0] = apf::createField(m, "haloSync_scalar", apf::SCALAR, shape);
+  fields[1] = apf::createField(m, "haloSync_vector", apf::VECTOR, shape);
+  for (int i = 0; i < 2; ++i) {
+    apf::freeze(fields[i]);
+    fill(m, fields[i]);
+  }
+  apf::HaloPlan* halo = apf::makeHaloPlan(m, shape);
+  apf::synchronizeHalo(halo, fields, 2);
+  for (int i = 0; i < 2; ++i)
+    check(m, fields[i]);
+  fill(m, fields[1]);
+  apf::synchronizeHalo(halo, fields[1]);
+  check(m, fields[1]);
+  apf::destroyHaloPlan(halo);
+  for (int i = 0; i < 2; ++i)
+    apf::destroyField(fields[i]);
+  pumi_ghost_delete(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,182 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+/* measures every edge through a metric size field, which keeps
+   the lengths in its own cache, then changes the metric fields
+   directly and moves a vertex. the lengths measured next must
+   equal the ones measured again after dropping the cache.
+   two size fields measuring the same mesh must not leave
+   anything on it. */
+
+static void getMetric(apf::Mesh2* m, apf::MeshEntity* v,
+    ma::Matrix& r, ma::Vector& h)
+{
+  ma::Vector x = ma::getPosition(m, v);
+  double c = cos(x[1]);
+  double s = sin(x[1]);
+  r = ma::Matrix(c, -s, 0,
+                 s,  c, 0,
+                 0,  0, 1);
+  h = ma::Vector(0.1 + 0.1 * x[0], 0.2, 0.15 + 0.05 * x[2]);
+}
+
+static void measureAll(ma::SizeField* sf, apf::Mesh* m,
+    std::vector<double>& lengths)
+{
+  lengths.clear();
+  apf::MeshIterator* it = m->begin(1);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    lengths.push_back(sf->measure(e));
+  m->end(it);
+}
+
+/* the vertices whose metric changes, every third one */
+static bool isChanged(int i)
+{
+  return i % 3 == 0;
+}
+
+static void changeMetric(apf::Mesh* m, apf::Field* sizes,
+    apf::Field* logM)
+{
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  int i = 0;
+  while ((v = m->iterate(it))) {
+    if (isChanged(i++)) {
+      if (logM) {
+        ma::Matrix l;
+        apf::getMatrix(logM, v, 0, l);
+        apf::setMatrix(logM, v, 0, l + apf::Matrix3x3(0.3, 0, 0,
+                                                      0, 0.3, 0,
+                                                      0, 0, 0.3));
+      } else {
+        ma::Vector h;
+        apf::getVector(sizes, v, 0, h);
+        apf::setVector(sizes, v, 0, h * 0.5);
+      }
+    }
+  }
+  m->end(it);
+}
+
+/* a uniform metric, the size field made from it owns both fields */
+static ma::SizeField* makeUniform(apf::Mesh2* m, const char* name, double h)
+{
+  std::string sizesName = std::string(name) + "_sizes";
+  std::string framesName = std::string(name) + "_frames";
+  apf::Field* sizes = apf::createFieldOn(m, sizesName.c_str(), apf::VECTOR);
+  apf::Field* frames = apf::createFieldOn(m, framesName.c_str(),
+      apf::MATRIX);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::setVector(sizes, v, 0, ma::Vector(h, h, h));
+    apf::setMatrix(frames, v, 0, apf::Matrix3x3(1, 0, 0,
+                                                0, 1, 0,
+                                                0, 0, 1));
+  }
+  m->end(it);
+  return ma::makeSizeField(m, sizes, frames);
+}
+
+static void checkTwoFields(apf::Mesh2* m)
+{
+  ma::SizeField* a = makeUniform(m, "maLengthCache_coarse", 0.4);
+  ma::SizeField* b = makeUniform(m, "maLengthCache_fine", 0.1);
+  /* the metric fields are tags themselves, count the rest */
+  apf::DynamicArray<apf::MeshTag*> tags;
+  m->getTags(tags);
+  size_t ntags = tags.getSize();
+  std::vector<double> la;
+  std::vector<double> lb;
+  measureAll(a, m, la);
+  measureAll(b, m, lb);
+  for (size_t i = 0; i < la.size(); ++i)
+    PCU_ALWAYS_ASSERT(std::fabs(lb[i] - 4 * la[i]) < 1e-10 * lb[i]);
+  measureAll(a, m, lb);
+  PCU_ALWAYS_ASSERT(la == lb);
+  m->getTags(tags);
+  PCU_ALWAYS_ASSERT(tags.getSize() == ntags);
+  apf::verify(m);
+  delete a;
+  delete b;
+}
+
+static void check(apf::Mesh2* m, bool logInterpolation)
+{
+  apf::Field* sizes = apf::createFieldOn(m, "maLengthCache_sizes",
+      apf::VECTOR);
+  apf::Field* frames = apf::createFieldOn(m, "maLengthCache_frames",
+      apf::MATRIX);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    ma::Matrix r;
+    ma::Vector h;
+    getMetric(m, v, r, h);
+    apf::setVector(sizes, v, 0, h);
+    apf::setMatrix(frames, v, 0, r);
+  }
+  m->end(it);
+  ma::SizeField* sf = ma::makeSizeField(m, sizes, frames, logInterpolation);
+  std::vector<double> before;
+  std::vector<double> cached;
+  measureAll(sf, m, before);
+  measureAll(sf, m, cached);
+  PCU_ALWAYS_ASSERT(before == cached);
+  /* the log size field interpolates its own copy of the metric */
+  apf::Field* logM = 0;
+  if (logInterpolation)
+    logM = m->findField("ma_logM");
+  changeMetric(m, sizes, logM);
+  it = m->begin(0);
+  v = m->iterate(it);
+  m->end(it);
+  ma::Vector x = ma::getPosition(m, v);
+  m->setPoint(v, 0, x + ma::Vector(0.01, 0.02, 0.03));
+  std::vector<double> after;
+  std::vector<double> fresh;
+  measureAll(sf, m, after);
+  sf->dropCache();
+  measureAll(sf, m, fresh);
+  PCU_ALWAYS_ASSERT(after == fresh);
+  size_t changed = 0;
+  for (size_t i = 0; i < after.size(); ++i)
+    if (after[i] != before[i])
+      ++changed;
+  PCU_ALWAYS_ASSERT(changed > after.size() / 3);
+  m->setPoint(v, 0, x);
+  sf->dropCache();
+  delete sf;
+  /* the plain size field destroys the fields it was made from */
+  if (logInterpolation) {
+    apf::destroyField(sizes);
+    apf::destroyField(frames);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBox(6, 6, 6, 1, 1, 1, true);
+  check(m, false);
+  check(m, true);
+  checkTwoFields(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,119 @@
+#include <ma.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+/* adapts the same box twice, once sweeping the whole mesh for
+   candidates and once from worklists, and checks that both
+   give the same entities in the same order */
+
+class Graded : public ma::IsotropicFunction
+{
+  public:
+    Graded(ma::Mesh* m):
+      mesh(m)
+    {
+      average = ma::getAverageEdgeLength(m);
+    }
+    virtual double getValue(ma::Entity* v)
+    {
+      ma::Vector p = ma::getPosition(mesh, v);
+      /* fine near x = 0, coarse near x = 1 */
+      return average * (0.3 + 2 * p[0] * p[0]);
+    }
+  private:
+    ma::Mesh* mesh;
+    double average;
+};
+
+static apf::Mesh2* adaptBox(bool worklists)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true);
+  Graded sf(m);
+  ma::Input* in = ma::makeAdvanced(ma::configure(m, &sf));
+  in->shouldUseWorklists = worklists;
+  in->maximumIterations = 3;
+  ma::adapt(in);
+  m->verify();
+  return m;
+}
+
+/* numbers the vertices in iteration order */
+static apf::MeshTag* numberVertices(apf::Mesh2* m)
+{
+  apf::MeshTag* t = m->createIntTag("maWorklists_index", 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  int i = 0;
+  while ((v = m->iterate(it))) {
+    m->setIntTag(v, t, &i);
+    ++i;
+  }
+  m->end(it);
+  return t;
+}
+
+static void compare(apf::Mesh2* a, apf::Mesh2* b)
+{
+  for (int d = 0; d <= 3; ++d)
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+  apf::MeshIterator* ia = a->begin(0);
+  apf::MeshIterator* ib = b->begin(0);
+  apf::MeshEntity* va;
+  apf::MeshEntity* vb;
+  while ((va = a->iterate(ia))) {
+    vb = b->iterate(ib);
+    apf::Vector3 pa;
+    apf::Vector3 pb;
+    a->getPoint(va, 0, pa);
+    b->getPoint(vb, 0, pb);
+    PCU_ALWAYS_ASSERT(pa[0] == pb[0] && pa[1] == pb[1] && pa[2] == pb[2]);
+  }
+  a->end(ia);
+  b->end(ib);
+  apf::MeshTag* ta = numberVertices(a);
+  apf::MeshTag* tb = numberVertices(b);
+  ia = a->begin(3);
+  ib = b->begin(3);
+  while ((va = a->iterate(ia))) {
+    vb = b->iterate(ib);
+    apf::Downward da;
+    apf::Downward db;
+    int n = a->getDownward(va, 0, da);
+    b->getDownward(vb, 0, db);
+    for (int i = 0; i < n; ++i) {
+      int ka, kb;
+      a->getIntTag(da[i], ta, &ka);
+      b->getIntTag(db[i], tb, &kb);
+      PCU_ALWAYS_ASSERT(ka == kb);
+    }
+  }
+  a->end(ia);
+  b->end(ib);
+  apf::removeTagFromDimension(a, ta, 0);
+  apf::removeTagFromDimension(b, tb, 0);
+  a->destroyTag(ta);
+  b->destroyTag(tb);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* swept = adaptBox(false);
+  apf::Mesh2* listed = adaptBox(true);
+  compare(swept, listed);
+  swept->destroyNative();
+  apf::destroyMesh(swept);
+  listed->destroyNative();
+  apf::destroyMesh(listed);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
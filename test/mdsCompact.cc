@@ -0,0 +1,153 @@
+#include <gmi_mesh.h>
+#include <apfMDS.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+#include <cstdlib>
+
+/* checks that compacting a mesh with holes keeps the iteration
+   order, tags and remote copies, and makes the indices dense */
+
+struct Removed
+{
+  int type;
+  apf::ModelEntity* c;
+  apf::Downward verts;
+};
+
+/* moves elements to the next part in parallel, which leaves holes.
+   in serial the elements and their unused edges and faces are
+   destroyed, and fillHoles rebuilds them */
+static void makeHoles(apf::Mesh2* m, std::vector<Removed>& removed)
+{
+  int dim = m->getDimension();
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  std::vector<apf::MeshEntity*> doomed;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    if (i++ % 3 == 0)
+      doomed.push_back(e);
+  m->end(it);
+  if (PCU_Comm_Peers() > 1) {
+    apf::Migration* plan = new apf::Migration(m);
+    int to = (PCU_Comm_Self() + 1) % PCU_Comm_Peers();
+    for (size_t j = 0; j < doomed.size(); ++j)
+      plan->send(doomed[j], to);
+    m->migrate(plan);
+    return;
+  }
+  for (int d = dim; d > 0; --d) {
+    if (d < dim) {
+      doomed.clear();
+      it = m->begin(d);
+      while ((e = m->iterate(it)))
+        if (!m->countUpward(e))
+          doomed.push_back(e);
+      m->end(it);
+    }
+    for (size_t j = 0; j < doomed.size(); ++j) {
+      Removed r;
+      r.type = m->getType(doomed[j]);
+      r.c = m->toModel(doomed[j]);
+      m->getDownward(doomed[j], 0, r.verts);
+      removed.push_back(r);
+      m->destroy(doomed[j]);
+    }
+  }
+}
+
+/* rebuilds edges and faces first to keep their classification */
+static void fillHoles(apf::Mesh2* m, std::vector<Removed>& removed)
+{
+  for (size_t i = removed.size(); i > 0; --i) {
+    Removed& r = removed[i - 1];
+    apf::buildElement(m, r.c, r.type, r.verts);
+  }
+  removed.clear();
+}
+
+static void tagPoints(apf::Mesh2* m, apf::MeshTag* t)
+{
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    double d[3] = {x[0], x[1], x[2]};
+    m->setDoubleTag(v, t, d);
+  }
+  m->end(it);
+}
+
+static void getCentroids(apf::Mesh2* m, int d, std::vector<apf::Vector3>& c)
+{
+  apf::MeshIterator* it = m->begin(d);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    c.push_back(apf::getLinearCentroid(m, e));
+  m->end(it);
+}
+
+static void check(apf::Mesh2* m, apf::MeshTag* t,
+    std::vector<apf::Vector3> before[4])
+{
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    std::vector<apf::Vector3> after;
+    getCentroids(m, d, after);
+    PCU_ALWAYS_ASSERT(after.size() == before[d].size());
+    for (size_t i = 0; i < after.size(); ++i)
+      PCU_ALWAYS_ASSERT((after[i] - before[d][i]).getLength() == 0);
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    int i = 0;
+    while ((e = m->iterate(it))) {
+      PCU_ALWAYS_ASSERT(apf::getMdsIndex(m, e) == i);
+      PCU_ALWAYS_ASSERT(apf::getMdsEntity(m, d, i) == e);
+      ++i;
+      if (d)
+        continue;
+      double x[3];
+      m->getDoubleTag(e, t, x);
+      apf::Vector3 p;
+      m->getPoint(e, 0, p);
+      PCU_ALWAYS_ASSERT((apf::Vector3(x) - p).getLength() == 0);
+    }
+    m->end(it);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  PCU_ALWAYS_ASSERT(argc == 3);
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::loadMdsMesh(argv[1], argv[2]);
+  apf::MeshTag* t = m->createDoubleTag("point", 3);
+  std::vector<Removed> removed;
+  makeHoles(m, removed);
+  tagPoints(m, t);
+  std::vector<apf::Vector3> before[4];
+  for (int d = 0; d <= m->getDimension(); ++d)
+    getCentroids(m, d, before[d]);
+  apf::compactMdsMesh(m);
+  check(m, t, before);
+  /* the compacted arrays must still grow */
+  fillHoles(m, removed);
+  apf::verify(m);
+  makeHoles(m, removed);
+  apf::compactMdsMesh(m);
+  fillHoles(m, removed);
+  apf::verify(m);
+  apf::removeTagFromDimension(m, t, 0);
+  m->destroyTag(t);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
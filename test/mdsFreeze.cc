@@ -0,0 +1,80 @@
+#include <gmi_mesh.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <vector>
+
+/* checks that the frozen MDS arrays list the same adjacencies
+   as the regular queries, and that changing the mesh frees them */
+
+static std::vector<apf::MeshEntity*> sorted(apf::MdsSpan s)
+{
+  std::vector<apf::MeshEntity*> v;
+  for (int i = 0; i < s.getSize(); ++i)
+    v.push_back(s[i]);
+  std::sort(v.begin(), v.end());
+  return v;
+}
+
+static std::vector<apf::MeshEntity*> sorted(apf::Adjacent& a)
+{
+  std::vector<apf::MeshEntity*> v(a.begin(), a.end());
+  std::sort(v.begin(), v.end());
+  return v;
+}
+
+static void checkFrozen(apf::Mesh2* m)
+{
+  int dim = m->getDimension();
+  apf::MeshEntity* e;
+  for (int d = 0; d < dim; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Adjacent adj;
+      m->getAdjacent(e, dim, adj);
+      PCU_ALWAYS_ASSERT(sorted(adj) == sorted(apf::getMdsElements(m, e)));
+    }
+    m->end(it);
+  }
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    apf::Adjacent adj;
+    apf::getBridgeAdjacent(m, e, dim - 1, dim, adj);
+    PCU_ALWAYS_ASSERT(sorted(adj) == sorted(apf::getMdsNeighbors(m, e)));
+  }
+  m->end(it);
+}
+
+static void test(bool simplex)
+{
+  apf::Mesh2* m = apf::makeMdsBox(3, 4, 2, 1, 1, 1, simplex);
+  apf::freezeMdsTopology(m);
+  PCU_ALWAYS_ASSERT(apf::isMdsTopologyFrozen(m));
+  checkFrozen(m);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v = m->iterate(it);
+  m->end(it);
+  apf::Vector3 x;
+  m->getPoint(v, 0, x);
+  m->createVertex(m->toModel(v), x, apf::Vector3(0, 0, 0));
+  PCU_ALWAYS_ASSERT(!apf::isMdsTopologyFrozen(m));
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc,&argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  test(true);
+  test(false);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,95 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+
+/* writes a mesh made on one rank to a shared smb file,
+   reads it back on all ranks, spreads it out and round
+   trips the result */
+
+static void spread(apf::Mesh2* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  int i = 0;
+  while ((e = m->iterate(it)))
+    plan->send(e, i++ % PCU_Comm_Peers());
+  m->end(it);
+  m->migrate(plan);
+}
+
+static void getTotals(apf::Mesh2* m, long counts[4], double& sum)
+{
+  for (int d = 0; d < 4; ++d)
+    counts[d] = apf::countOwned(m, d);
+  PCU_Add_Longs(counts, 4);
+  sum = 0;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    if (!m->isOwned(v))
+      continue;
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    sum += x[0] + 2 * x[1] + 3 * x[2];
+  }
+  m->end(it);
+  sum = PCU_Add_Double(sum);
+}
+
+static void check(apf::Mesh2* m, long counts[4], double sum)
+{
+  long c[4];
+  double s;
+  apf::verify(m);
+  getTotals(m, c, s);
+  for (int d = 0; d < 4; ++d)
+    PCU_ALWAYS_ASSERT(c[d] == counts[d]);
+  PCU_ALWAYS_ASSERT(std::abs(s - sum) < 1e-10 * std::abs(sum));
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_null();
+  const char* path = "mdsShared.smbs";
+  long counts[4];
+  double sum;
+  MPI_Comm all = PCU_Get_Comm();
+  MPI_Comm one;
+  int self = PCU_Comm_Self();
+  MPI_Comm_split(all, self != 0, 0, &one);
+  PCU_Switch_Comm(one);
+  if (!self) {
+    apf::Mesh2* m = apf::makeMdsBox(4, 3, 2, 1, 1, 1, true);
+    getTotals(m, counts, sum);
+    m->writeNative(path);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  PCU_Switch_Comm(all);
+  MPI_Comm_free(&one);
+  MPI_Bcast(counts, 4, MPI_LONG, 0, all);
+  MPI_Bcast(&sum, 1, MPI_DOUBLE, 0, all);
+  gmi_model* g = gmi_load(".null");
+  apf::Mesh2* m = apf::loadMdsMesh(g, path);
+  check(m, counts, sum);
+  spread(m);
+  m->writeNative(path);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::loadMdsMesh(gmi_load(".null"), path);
+  check(m, counts, sum);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
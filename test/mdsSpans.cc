@@ -0,0 +1,106 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* checks the bulk point and connectivity spans of an MDS mesh
+   against per-entity queries, with and without holes */
+
+static void checkPoints(apf::Mesh2* m)
+{
+  apf::MeshSpan<double> points;
+  m->getPoints(points);
+  PCU_ALWAYS_ASSERT(points.getSize() == m->count(0) * 3);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  size_t i = 0;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(points[i * 3 + j] == x[j]);
+    ++i;
+  }
+  m->end(it);
+}
+
+static void checkVertices(apf::Mesh2* m, int type)
+{
+  std::vector<apf::MeshEntity*> verts;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    verts.push_back(e);
+  m->end(it);
+  apf::MeshSpan<int> conn;
+  m->getElementVertices(type, conn);
+  int nv = apf::Mesh::adjacentCount[type][0];
+  PCU_ALWAYS_ASSERT(conn.getSize() ==
+      size_t(apf::countEntitiesOfType(m, type) * nv));
+  it = m->begin(apf::Mesh::typeDimension[type]);
+  size_t i = 0;
+  while ((e = m->iterate(it))) {
+    if (m->getType(e) != type)
+      continue;
+    apf::Downward dv;
+    m->getDownward(e, 0, dv);
+    for (int j = 0; j < nv; ++j)
+      PCU_ALWAYS_ASSERT(verts[conn[i++]] == dv[j]);
+  }
+  m->end(it);
+}
+
+static void check(apf::Mesh2* m)
+{
+  checkPoints(m);
+  for (int t = 0; t < apf::Mesh::TYPES; ++t)
+    if (apf::Mesh::typeDimension[t] <= m->getDimension())
+      checkVertices(m, t);
+}
+
+/* removes the first half of the elements and the lower entities
+   they leave unused, so that the vertex array has holes */
+static void makeHoles(apf::Mesh2* m)
+{
+  int dim = m->getDimension();
+  for (int d = dim; d >= 0; --d) {
+    std::vector<apf::MeshEntity*> doomed;
+    apf::MeshIterator* it = m->begin(d);
+    apf::MeshEntity* e;
+    size_t half = m->count(d) / 2;
+    size_t i = 0;
+    while ((e = m->iterate(it)))
+      if (d == dim ? (i++ < half) : !m->countUpward(e))
+        doomed.push_back(e);
+    m->end(it);
+    for (size_t j = 0; j < doomed.size(); ++j)
+      m->destroy(doomed[j]);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_null();
+  for (int simplex = 0; simplex < 2; ++simplex) {
+    apf::Mesh2* m = apf::makeMdsBox(3, 4, 2, 1, 1, 1, simplex);
+    check(m);
+    size_t before = m->count(0);
+    makeHoles(m);
+    PCU_ALWAYS_ASSERT(m->count(0) < before);
+    check(m);
+    apf::compactMdsMesh(m);
+    check(m);
+    m->destroyNative();
+    apf::destroyMesh(m);
+  }
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,135 @@
+#include <gmi_null.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <mds_apf.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <vector>
+
+/* checks lookup of MDS tags by name through creation, renaming,
+   destruction, reordering and growth of the name table, and the
+   bulk range accessors */
+
+static void checkNames(apf::Mesh2* m, std::vector<apf::MeshTag*>& tags)
+{
+  for (size_t i = 0; i < tags.size(); ++i)
+    if (tags[i])
+      PCU_ALWAYS_ASSERT(m->findTag(m->getTagName(tags[i])) == tags[i]);
+}
+
+static void testNames(apf::Mesh2* m)
+{
+  std::vector<apf::MeshTag*> tags;
+  char name[32];
+  for (int i = 0; i < 40; ++i) {
+    sprintf(name, "tag_%d", i);
+    tags.push_back(m->createIntTag(name, 1));
+  }
+  checkNames(m, tags);
+  for (int i = 0; i < 40; i += 3) {
+    sprintf(name, "renamed_%d", i);
+    m->renameTag(tags[i], name);
+    sprintf(name, "tag_%d", i);
+    PCU_ALWAYS_ASSERT(!m->findTag(name));
+  }
+  for (int i = 1; i < 40; i += 4) {
+    m->destroyTag(tags[i]);
+    tags[i] = 0;
+  }
+  checkNames(m, tags);
+  apf::reorderMdsMesh(m);
+  checkNames(m, tags);
+  for (size_t i = 0; i < tags.size(); ++i)
+    if (tags[i])
+      m->destroyTag(tags[i]);
+  PCU_ALWAYS_ASSERT(!m->findTag("tag_0"));
+}
+
+/* apf refuses to create a tag name twice, but MDS keeps both tags
+   and finds the newest one, also after the table has grown */
+static void testDuplicates()
+{
+  mds_tags ts;
+  mds_create_tags(&ts);
+  mds_tag* older = mds_create_tag(&ts, "dup", sizeof(int), 0);
+  mds_tag* newer = mds_create_tag(&ts, "dup", sizeof(int), 0);
+  PCU_ALWAYS_ASSERT(mds_find_tag(&ts, "dup") == newer);
+  unsigned size = ts.table_size;
+  char name[32];
+  for (int i = 0; i < 40; ++i) {
+    sprintf(name, "other_%d", i);
+    mds_create_tag(&ts, name, sizeof(int), 0);
+  }
+  PCU_ALWAYS_ASSERT(ts.table_size > size);
+  PCU_ALWAYS_ASSERT(mds_find_tag(&ts, "dup") == newer);
+  mds_destroy_tag(&ts, newer);
+  PCU_ALWAYS_ASSERT(mds_find_tag(&ts, "dup") == older);
+  mds_destroy_tags(&ts);
+}
+
+static void testGhostFlag(apf::Mesh2* m)
+{
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v = m->iterate(it);
+  m->end(it);
+  PCU_ALWAYS_ASSERT(!m->isGhost(v));
+  apf::MeshTag* t = m->createIntTag("ghost_tag", 1);
+  int one = 1;
+  m->setIntTag(v, t, &one);
+  PCU_ALWAYS_ASSERT(m->isGhost(v));
+  m->removeTag(v, t);
+  m->destroyTag(t);
+  PCU_ALWAYS_ASSERT(!m->isGhost(v));
+}
+
+static void testRange(apf::Mesh2* m, int dim)
+{
+  apf::MeshTag* t = m->createIntTag("range", 2);
+  int n = m->count(dim);
+  int first = n / 4;
+  int count = n / 2;
+  std::vector<int> in(count * 2);
+  for (int i = 0; i < count * 2; ++i)
+    in[i] = i;
+  apf::setMdsTagRange(m, t, dim, first, count, &in[0]);
+  apf::MeshIterator* it = m->begin(dim);
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    int i = apf::getMdsIndex(m, e);
+    bool inRange = first <= i && i < first + count;
+    PCU_ALWAYS_ASSERT(m->hasTag(e, t) == inRange);
+    if (!inRange)
+      continue;
+    int x[2];
+    m->getIntTag(e, t, x);
+    PCU_ALWAYS_ASSERT(x[0] == (i - first) * 2 && x[1] == x[0] + 1);
+  }
+  m->end(it);
+  std::vector<int> out(count * 2);
+  apf::getMdsTagRange(m, t, dim, first, count, &out[0]);
+  PCU_ALWAYS_ASSERT(out == in);
+  apf::removeTagFromDimension(m, t, dim);
+  m->destroyTag(t);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_null();
+  apf::Mesh2* m = apf::makeMdsBox(3, 4, 2, 1, 1, 1, true);
+  testNames(m);
+  testDuplicates();
+  testGhostFlag(m);
+  for (int d = 0; d <= m->getDimension(); ++d)
+    testRange(m, d);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,270 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfPartition.h>
+#include <apf.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <limits.h>
+#include <set>
+#include <vector>
+#include "parma_dijkstra.h"
+#include "parma_distQ.h"
+#include "parma_graphDist.h"
+
+/* compares the vertex distances of parma::dijkstra, which walks a
+   parma::LevelQueue over dense vertex indices, with the walk it
+   replaced: a parma::DistanceQueue of mesh entities and a cavity
+   walk over sets of edges. the box is split with global RIB so the
+   part boundary vertices take the non-manifold cavity walk. both a
+   walk from one source and a walk restarted from many sources at
+   different distances, as the distance update does, must agree on
+   every vertex. */
+
+static bool onBoundary(apf::Mesh* m, apf::MeshEntity* v)
+{
+  return m->isShared(v) ||
+    m->getModelType(m->toModel(v)) < m->getDimension();
+}
+
+/* all vertices but a wall across the lower half of the box */
+static bool outsideWall(apf::Mesh* m, apf::MeshEntity* v)
+{
+  apf::Vector3 x;
+  m->getPoint(v, 0, x);
+  return !(0.4 < x[0] && x[0] < 0.6 && x[1] < 0.7);
+}
+
+class Contains : public parma::DijkstraContains {
+  public:
+    Contains(apf::Mesh* m, parma::VtxGraph& g, bool wall)
+      : useBdry(true)
+    {
+      in.resize(g.size());
+      bdry.resize(g.size());
+      for (int i = 0; i < g.size(); ++i) {
+        in[i] = !wall || outsideWall(m, g.vertex(i));
+        bdry[i] = onBoundary(m, g.vertex(i));
+      }
+    }
+    bool has(int v) { return in[v]; }
+    bool bdryHas(int v) { return useBdry && bdry[v]; }
+    bool useBdry;
+  private:
+    std::vector<bool> in;
+    std::vector<bool> bdry;
+};
+
+/* the previous walk, kept here as the reference */
+namespace reference {
+
+typedef std::set<apf::MeshEntity*> Ents;
+
+struct Walk {
+  apf::Mesh* m;
+  parma::VtxGraph* g;
+  Contains* c;
+  std::vector<int>* dist;
+  bool has(apf::MeshEntity* v) { return c->has(g->index(v)); }
+  bool bdryHas(apf::MeshEntity* v) { return c->bdryHas(g->index(v)); }
+  int& d(apf::MeshEntity* v) { return (*dist)[g->index(v)]; }
+};
+
+static void getCavityEdges(Walk& w, apf::MeshEntity* v, Ents& ce)
+{
+  apf::Adjacent elms;
+  w.m->getAdjacent(v, w.m->getDimension(), elms);
+  APF_ITERATE(apf::Adjacent, elms, elm) {
+    apf::Downward edges;
+    int ne = w.m->getDownward(*elm, 1, edges);
+    for (int j = 0; j < ne; ++j) {
+      apf::Downward verts;
+      w.m->getDownward(edges[j], 0, verts);
+      if (w.has(verts[0]) && w.has(verts[1]))
+        ce.insert(edges[j]);
+    }
+  }
+}
+
+static apf::MeshEntity* parentVtx(Walk& w, apf::MeshEntity* u)
+{
+  apf::Adjacent adjVtx;
+  apf::getBridgeAdjacent(w.m, u, 1, 0, adjVtx);
+  APF_ITERATE(apf::Adjacent, adjVtx, v)
+    if (w.d(*v) == w.d(u) - 1 && w.has(*v))
+      return *v;
+  return 0;
+}
+
+static void walkCavEdges(Walk& w, Ents& ce, apf::MeshEntity* p,
+    apf::MeshEntity* s, std::vector<apf::MeshEntity*>& adjVtx)
+{
+  Ents visited;
+  Ents cur;
+  Ents next;
+  next.insert(p);
+  while (!next.empty()) {
+    cur = next;
+    next.clear();
+    APF_ITERATE(Ents, cur, vtxItr) {
+      apf::MeshEntity* u = *vtxItr;
+      if (visited.count(u))
+        continue;
+      visited.insert(u);
+      apf::Up edges;
+      w.m->getUp(u, edges);
+      for (int i = 0; i < edges.n; ++i) {
+        if (!ce.count(edges.e[i]))
+          continue;
+        apf::MeshEntity* v =
+          apf::getEdgeVertOppositeVert(w.m, edges.e[i], u);
+        if (v != s && !visited.count(v) && !cur.count(v)) {
+          next.insert(v);
+          adjVtx.push_back(v);
+        }
+      }
+    }
+  }
+}
+
+static void getConnectedVtx(Walk& w, apf::MeshEntity* u,
+    std::vector<apf::MeshEntity*>& adjVtx)
+{
+  if (w.bdryHas(u)) {
+    apf::MeshEntity* p = parentVtx(w, u);
+    if (p) {
+      Ents ce;
+      getCavityEdges(w, u, ce);
+      walkCavEdges(w, ce, p, u, adjVtx);
+    }
+  }
+  if (adjVtx.empty()) {
+    apf::Adjacent adj;
+    apf::getBridgeAdjacent(w.m, u, 1, 0, adj);
+    APF_ITERATE(apf::Adjacent, adj, v)
+      adjVtx.push_back(*v);
+  }
+}
+
+static void dijkstra(Walk& w, parma::DistanceQueue<parma::Less>& pq)
+{
+  while (!pq.empty()) {
+    apf::MeshEntity* v = pq.pop();
+    if (!w.has(v))
+      continue;
+    int vd = w.d(v);
+    PCU_ALWAYS_ASSERT(vd >= 0 && vd != INT_MAX);
+    std::vector<apf::MeshEntity*> adjVtx;
+    getConnectedVtx(w, v, adjVtx);
+    for (size_t i = 0; i < adjVtx.size(); ++i) {
+      apf::MeshEntity* u = adjVtx[i];
+      if (vd + 1 < w.d(u) && w.has(u)) {
+        w.d(u) = vd + 1;
+        pq.push(u, vd + 1);
+      }
+    }
+  }
+}
+
+}
+
+/* the sources of the distance update: the vertices next to the
+   part and model boundary keep their distance, the boundary
+   vertices start over */
+static void getSources(apf::Mesh* m, parma::VtxGraph& g,
+    std::vector<int>& dist, std::vector<int>& sources)
+{
+  for (int i = 0; i < g.size(); ++i) {
+    apf::MeshEntity* u = g.vertex(i);
+    if (!onBoundary(m, u))
+      continue;
+    dist[i] = INT_MAX;
+    apf::Adjacent verts;
+    apf::getBridgeAdjacent(m, u, m->getDimension(), 0, verts);
+    APF_ITERATE(apf::Adjacent, verts, v) {
+      int j = g.index(*v);
+      if (!onBoundary(m, *v) && dist[j] != INT_MAX)
+        sources.push_back(j);
+    }
+  }
+}
+
+static void compare(apf::Mesh* m, bool wall)
+{
+  parma::VtxGraph g(m);
+  Contains c(m, g, wall);
+  int n = g.size();
+  int src = 0;
+  while (src < n && !c.has(src))
+    ++src;
+  PCU_ALWAYS_ASSERT(src < n);
+  /* one source with the cavity walk on boundary vertices */
+  std::vector<int> dist(n, INT_MAX);
+  dist[src] = 0;
+  parma::LevelQueue q;
+  q.push(src, 0);
+  parma::dijkstra(m, g, &c, q, dist);
+  std::vector<int> expected(n, INT_MAX);
+  expected[src] = 0;
+  reference::Walk w = {m, &g, &c, &expected};
+  {
+    parma::DistanceQueue<parma::Less> pq(m);
+    pq.push(g.vertex(src), 0);
+    reference::dijkstra(w, pq);
+  }
+  PCU_ALWAYS_ASSERT(dist == expected);
+  int reached = 0;
+  for (int i = 0; i < n; ++i)
+    if (dist[i] != INT_MAX)
+      ++reached;
+  PCU_ALWAYS_ASSERT(reached > 1);
+  /* many sources at different distances, without the cavity walk */
+  std::vector<int> sources;
+  getSources(m, g, dist, sources);
+  expected = dist;
+  parma::LevelQueue uq;
+  for (size_t i = 0; i < sources.size(); ++i)
+    uq.push(sources[i], dist[sources[i]]);
+  c.useBdry = false;
+  parma::dijkstra(m, g, &c, uq, dist);
+  {
+    parma::DistanceQueue<parma::Less> pq(m);
+    for (size_t i = 0; i < sources.size(); ++i)
+      pq.push(g.vertex(sources[i]), expected[sources[i]]);
+    reference::dijkstra(w, pq);
+  }
+  PCU_ALWAYS_ASSERT(dist == expected);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(8, 6, 4, 1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  compare(m, false);
+  compare(m, true);
+  /* the library distance and its update reach every vertex */
+  apf::MeshTag* t = parma::measureGraphDist(m);
+  PCU_ALWAYS_ASSERT(t == parma::getDistTag(m));
+  parma::measureGraphDist(m);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    int d;
+    m->getIntTag(v, t, &d);
+    PCU_ALWAYS_ASSERT(0 <= d && d != INT_MAX);
+  }
+  m->end(it);
+  apf::removeTagFromDimension(m, t, 0);
+  m->destroyTag(t);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,165 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfPartition.h>
+#include <apf.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cmath>
+#include "parma_tracker.h"
+#include "parma_sides.h"
+#include "parma_weights.h"
+
+/* checks after every migration that the sides and weights kept by
+   parma::Tracker match the ones computed from scratch. the whole box
+   first moves from rank 0 to the last rank, which leaves no copy
+   behind, so only the tracker's fallback sweep finds it. then it is
+   cut into slabs along x and random elements move between parts. */
+
+/* a small generator so every MPI gives the same moves */
+static unsigned nextRandom(unsigned& state)
+{
+  state = state * 1103515245u + 12345u;
+  return (state >> 16) & 0x7fff;
+}
+
+static apf::MeshTag* setWeights(apf::Mesh* m)
+{
+  apf::MeshTag* w = m->createDoubleTag("parmaTracker_weight", 1);
+  int dims[2] = {0, m->getDimension()};
+  for (int i = 0; i < 2; ++i) {
+    apf::MeshIterator* it = m->begin(dims[i]);
+    apf::MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      double v = 1 + x[0] + 2 * x[1] * x[2];
+      m->setDoubleTag(e, w, &v);
+    }
+    m->end(it);
+  }
+  return w;
+}
+
+static apf::Migration* movePlan(apf::Mesh* m, int to)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it)))
+    plan->send(e, to);
+  m->end(it);
+  return plan;
+}
+
+static apf::Migration* slabPlan(apf::Mesh* m)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  int peers = PCU_Comm_Peers();
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    double x = apf::getLinearCentroid(m, e)[0];
+    int to = static_cast<int>(x * peers);
+    plan->send(e, std::min(to, peers - 1));
+  }
+  m->end(it);
+  return plan;
+}
+
+static apf::Migration* randomPlan(apf::Mesh* m, int step)
+{
+  apf::Migration* plan = new apf::Migration(m);
+  int self = PCU_Comm_Self();
+  int peers = PCU_Comm_Peers();
+  unsigned state = 1 + self + 977 * step;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    if (nextRandom(state) % 8 == 0)
+      plan->send(e, nextRandom(state) % peers);
+  }
+  m->end(it);
+  return plan;
+}
+
+static void compareSides(parma::Sides* a, parma::Sides* b)
+{
+  PCU_ALWAYS_ASSERT(a->total() == b->total());
+  PCU_ALWAYS_ASSERT(a->size() == b->size());
+  const parma::Sides::Item* s;
+  a->begin();
+  while ((s = a->iterate())) {
+    PCU_ALWAYS_ASSERT(b->has(s->first));
+    PCU_ALWAYS_ASSERT(b->get(s->first) == s->second);
+  }
+  a->end();
+}
+
+static bool close(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-9 * (std::fabs(a) + std::fabs(b) + 1);
+}
+
+static void compareWeights(parma::Weights* a, parma::Weights* b)
+{
+  PCU_ALWAYS_ASSERT(close(a->self(), b->self()));
+  PCU_ALWAYS_ASSERT(a->size() == b->size());
+  const parma::Weights::Item* s;
+  a->begin();
+  while ((s = a->iterate())) {
+    PCU_ALWAYS_ASSERT(b->has(s->first));
+    PCU_ALWAYS_ASSERT(close(b->get(s->first), s->second));
+  }
+  a->end();
+}
+
+static void check(apf::Mesh* m, apf::MeshTag* w, parma::Tracker& t)
+{
+  parma::Sides* tracked = t.makeSides();
+  parma::Sides* swept = parma::makeVtxSides(m);
+  compareSides(tracked, swept);
+  int dims[2] = {0, m->getDimension()};
+  for (int i = 0; i < 2; ++i) {
+    PCU_ALWAYS_ASSERT(close(t.weight(dims[i]),
+          parma::getWeight(m, w, dims[i])));
+    parma::Weights* tw = t.makeWeights(tracked, dims[i]);
+    parma::Weights* sw = parma::makeEntWeights(m, w, swept, dims[i]);
+    compareWeights(tw, sw);
+    delete tw;
+    delete sw;
+  }
+  delete tracked;
+  delete swept;
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(8, 6, 5, 1, 1, 1, true);
+  apf::MeshTag* w = setWeights(m);
+  {
+    int dims[2] = {0, m->getDimension()};
+    parma::Tracker tracker(m, w, 2, dims);
+    check(m, w, tracker);
+    tracker.migrate(movePlan(m, PCU_Comm_Peers() - 1));
+    check(m, w, tracker);
+    tracker.migrate(slabPlan(m));
+    check(m, w, tracker);
+    for (int step = 0; step < 6; ++step) {
+      tracker.migrate(randomPlan(m, step));
+      check(m, w, tracker);
+    }
+  }
+  apf::verify(m);
+  apf::removeTagFromDimension(m, w, 0);
+  apf::removeTagFromDimension(m, w, m->getDimension());
+  m->destroyTag(w);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
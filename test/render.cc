@@ -14,15 +14,19 @@
 #endif
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 int main(int argc, char** argv)
 {
   MPI_Init(&argc,&argv);
   PCU_Comm_Init();
   lion_set_verbosity(1);
-  if ( argc != 4 ) {
+  if ( argc != 4 && argc != 5 ) {
     if ( !PCU_Comm_Self() )
-      printf("Usage: %s <model> <mesh> <out prefix>\n", argv[0]);
+      printf("Usage: %s <model> <mesh> <out prefix> [parts per .vtu]\n"
+             "with parts per .vtu the pieces are written as raw appended\n"
+             "data, that many parts to a file (0: the parts of a node)\n",
+             argv[0]);
     MPI_Finalize();
     exit(EXIT_FAILURE);
   }
@@ -49,6 +53,18 @@ int main(int argc, char** argv)
     crv::writeCurvedVtuFiles(m, apf::Mesh::TRIANGLE, order + 2, argv[3]);
     crv::writeCurvedWireFrame(m, order + 8, argv[3]);
   }
+  else if (argc == 5) {
+    apf::VtkOptions options;
+    options.appended = true;
+    options.blockSize = 1 << 20;
+    options.threads = 0;
+    options.partsPerFile = atoi(argv[4]);
+    std::vector<std::string> fields;
+    for (int i = 0; i < m->countFields(); ++i)
+      if (apf::isPrintable(m->getField(i)))
+        fields.push_back(apf::getName(m->getField(i)));
+    apf::writeVtkFiles(argv[3], m, fields, options);
+  }
   else
     apf::writeVtkFiles(argv[3], m);
   m->destroyNative();
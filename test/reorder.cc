@@ -13,14 +13,32 @@
 #include <SimModel.h>
 #endif
 #include <stdlib.h>
+#include <string.h>
+
+static apf::Ordering getOrdering(const char* name)
+{
+  if (!strcmp(name, "bfs"))
+    return apf::BREADTH_FIRST;
+  if (!strcmp(name, "rcm"))
+    return apf::REVERSE_CUTHILL_MCKEE;
+  if (!strcmp(name, "hilbert"))
+    return apf::HILBERT_CURVE;
+  if (!strcmp(name, "morton"))
+    return apf::MORTON_CURVE;
+  if (!PCU_Comm_Self())
+    printf("unknown ordering %s\n", name);
+  MPI_Finalize();
+  exit(EXIT_FAILURE);
+}
 
 int main(int argc, char** argv) {
   MPI_Init(&argc,&argv);
   PCU_Comm_Init();
   lion_set_verbosity(1);
-  if ( argc != 4 ) {
+  if ( argc != 4 && argc != 5 ) {
     if ( !PCU_Comm_Self() )
-      printf("Usage: %s <model> <mesh> <out prefix>\n", argv[0]);
+      printf("Usage: %s <model> <mesh> <out prefix> "
+             "[bfs|rcm|hilbert|morton]\n", argv[0]);
     MPI_Finalize();
     exit(EXIT_FAILURE);
   }
@@ -34,7 +52,10 @@ int main(int argc, char** argv) {
   gmi_register_null();
   gmi_register_mesh();
   apf::Mesh2* m = apf::loadMdsMesh(argv[1],argv[2]);
-  apf::MeshTag* order = Parma_BfsReorder(m);
+  apf::Ordering how = apf::BREADTH_FIRST;
+  if ( argc == 5 )
+    how = getOrdering(argv[4]);
+  apf::MeshTag* order = Parma_Reorder(m, how);
   apf::reorderMdsMesh(m, order);
   m->writeNative(argv[3]);
   m->destroyNative();
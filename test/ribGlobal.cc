@@ -0,0 +1,144 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfPartition.h>
+#include <apf.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <vector>
+
+/* builds a box on rank 0 and partitions it with global RIB,
+   first checking the balance of a plan with two parts per rank
+   and then migrating to one part per rank. then a box held by
+   every second rank is split into twice as many parts and
+   repeated onto all ranks with apf::repeatMdsMesh */
+
+/* the heaviest and lightest of the planned parts relative
+   to the mean, elements not in the plan stay on this part,
+   which is part id * multiple once the mesh is expanded */
+static void checkPlan(apf::Mesh2* m, apf::Migration* plan, int multiple)
+{
+  int parts = multiple * PCU_Comm_Peers();
+  std::vector<long> counts(parts, 0);
+  int dim = m->getDimension();
+  counts[m->getId() * multiple] = m->count(dim) - plan->count();
+  for (int i = 0; i < plan->count(); ++i) {
+    int p = plan->sending(plan->get(i));
+    PCU_ALWAYS_ASSERT(0 <= p && p < parts);
+    ++counts[p];
+  }
+  PCU_Add_Longs(&counts[0], parts);
+  long total = 0;
+  long max = 0;
+  long min = counts[0];
+  for (int i = 0; i < parts; ++i) {
+    total += counts[i];
+    max = std::max(max, counts[i]);
+    min = std::min(min, counts[i]);
+  }
+  double mean = double(total) / parts;
+  if (!PCU_Comm_Self())
+    lion_oprint(1, "%d parts: min %ld max %ld mean %f\n",
+        parts, min, max, mean);
+  PCU_ALWAYS_ASSERT(max <= mean + 1);
+  PCU_ALWAYS_ASSERT(min >= mean - 1);
+}
+
+static void checkParts(apf::Mesh2* m, long total)
+{
+  int count = m->count(m->getDimension());
+  PCU_ALWAYS_ASSERT(PCU_Add_Long(count) == total);
+  double mean = double(total) / PCU_Comm_Peers();
+  PCU_ALWAYS_ASSERT(PCU_Max_Int(count) <= mean + 1);
+  PCU_ALWAYS_ASSERT(PCU_Min_Int(count) >= mean - 1);
+}
+
+static void splitOnAll()
+{
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(9, 7, 5, 1, 1, 1, true);
+  long total = apf::countOwned(m, m->getDimension());
+  total = PCU_Add_Long(total);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  apf::Migration* plan = splitter->split(0, 1.05, 2);
+  checkPlan(m, plan, 2);
+  delete plan;
+  plan = splitter->split(0, 1.05, 1);
+  checkPlan(m, plan, 1);
+  m->migrate(plan);
+  delete splitter;
+  apf::verify(m);
+  checkParts(m, total);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+/* deals the box out in slabs along y, across the long x axis
+   that RIB cuts first, so every part holds pieces of every
+   planned part */
+static void spreadAcross(apf::Mesh2* m)
+{
+  int peers = PCU_Comm_Peers();
+  apf::Migration* plan = new apf::Migration(m);
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  apf::MeshEntity* e;
+  while ((e = m->iterate(it))) {
+    apf::Vector3 c = apf::getLinearCentroid(m, e);
+    int to = std::min(peers - 1, int(c[1] * peers));
+    if (to != m->getId())
+      plan->send(e, to);
+  }
+  m->end(it);
+  m->migrate(plan);
+}
+
+/* the ranks that are multiples of factor hold the box and plan
+   the split, as in test/split.cc, the others only need its model.
+   elements of part p must leave p for p * factor */
+static void splitAndRepeat(int factor)
+{
+  int self = PCU_Comm_Self();
+  bool isOriginal = self % factor == 0;
+  MPI_Comm all = PCU_Get_Comm();
+  MPI_Comm group;
+  MPI_Comm_split(all, self % factor, self / factor, &group);
+  PCU_Switch_Comm(group);
+  apf::Mesh2* m = 0;
+  apf::Migration* plan = 0;
+  gmi_model* g;
+  long total = 0;
+  if (isOriginal) {
+    m = apf::makeMdsBoxOnPartZero(8, 6, 5, 1, 1, 1, true);
+    g = m->getModel();
+    total = apf::countOwned(m, m->getDimension());
+    spreadAcross(m);
+    apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+    plan = splitter->split(0, 1.05, factor);
+    checkPlan(m, plan, factor);
+    delete splitter;
+  } else {
+    g = apf::makeMdsBoxModel(8, 6, 5, 1, 1, 1, true);
+  }
+  PCU_Switch_Comm(all);
+  MPI_Comm_free(&group);
+  total = PCU_Add_Long(total);
+  m = apf::repeatMdsMesh(m, g, plan, factor);
+  apf::verify(m);
+  checkParts(m, total);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  splitOnAll();
+  int peers = PCU_Comm_Peers();
+  splitAndRepeat(peers % 2 ? peers : 2);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -21,6 +21,10 @@ class CountIntegrator : public apf::Integrator {
     }
     void atPoint(apf::Vector3 const& , double , double ) {
     }
+    apf::Integrator* clone() { return new CountIntegrator(); }
+    void merge(apf::Integrator* other) {
+      numEnt += static_cast<CountIntegrator*>(other)->numEnt;
+    }
 };
 int main(int argc, char ** argv) {
   MPI_Init(&argc, &argv);
@@ -43,6 +47,14 @@ int main(int argc, char ** argv) {
     countInt->process(mesh, i);
     PCU_ALWAYS_ASSERT(mesh->count(i) == countInt->getCount());
   }
+  // test threaded integration gives the same counts
+  apf::setIntegrationThreads(4);
+  for(int i=3; i>0; --i) {
+    countInt->resetCount();
+    countInt->process(mesh, i);
+    PCU_ALWAYS_ASSERT(mesh->count(i) == countInt->getCount());
+  }
+  apf::setIntegrationThreads(1);
 
   delete countInt;
   mesh->destroyNative();
@@ -16,6 +16,24 @@ mpi_test(bezierMisc 1 ./bezierMisc)
 mpi_test(bezierRefine 1 ./bezierRefine)
 mpi_test(bezierSubdivision 1 ./bezierSubdivision)
 mpi_test(bezierValidity 1 ./bezierValidity)
+mpi_test(bezierShapeEval 1 ./bezierShapeEval 4 6)
+mpi_test(bezierShapeEval_edge_1 1 ./bezierShapeEval 1 1)
+mpi_test(bezierShapeEval_edge_2 1 ./bezierShapeEval 1 2)
+mpi_test(bezierShapeEval_edge_3 1 ./bezierShapeEval 1 3)
+mpi_test(bezierShapeEval_edge_4 1 ./bezierShapeEval 1 4)
+mpi_test(bezierShapeEval_edge_5 1 ./bezierShapeEval 1 5)
+mpi_test(bezierShapeEval_edge_6 1 ./bezierShapeEval 1 6)
+mpi_test(bezierShapeEval_tri_1 1 ./bezierShapeEval 2 1)
+mpi_test(bezierShapeEval_tri_2 1 ./bezierShapeEval 2 2)
+mpi_test(bezierShapeEval_tri_3 1 ./bezierShapeEval 2 3)
+mpi_test(bezierShapeEval_tri_4 1 ./bezierShapeEval 2 4)
+mpi_test(bezierShapeEval_tri_5 1 ./bezierShapeEval 2 5)
+mpi_test(bezierShapeEval_tri_6 1 ./bezierShapeEval 2 6)
+mpi_test(bezierShapeEval_tet_1 1 ./bezierShapeEval 4 1)
+mpi_test(bezierShapeEval_tet_2 1 ./bezierShapeEval 4 2)
+mpi_test(bezierShapeEval_tet_3 1 ./bezierShapeEval 4 3)
+mpi_test(bezierShapeEval_tet_4 1 ./bezierShapeEval 4 4)
+mpi_test(bezierShapeEval_tet_5 1 ./bezierShapeEval 4 5)
 mpi_test(ma_analytic 1 ./ma_test_analytic_model)
 
 if(ENABLE_ZOLTAN)
@@ -36,6 +54,38 @@ mpi_test(swapDoubles 1 ./swapDoubles)
 mpi_test(base64 1 ./base64)
 mpi_test(tensor_test 1 ./tensor)
 mpi_test(verify_convert 1 ./verify_convert)
+mpi_test(mdsFreeze 1 ./mdsFreeze)
+mpi_test(mdsTags 1 ./mdsTags)
+mpi_test(mdsSpans 1 ./mdsSpans)
+mpi_test(mdsShared 1 ./mdsShared)
+mpi_test(mdsShared_4 4 ./mdsShared)
+mpi_test(haloSync 4 ./haloSync)
+mpi_test(ribGlobal_1 1 ./ribGlobal)
+mpi_test(ribGlobal 3 ./ribGlobal)
+mpi_test(ribGlobal_4 4 ./ribGlobal)
+mpi_test(parmaTracker 4 ./parmaTracker)
+mpi_test(parmaGraphDist_1 1 ./parmaGraphDist)
+mpi_test(parmaGraphDist 4 ./parmaGraphDist)
+mpi_test(vtkOptions 4 ./vtkOptions)
+mpi_test(aggregate 4 ./aggregate)
+mpi_test(aggregate_nodes_2 5 ./aggregate 2)
+mpi_test(aggregate_nodes_3 8 ./aggregate 3)
+mpi_test(maWorklists 1 ./maWorklists)
+mpi_test(maLengthCache 1 ./maLengthCache)
+mpi_test(cavityPulls 4 ./cavityPulls)
+if(PCU_ZSTD)
+  mpi_test(zstdRoundTrip 1 ./zstdRoundTrip)
+endif()
+mpi_test(mdsCompact 1
+         ./mdsCompact
+         "${MESHES}/cube/cube.dmg"
+         "${MESHES}/cube/pumi11/cube.smb"
+         )
+mpi_test(mdsCompact_4 4
+         ./mdsCompact
+         "${MESHES}/cube/cube.dmg"
+         "${MESHES}/cube/pumi7k/4/cube.smb"
+         )
 mpi_test(test_integrator 1
          ./test_integrator
          "${MESHES}/cube/cube.dmg"
@@ -355,6 +405,8 @@ if(ENABLE_SIMMETRIX AND SIM_PARASOLID)
 endif()
 if(PCU_COMPRESS)
   set(MESHFILE "bz2:pipe_2_.smb")
+elseif(PCU_ZSTD)
+  set(MESHFILE "zst:pipe_2_.smb")
 else()
   set(MESHFILE "pipe_2_.smb")
 endif()
@@ -606,6 +658,7 @@ mpi_test(construct 4
   ./construct
   "${MDIR}/cube.dmg"
   "${MDIR}/pumi7k/4/cube.smb")
+mpi_test(constructChunks 4 ./constructChunks)
 mpi_test(constructThenGhost 4
   ./constructThenGhost
   "${MDIR}/cube.dmg"
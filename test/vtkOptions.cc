@@ -0,0 +1,335 @@
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <parma.h>
+#include <PCU.h>
+#include <lionPrint.h>
+#include <lionBase64.h>
+#include <lionCompress.h>
+#include <pcu_util.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* writes a partitioned box in every mode of apf::VtkOptions and reads
+   this part's piece back. the binary modes must decode to the same
+   bytes, with block headers and appended offsets that tile the data
+   exactly, the threaded output must equal the serial one, and full
+   precision ASCII must give back the doubles exactly. */
+
+static std::string readFile(std::string const& path)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  PCU_ALWAYS_ASSERT(file.is_open());
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+static std::string getPiecePath(const char* prefix, int file)
+{
+  std::stringstream ss;
+  ss << prefix << '/' << file / 1024 << '/' << file << ".vtu";
+  return ss.str();
+}
+
+static std::string getAttribute(std::string const& tag, const char* name)
+{
+  std::string key = std::string(" ") + name + "=\"";
+  size_t at = tag.find(key);
+  if (at == std::string::npos)
+    return "";
+  at += key.size();
+  return tag.substr(at, tag.find('"', at) - at);
+}
+
+static uint64_t readWord(std::string const& s, size_t at)
+{
+  PCU_ALWAYS_ASSERT(at + sizeof(uint64_t) <= s.size());
+  uint64_t w;
+  memcpy(&w, s.data() + at, sizeof(w));
+  return w;
+}
+
+/* inflates the blocks after a vtkZLibDataCompressor header at
+   data[at], returns where they end */
+static size_t inflateBlocks(std::string const& data, size_t at,
+    std::string& out)
+{
+  uint64_t blocks = readWord(data, at);
+  uint64_t blockLen = readWord(data, at + 8);
+  uint64_t lastLen = readWord(data, at + 16);
+  PCU_ALWAYS_ASSERT(blocks >= 1);
+  PCU_ALWAYS_ASSERT(lastLen <= blockLen);
+  size_t in = at + 8 * (3 + blocks);
+  out.clear();
+  for (uint64_t i = 0; i < blocks; ++i) {
+    uint64_t size = readWord(data, at + 8 * (3 + i));
+    uint64_t len = (i + 1 == blocks) ? lastLen : blockLen;
+    PCU_ALWAYS_ASSERT(in + size <= data.size());
+#ifdef HAVE_ZLIB
+    std::string block(len, '\0');
+    uLongf got = len;
+    int err = uncompress((Bytef*)&block[0], &got,
+        (Bytef const*)data.data() + in, size);
+    PCU_ALWAYS_ASSERT(err == Z_OK);
+    PCU_ALWAYS_ASSERT(got == len);
+    out += block;
+#else
+    (void)len;
+    PCU_ALWAYS_ASSERT(!"zlib blocks without zlib");
+#endif
+    in += size;
+  }
+  return in;
+}
+
+/* the header and the data of a base64 array are encoded separately */
+static std::string decodeBase64Array(std::string const& text,
+    size_t wordBytes)
+{
+  std::string out;
+  if (lion::can_compress) {
+    std::string first = lion::base64Decode(text.substr(0, 12));
+    uint64_t blocks = readWord(first, 0);
+    size_t headerLen = 8 * (3 + blocks);
+    size_t headerChars = 4 * ((headerLen + 2) / 3);
+    std::string data = lion::base64Decode(text.substr(0, headerChars));
+    data += lion::base64Decode(text.substr(headerChars));
+    PCU_ALWAYS_ASSERT(inflateBlocks(data, 0, out) == data.size());
+    return out;
+  }
+  size_t headerChars = 4 * ((wordBytes + 2) / 3);
+  std::string header = lion::base64Decode(text.substr(0, headerChars));
+  uint32_t len;
+  memcpy(&len, header.data(), sizeof(len));
+  out = lion::base64Decode(text.substr(headerChars));
+  PCU_ALWAYS_ASSERT(out.size() == len);
+  return out;
+}
+
+/* a decoded array knows how many bytes it should hold,
+   except connectivity which depends on the element types */
+struct Array
+{
+  std::string name;
+  std::string bytes;
+  size_t expected;
+};
+
+static size_t typeSize(std::string const& type)
+{
+  if (type == "Float64" || type == "Int64")
+    return 8;
+  if (type == "Int32")
+    return 4;
+  PCU_ALWAYS_ASSERT(type == "UInt8");
+  return 1;
+}
+
+/* decodes the arrays of piece number `which` in a .vtu file,
+   checking that the appended offsets of all pieces tile the
+   AppendedData section from its start to its end */
+static std::vector<Array> readPiece(std::string const& path, int which,
+    int pieces)
+{
+  std::string file = readFile(path);
+  size_t head = file.find("<VTKFile");
+  PCU_ALWAYS_ASSERT(head != std::string::npos);
+  std::string vtkTag = file.substr(head, file.find('>', head) - head);
+  std::string headerType = getAttribute(vtkTag, "header_type");
+  bool appended = false;
+  std::string data;
+  size_t dataBegin = file.find("<AppendedData encoding=\"raw\">\n_");
+  if (dataBegin != std::string::npos) {
+    appended = true;
+    PCU_ALWAYS_ASSERT(headerType == "UInt64");
+    dataBegin = file.find('_', dataBegin) + 1;
+    size_t dataEnd = file.rfind("\n</AppendedData>");
+    PCU_ALWAYS_ASSERT(dataEnd != std::string::npos && dataEnd >= dataBegin);
+    data = file.substr(dataBegin, dataEnd - dataBegin);
+  }
+  size_t wordBytes = (headerType == "UInt64") ? 8 : 4;
+  if (lion::can_compress && getAttribute(vtkTag, "byte_order") != "")
+    PCU_ALWAYS_ASSERT(getAttribute(vtkTag, "compressor")
+        == "vtkZLibDataCompressor");
+  std::vector<Array> arrays;
+  size_t next = 0;
+  size_t at = 0;
+  for (int piece = 0; piece < pieces; ++piece) {
+    at = file.find("<Piece ", at);
+    PCU_ALWAYS_ASSERT(at != std::string::npos);
+    std::string pieceTag = file.substr(at, file.find('>', at) - at);
+    size_t points = atol(getAttribute(pieceTag, "NumberOfPoints").c_str());
+    size_t cells = atol(getAttribute(pieceTag, "NumberOfCells").c_str());
+    size_t end = file.find("</Piece>", at);
+    size_t cellData = file.find("<CellData>", at);
+    while ((at = file.find("<DataArray ", at)) < end) {
+      size_t close = file.find('>', at);
+      std::string tag = file.substr(at, close - at);
+      Array a;
+      a.name = getAttribute(tag, "Name");
+      std::string components = getAttribute(tag, "NumberOfComponents");
+      std::string type = getAttribute(tag, "type");
+      if (a.name == "connectivity")
+        a.expected = 0;
+      else if (components.empty())
+        a.expected = cells * typeSize(type);
+      else
+        a.expected = atol(components.c_str()) * typeSize(type) *
+          (at > cellData ? cells : points);
+      std::string format = getAttribute(tag, "format");
+      if (format == "appended") {
+        PCU_ALWAYS_ASSERT(appended);
+        size_t offset = atol(getAttribute(tag, "offset").c_str());
+        PCU_ALWAYS_ASSERT(offset == next);
+        if (lion::can_compress) {
+          next = inflateBlocks(data, offset, a.bytes);
+        } else {
+          uint64_t len = readWord(data, offset);
+          a.bytes = data.substr(offset + 8, len);
+          next = offset + 8 + len;
+        }
+      } else {
+        size_t stop = file.find("</DataArray>", close);
+        std::string text = file.substr(close + 2, stop - close - 2);
+        if (format == "binary") {
+          text = text.substr(0, text.find('\n'));
+          a.bytes = decodeBase64Array(text, wordBytes);
+        } else {
+          PCU_ALWAYS_ASSERT(format == "ascii");
+          a.bytes = text;
+          a.expected = 0;
+        }
+      }
+      if (a.expected)
+        PCU_ALWAYS_ASSERT(a.bytes.size() == a.expected);
+      if (piece == which)
+        arrays.push_back(a);
+      at = close;
+    }
+    at = end;
+  }
+  if (appended)
+    PCU_ALWAYS_ASSERT(next == data.size());
+  return arrays;
+}
+
+static void compareArrays(std::vector<Array> const& a,
+    std::vector<Array> const& b)
+{
+  PCU_ALWAYS_ASSERT(a.size() == b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    PCU_ALWAYS_ASSERT(a[i].name == b[i].name);
+    PCU_ALWAYS_ASSERT(a[i].bytes == b[i].bytes);
+  }
+}
+
+static std::vector<Array> writeAndRead(const char* prefix, apf::Mesh* m,
+    apf::VtkOptions const& options)
+{
+  std::vector<std::string> fields(1, "vtkOptions_field");
+  apf::writeVtkFiles(prefix, m, fields, options);
+  PCU_Barrier();
+  int self = PCU_Comm_Self();
+  int per = options.partsPerFile;
+  PCU_ALWAYS_ASSERT(per > 0);
+  int pieces = std::min(per, PCU_Comm_Peers() - (self / per) * per);
+  return readPiece(getPiecePath(prefix, self / per), self % per, pieces);
+}
+
+/* the last value on this part is sub-normal, every other one
+   needs all 17 digits to come back exactly */
+static apf::Field* makeField(apf::Mesh* m)
+{
+  apf::Field* f = apf::createLagrangeField(m, "vtkOptions_field",
+      apf::SCALAR, 1);
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    apf::setScalar(f, v, 0, x[0] / 3 + x[1] / 7 + x[2] + 1e-9);
+  }
+  m->end(it);
+  it = m->begin(0);
+  apf::MeshEntity* last = 0;
+  while ((v = m->iterate(it)))
+    last = v;
+  m->end(it);
+  if (last)
+    apf::setScalar(f, last, 0, 1e-310);
+  return f;
+}
+
+static void checkFullPrecision(apf::Mesh* m, apf::Field* f,
+    std::vector<Array> const& arrays)
+{
+  std::vector<double> expected;
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    double value = apf::getScalar(f, v, 0);
+    if (value < 1e-300)
+      value = 0;
+    expected.push_back(value);
+  }
+  m->end(it);
+  bool found = false;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    if (arrays[i].name != "vtkOptions_field")
+      continue;
+    found = true;
+    std::stringstream ss(arrays[i].bytes);
+    for (size_t j = 0; j < expected.size(); ++j) {
+      double value;
+      PCU_ALWAYS_ASSERT(ss >> value);
+      PCU_ALWAYS_ASSERT(value == expected[j]);
+    }
+  }
+  PCU_ALWAYS_ASSERT(found);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  apf::Mesh2* m = apf::makeMdsBoxOnPartZero(6, 5, 4, 1, 1, 1, true);
+  apf::Splitter* splitter = Parma_MakeGlobalRibSplitter(m);
+  m->migrate(splitter->split(0, 1.05, 1));
+  delete splitter;
+  apf::Field* f = makeField(m);
+  apf::VtkOptions options;
+  std::vector<Array> base64 = writeAndRead("vtkOptions_base64", m, options);
+  options.blockSize = 1000;
+  std::vector<Array> blocks = writeAndRead("vtkOptions_blocks", m, options);
+  compareArrays(base64, blocks);
+  options.threads = 4;
+  writeAndRead("vtkOptions_threads", m, options);
+  std::string one = getPiecePath("vtkOptions_blocks", PCU_Comm_Self());
+  std::string four = getPiecePath("vtkOptions_threads", PCU_Comm_Self());
+  PCU_ALWAYS_ASSERT(readFile(one) == readFile(four));
+  options.appended = true;
+  compareArrays(base64, writeAndRead("vtkOptions_appended", m, options));
+  options.partsPerFile = 2;
+  compareArrays(base64, writeAndRead("vtkOptions_grouped", m, options));
+  options = apf::VtkOptions();
+  options.binary = false;
+  options.fullPrecision = true;
+  checkFullPrecision(m, f, writeAndRead("vtkOptions_ascii", m, options));
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  PCU_Comm_Free();
+  MPI_Finalize();
+}
@@ -0,0 +1,91 @@
+#include <gmi_mesh.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apf.h>
+#include <PCU.h>
+#include <pcu_io.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/* writes and reads back a zstd file with writes that straddle
+   the 16MB chunks, first at the default settings and then with
+   worker threads, and then does the same for an SMB mesh */
+
+static void checkStream(const char* path)
+{
+  /* 48MB of doubles in uneven pieces, so chunk boundaries fall
+     inside writes and reads */
+  size_t n = 6 * 1024 * 1024;
+  std::vector<double> out(n);
+  for (size_t i = 0; i < n; ++i)
+    out[i] = (i % 1000) * 0.25 + (i / 1000);
+  pcu_file* f = pcu_fopen(path, true, PCU_CODEC_ZSTD);
+  pcu_write_string(f, "zstd round trip");
+  size_t piece = 333333;
+  for (size_t at = 0; at < n; at += piece) {
+    size_t m = at + piece < n ? piece : n - at;
+    pcu_write_doubles(f, &out[at], m);
+  }
+  pcu_fclose(f);
+  std::vector<double> in(n);
+  f = pcu_fopen(path, false, PCU_CODEC_ZSTD);
+  char* s;
+  pcu_read_string(f, &s);
+  PCU_ALWAYS_ASSERT(!strcmp(s, "zstd round trip"));
+  free(s);
+  piece = 1000003;
+  for (size_t at = 0; at < n; at += piece) {
+    size_t m = at + piece < n ? piece : n - at;
+    pcu_read_doubles(f, &in[at], m);
+  }
+  pcu_fclose(f);
+  PCU_ALWAYS_ASSERT(in == out);
+}
+
+static void checkMesh()
+{
+  apf::Mesh2* m = apf::makeMdsBox(8, 8, 8, 1, 1, 1, true);
+  m->writeNative("zst:zstdRoundTrip.smb");
+  gmi_model* g = m->getModel();
+  apf::Mesh2* m2 = apf::loadMdsMesh(g, "zst:zstdRoundTrip.smb");
+  m2->verify();
+  for (int d = 0; d <= 3; ++d)
+    PCU_ALWAYS_ASSERT(m->count(d) == m2->count(d));
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshIterator* it2 = m2->begin(0);
+  apf::MeshEntity* v;
+  while ((v = m->iterate(it))) {
+    apf::MeshEntity* v2 = m2->iterate(it2);
+    apf::Vector3 p;
+    apf::Vector3 p2;
+    m->getPoint(v, 0, p);
+    m2->getPoint(v2, 0, p2);
+    PCU_ALWAYS_ASSERT(p[0] == p2[0] && p[1] == p2[1] && p[2] == p2[2]);
+  }
+  m->end(it);
+  m2->end(it2);
+  apf::disownMdsModel(m2);
+  m2->destroyNative();
+  apf::destroyMesh(m2);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+  PCU_Comm_Init();
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  checkStream("zstdRoundTrip.zst");
+  pcu_set_compression(3, 2);
+  checkStream("zstdRoundTrip.zst");
+  pcu_set_compression(1, 0);
+  checkMesh();
+  PCU_Comm_Free();
+  MPI_Finalize();
+}